@@ -0,0 +1,112 @@
+//BlacklistBench.cpp
+//
+// Проверка IMSI по правилам черного списка: дерево цифр против перебора правил.
+// Запуск: pgw_bench_blacklist [кол-во правил] [кол-во проверок]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "server/Blacklist.h"
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Rule {
+        std::string first;      // Префикс или начало диапазона
+        std::string last;       // Пусто - префикс
+    };
+
+    std::string digits(std::mt19937_64& rng, size_t length) {
+        std::string result(length, '0');
+        for (char& c : result) c = char('0' + rng() % 10);
+        return result;
+    }
+
+    // Перебор правил: то, что пришлось бы делать без компиляции
+    bool scanRules(const std::vector<Rule>& rules, const std::string& imsi) {
+        for (const Rule& rule : rules) {
+            if (rule.last.empty()) {
+                if (imsi.compare(0, rule.first.size(), rule.first) == 0) return true;
+            } else if (imsi.size() == rule.first.size() && imsi >= rule.first && imsi <= rule.last) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    double nsPerOp(Clock::time_point started, size_t ops) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - started).count() / double(ops);
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    const size_t rule_count = argc > 1 ? size_t(std::atoll(argv[1])) : 100000;
+    const size_t lookups = argc > 2 ? size_t(std::atoll(argv[2])) : 1000000;
+    std::mt19937_64 rng(2024);
+
+    // Половина - префиксы PLMN (5-8 цифр), половина - диапазоны IMSI по 15 цифр
+    std::vector<Rule> rules;
+    std::vector<std::string> entries;
+    for (size_t i = 0; i < rule_count; ++i) {
+        if (i % 2 == 0) {
+            rules.push_back({digits(rng, 5 + rng() % 4), ""});
+            entries.push_back(rules.back().first + "*");
+        } else {
+            const std::string base = digits(rng, 9);
+            const uint64_t start = rng() % 500000;
+            const uint64_t span = 1 + rng() % 100000;
+            char first[16];
+            char last[16];
+            std::snprintf(first, sizeof(first), "%s%06llu", base.c_str(), (unsigned long long)start);
+            std::snprintf(last, sizeof(last), "%s%06llu", base.c_str(), (unsigned long long)(start + span));
+            rules.push_back({first, last});
+            entries.push_back(rules.back().first + "-" + rules.back().last);
+        }
+    }
+
+    const auto build_started = Clock::now();
+    Blacklist blacklist(entries);
+    const double build_ms = std::chrono::duration<double, std::milli>(Clock::now() - build_started).count();
+    const BlacklistStats stats = blacklist.getStats();
+    std::printf("%zu rules (%llu prefix, %llu range): compiled in %.1f ms, %llu trie nodes, %.1f MiB\n",
+                rule_count, (unsigned long long)stats.prefix_rules, (unsigned long long)stats.range_rules,
+                build_ms, (unsigned long long)stats.trie_nodes, double(stats.memory_bytes) / (1 << 20));
+
+    // Случайные IMSI (почти все мимо) и IMSI, заведомо попадающие в правила
+    std::vector<std::string> misses;
+    std::vector<std::string> hits;
+    for (size_t i = 0; i < 4096; ++i) {
+        misses.push_back(digits(rng, 15));
+        const Rule& rule = rules[rng() % rules.size()];
+        hits.push_back(rule.last.empty() ? rule.first + digits(rng, 15 - rule.first.size()) : rule.last);
+    }
+
+    std::printf("%-12s %14s %14s\n", "lookup", "trie ns/op", "scan ns/op");
+    for (const auto& [name, probes] : {std::make_pair("random", &misses), std::make_pair("blocked", &hits)}) {
+        size_t found = 0;
+        auto started = Clock::now();
+        for (size_t i = 0; i < lookups; ++i) {
+            found += blacklist.contains(std::string_view((*probes)[i & 4095]));
+        }
+        const double trie_ns = nsPerOp(started, lookups);
+
+        // Перебор в сотни раз медленнее - меряется на меньшем числе проверок
+        const size_t scan_lookups = std::max<size_t>(1, std::min<size_t>(lookups, 2000));
+        size_t mismatches = 0;
+        started = Clock::now();
+        for (size_t i = 0; i < scan_lookups; ++i) {
+            const std::string& imsi = (*probes)[i & 4095];
+            mismatches += scanRules(rules, imsi) != blacklist.contains(std::string_view(imsi));
+        }
+        const double scan_ns = nsPerOp(started, scan_lookups);
+        std::printf("%-12s %14.1f %14.1f   (blocked %zu/%zu, mismatches %zu)\n",
+                    name, trie_ns, scan_ns, found, lookups, mismatches);
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+//SessionChurnBench.cpp
+//
+// Выделения памяти и время на цикл жизни сессии: создание, продление, истечение.
+// Запуск: pgw_bench_churn [сессий за раунд] [раундов] [шардов] [репликация 0/1]
+// С репликацией изменения забирает отдельный поток, как поток передачи основного сервера
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include "server/SessionManager.h"
+#include "Logger.h"
+#include "../tests/AllocationCounter.h"
+
+namespace {
+
+    // Счетчики всех выделений процесса (включая поток логгера)
+    struct AllocationMark {
+        uint64_t allocations = allocationCounter::processAllocations();
+        uint64_t bytes = allocationCounter::processBytes();
+    };
+
+    double nsSince(std::chrono::steady_clock::time_point started) {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    allocationCounter::enableProcess();
+    const int sessions = argc > 1 ? std::atoi(argv[1]) : 200000;
+    const int rounds = argc > 2 ? std::atoi(argv[2]) : 10;
+    const uint32_t shards = argc > 3 ? uint32_t(std::atoi(argv[3])) : 16;
+    const bool replicate = argc > 4 && std::atoi(argv[4]) != 0;
+    spdlog::set_level(spdlog::level::warn);
+
+    const auto dir = std::filesystem::temp_directory_path();
+    auto logger = std::make_shared<Logger>((dir / "pgw_bench_churn.log").string());
+    logger->start();
+
+    // Короткий таймаут: каждый раунд создает новое поколение сессий, прежнее истекает
+    SessionManagerConfig config;
+    config.session_timeout_ms = 50;
+    config.timer_tick_ms = 1;
+    config.graceful_shutdown_rate = 0;
+    config.cdr_file = (dir / "pgw_bench_churn_cdr.log").string();
+    config.shards = shards;
+    config.max_sessions = uint64_t(sessions) * 2;
+    SessionManager manager(config, logger);
+
+    std::shared_ptr<ReplicationLog> replication;
+    std::atomic<bool> draining{true};
+    std::thread drainer;
+    if (replicate) {
+        replication = std::make_shared<ReplicationLog>(size_t(1) << 20, 1000);
+        manager.setReplicationLog(replication);
+        drainer = std::thread([&]() {
+            SessionDelta delta;
+            while (draining.load(std::memory_order_relaxed)) {
+                while (replication->tryPop(delta)) {}
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+    }
+
+    std::printf("Session churn: %d sessions per round, %d rounds, %u shards, replication %s\n",
+                sessions, rounds, shards, replicate ? "on" : "off");
+    std::printf("%-6s %14s %14s %12s %14s %14s %12s\n", "round",
+                "create allocs", "create bytes", "create ns",
+                "expire allocs", "expire bytes", "expire ns");
+
+    char imsi[16];
+    uint64_t next_imsi = 0;
+    double total_allocations = 0.0;
+    double total_bytes = 0.0;
+    int measured = 0;
+    for (int round = 0; round < rounds; ++round) {
+        const AllocationMark before_create;
+        auto started = std::chrono::steady_clock::now();
+        for (int i = 0; i < sessions; ++i) {
+            std::snprintf(imsi, sizeof(imsi), "25099%010llu", static_cast<unsigned long long>(next_imsi++));
+            manager.handleImsi(std::string_view(imsi, 15));
+            // Каждая вторая сессия сразу продлевается: в колесе появляется перестановка срока
+            if (i % 2 == 0) manager.refreshSession(std::string_view(imsi, 15));
+        }
+        const double create_ns = nsSince(started);
+        const AllocationMark after_create;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(config.session_timeout_ms + 20));
+        started = std::chrono::steady_clock::now();
+        manager.cleanupExpiredSessions();
+        const double expire_ns = nsSince(started);
+        logger->flush();
+        const AllocationMark after_expire;
+
+        const double create_allocations = double(after_create.allocations - before_create.allocations) / sessions;
+        const double expire_allocations = double(after_expire.allocations - after_create.allocations) / sessions;
+        const double create_bytes = double(after_create.bytes - before_create.bytes) / sessions;
+        const double expire_bytes = double(after_expire.bytes - after_create.bytes) / sessions;
+        std::printf("%-6d %14.3f %14.1f %12.0f %14.3f %14.1f %12.0f\n", round,
+                    create_allocations, create_bytes, create_ns / sessions,
+                    expire_allocations, expire_bytes, expire_ns / sessions);
+        // Первый раунд прогревает буферы колес таймеров
+        if (round > 0) {
+            total_allocations += create_allocations + expire_allocations;
+            total_bytes += create_bytes + expire_bytes;
+            ++measured;
+        }
+    }
+    if (measured > 0) {
+        std::printf("steady state: %.3f allocations, %.1f bytes per session lifecycle\n",
+                    total_allocations / measured, total_bytes / measured);
+    }
+    std::printf("sessions left: %llu\n", static_cast<unsigned long long>(manager.getStats().sessions));
+    if (replicate) {
+        draining = false;
+        drainer.join();
+        std::printf("replication deltas dropped: %llu\n", static_cast<unsigned long long>(replication->dropped()));
+    }
+    logger->stop();
+    return 0;
+}
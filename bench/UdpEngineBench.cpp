@@ -0,0 +1,145 @@
+//UdpEngineBench.cpp
+//
+// Нагрузочное сравнение движков UdpServer на loopback.
+// Запуск: pgw_bench_udp [секунд на движок] [клиентских потоков] [кол-во IMSI]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "server/UdpServer.h"
+#include "server/SessionManager.h"
+#include "Logger.h"
+
+namespace {
+
+    constexpr uint16_t kBenchPort = 47000;
+
+    struct BenchResult {
+        uint64_t replies = 0;
+        uint64_t timeouts = 0;
+        std::vector<uint32_t> latencies_us;
+    };
+
+    // Клиент в режиме "запрос-ответ": один запрос в полете на поток
+    void runClient(int id, int imsi_count, std::atomic<bool>& running, BenchResult& result) {
+        int sock = socket(AF_INET, SOCK_DGRAM, 0);
+        timeval timeout{0, 200000};
+        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        sockaddr_in server_addr{};
+        server_addr.sin_family = AF_INET;
+        server_addr.sin_port = htons(kBenchPort);
+        inet_pton(AF_INET, "127.0.0.1", &server_addr.sin_addr);
+
+        // Буфер на худший случай формата (префикс и 20 цифр); imsi_count < 10^10 дает ровно 15 цифр
+        char imsi[5 + 20 + 1];
+        char buffer[256];
+        uint64_t n = id;
+        while (running) {
+            std::snprintf(imsi, sizeof(imsi), "00101%010llu",
+                          static_cast<unsigned long long>(n++ % imsi_count));
+            const auto sent_at = std::chrono::steady_clock::now();
+            sendto(sock, imsi, 15, 0, (sockaddr*)&server_addr, sizeof(server_addr));
+            if (recv(sock, buffer, sizeof(buffer), 0) <= 0) {
+                ++result.timeouts;
+                continue;
+            }
+            const auto rtt = std::chrono::steady_clock::now() - sent_at;
+            result.latencies_us.push_back(static_cast<uint32_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(rtt).count()));
+            ++result.replies;
+        }
+        close(sock);
+    }
+
+    void runEngine(const std::string& name, UdpServerConfig config,
+                   int seconds, int clients, int imsi_count) {
+        const auto dir = std::filesystem::temp_directory_path();
+        auto logger = std::make_shared<Logger>((dir / "pgw_bench.log").string());
+        logger->start();
+        auto session_mgr = std::make_shared<SessionManager>(
+            3600, 0, (dir / "pgw_bench_cdr.log").string(), std::vector<std::string>{}, logger);
+
+        config.port = kBenchPort;
+        config.ip = "127.0.0.1";
+        UdpServer server(config, session_mgr, logger);
+        server.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        std::atomic<bool> running{true};
+        std::vector<BenchResult> results(clients);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < clients; ++i) {
+            threads.emplace_back(runClient, i, imsi_count, std::ref(running), std::ref(results[i]));
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(seconds));
+        running = false;
+        for (auto& thread : threads) thread.join();
+        server.stop();
+
+        BenchResult total;
+        for (auto& result : results) {
+            total.replies += result.replies;
+            total.timeouts += result.timeouts;
+            total.latencies_us.insert(total.latencies_us.end(),
+                                      result.latencies_us.begin(), result.latencies_us.end());
+        }
+        std::sort(total.latencies_us.begin(), total.latencies_us.end());
+        auto percentile = [&](double p) -> uint32_t {
+            if (total.latencies_us.empty()) return 0;
+            return total.latencies_us[static_cast<size_t>(p * (total.latencies_us.size() - 1))];
+        };
+        const BatchStats stats = server.getBatchStats();
+
+        std::printf("%-16s %12.0f %8u %8u %8u %10llu %9.2f\n",
+                    name.c_str(),
+                    double(total.replies) / seconds,
+                    percentile(0.50), percentile(0.99), percentile(0.999),
+                    static_cast<unsigned long long>(total.timeouts),
+                    stats.batches ? double(stats.datagrams) / stats.batches : 0.0);
+        std::fflush(stdout);
+        logger->stop();
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    const int seconds = argc > 1 ? std::atoi(argv[1]) : 3;
+    const int clients = argc > 2 ? std::atoi(argv[2]) : 8;
+    const int imsi_count = argc > 3 ? std::atoi(argv[3]) : 10000;
+    spdlog::set_level(spdlog::level::warn);
+
+    std::printf("UDP engines on loopback: %d s each, %d clients, %d IMSIs\n",
+                seconds, clients, imsi_count);
+    std::printf("%-16s %12s %8s %8s %8s %10s %9s\n",
+                "engine", "replies/s", "p50 us", "p99 us", "p999 us", "timeouts", "avg fill");
+
+    UdpServerConfig config;
+    config.batch_size = 1;
+    config.engine = UdpEngine::Blocking;
+    runEngine("blocking", config, seconds, clients, imsi_count);
+
+    config.batch_size = 32;
+    runEngine("blocking+mmsg", config, seconds, clients, imsi_count);
+
+    config.engine = UdpEngine::Epoll;
+    runEngine("epoll+mmsg", config, seconds, clients, imsi_count);
+
+    config.engine = UdpEngine::IoUring;
+    runEngine("io_uring", config, seconds, clients, imsi_count);
+
+    // Прием отделен от обработки: очередь + пул потоков
+    config.engine = UdpEngine::Epoll;
+    config.processing_workers = 2;
+    config.processing_max_workers = 4;
+    runEngine("epoll+pool", config, seconds, clients, imsi_count);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+//Clock.cpp
+
+#include "Clock.h"
+#include "ThreadPlacement.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+    std::atomic<bool> g_ticking{false};
+    std::atomic<uint64_t> g_monotonic_ms{0};
+    std::atomic<uint64_t> g_wall_ms{0};
+
+    std::mutex g_mutex;
+    std::condition_variable g_condition;
+    std::thread g_ticker;
+    size_t g_users = 0;
+    bool g_stop = false;
+
+    uint64_t readMs(clockid_t clock) {
+        timespec ts;
+        clock_gettime(clock, &ts);
+        return uint64_t(ts.tv_sec) * 1000 + uint64_t(ts.tv_nsec) / 1000000;
+    }
+
+    void publish() {
+        g_monotonic_ms.store(readMs(CLOCK_MONOTONIC), std::memory_order_relaxed);
+        g_wall_ms.store(readMs(CLOCK_REALTIME), std::memory_order_relaxed);
+    }
+
+    void tick(std::chrono::milliseconds interval) {
+        threadPlacement::apply("clock");
+        std::unique_lock<std::mutex> lock(g_mutex);
+        while (!g_condition.wait_for(lock, interval, [] { return g_stop; })) {
+            publish();
+        }
+    }
+
+}
+
+void coarseClock::start(std::chrono::milliseconds tick_interval) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (g_users++ > 0) return;
+    // Значения публикуются до флага: первый читатель уже видит текущее время
+    publish();
+    g_ticking.store(true, std::memory_order_release);
+    g_stop = false;
+    g_ticker = std::thread(tick, tick_interval);
+}
+
+void coarseClock::stop() {
+    std::thread ticker;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (g_users == 0 || --g_users > 0) return;
+        g_ticking.store(false, std::memory_order_release);
+        g_stop = true;
+        ticker = std::move(g_ticker);
+    }
+    g_condition.notify_all();
+    if (ticker.joinable()) ticker.join();
+}
+
+bool coarseClock::isTicking() {
+    return g_ticking.load(std::memory_order_acquire);
+}
+
+uint64_t coarseClock::monotonicMs() {
+    if (g_ticking.load(std::memory_order_acquire)) {
+        return g_monotonic_ms.load(std::memory_order_relaxed);
+    }
+    return readMs(CLOCK_MONOTONIC);
+}
+
+uint64_t coarseClock::wallMs() {
+    if (g_ticking.load(std::memory_order_acquire)) {
+        return g_wall_ms.load(std::memory_order_relaxed);
+    }
+    return readMs(CLOCK_REALTIME);
+}
+
+std::string_view coarseClock::timestamp() {
+    // localtime_r берет блокировку libc и читает часовой пояс - только при смене секунды
+    thread_local int64_t cached_second = -1;
+    thread_local char text[kTimestampLength + 1];
+    const int64_t second = int64_t(wallMs() / 1000);
+    if (second != cached_second) {
+        const std::time_t now_time = std::time_t(second);
+        std::tm local_time{};
+        localtime_r(&now_time, &local_time);
+        std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &local_time);
+        cached_second = second;
+    }
+    return std::string_view(text, kTimestampLength);
+}
@@ -0,0 +1,36 @@
+//Clock.h
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Общие часы процесса для горячего пути: сессии, CDR, лог.
+// Поток-тикер раз в tick читает монотонные и настенные часы и публикует их атомарно -
+// чтение стоит одной атомарной загрузки. Без тикера (тесты, клиент) часы читаются напрямую.
+// Точность - tick: метки времени отстают от реального времени не больше чем на шаг тикера.
+namespace coarseClock {
+
+    // Длина метки времени "YYYY-MM-DD HH:MM:SS"
+    constexpr size_t kTimestampLength = 19;
+
+    // Запустить тикер (поток "clock"); повторные вызовы только считают пользователей
+    void start(std::chrono::milliseconds tick = std::chrono::milliseconds(1));
+
+    // Остановить тикер, когда его отпустил последний пользователь
+    void stop();
+
+    bool isTicking();
+
+    // Монотонное время, мс (CLOCK_MONOTONIC)
+    uint64_t monotonicMs();
+
+    // Настенное время, мс от эпохи (CLOCK_REALTIME)
+    uint64_t wallMs();
+
+    // Локальное время "YYYY-MM-DD HH:MM:SS". Строка форматируется раз в секунду
+    // в буфер потока: действительна до следующего вызова в том же потоке
+    std::string_view timestamp();
+
+};
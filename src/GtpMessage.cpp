@@ -0,0 +1,162 @@
+//GtpMessage.cpp
+
+#include "GtpMessage.h"
+
+namespace gtp {
+
+    namespace {
+
+        constexpr uint8_t kFlagsWithTeid = (kVersion << 5) | 0x08;
+
+        uint16_t readU16(const uint8_t* p) {
+            return static_cast<uint16_t>((p[0] << 8) | p[1]);
+        }
+
+        void writeU16(uint8_t* p, uint16_t value) {
+            p[0] = static_cast<uint8_t>(value >> 8);
+            p[1] = static_cast<uint8_t>(value);
+        }
+
+        size_t writeHeader(uint8_t* buffer, MessageType type, uint16_t body_length,
+                           uint32_t teid, uint32_t sequence) {
+            buffer[0] = kFlagsWithTeid;
+            buffer[1] = static_cast<uint8_t>(type);
+            writeU16(buffer + 2, static_cast<uint16_t>(kHeaderSize - 4 + body_length));
+            buffer[4] = static_cast<uint8_t>(teid >> 24);
+            buffer[5] = static_cast<uint8_t>(teid >> 16);
+            buffer[6] = static_cast<uint8_t>(teid >> 8);
+            buffer[7] = static_cast<uint8_t>(teid);
+            buffer[8] = static_cast<uint8_t>(sequence >> 16);
+            buffer[9] = static_cast<uint8_t>(sequence >> 8);
+            buffer[10] = static_cast<uint8_t>(sequence);
+            buffer[11] = 0;
+            return kHeaderSize;
+        }
+
+        size_t writeIeHeader(uint8_t* buffer, IeType type, uint16_t length) {
+            buffer[0] = static_cast<uint8_t>(type);
+            writeU16(buffer + 1, length);
+            buffer[3] = 0;
+            return kIeHeaderSize;
+        }
+
+    }
+
+    std::string_view causeToText(Cause cause) {
+        switch (cause) {
+            case Cause::RequestAccepted:      return "created";
+            case Cause::ContextExists:        return "exists";
+            case Cause::NoResourcesAvailable:
+            case Cause::RequestRejected:      break;
+        }
+        return "rejected";
+    }
+
+    bool isGtpMessage(const uint8_t* data, size_t length) {
+        return length >= kHeaderSize && (data[0] >> 5) == kVersion;
+    }
+
+    MessageView::MessageView(const uint8_t* data, size_t length)
+    : m_data(data), m_length(length), m_valid(false) {
+        if (!isGtpMessage(data, length) || !(data[0] & 0x08)) return;
+        const size_t message_length = readU16(data + 2) + 4u;
+        if (message_length < kHeaderSize || message_length > length) return;
+        m_length = message_length;
+
+        // Все IE должны целиком помещаться в сообщение
+        size_t offset = kHeaderSize;
+        while (offset < m_length) {
+            if (m_length - offset < kIeHeaderSize) return;
+            const size_t ie_length = readU16(m_data + offset + 1);
+            offset += kIeHeaderSize + ie_length;
+            if (offset > m_length) return;
+        }
+        m_valid = true;
+    }
+
+    MessageType MessageView::type() const {
+        return static_cast<MessageType>(m_data[1]);
+    }
+
+    uint32_t MessageView::teid() const {
+        return (uint32_t(m_data[4]) << 24) | (uint32_t(m_data[5]) << 16) |
+               (uint32_t(m_data[6]) << 8) | uint32_t(m_data[7]);
+    }
+
+    uint32_t MessageView::sequence() const {
+        return (uint32_t(m_data[8]) << 16) | (uint32_t(m_data[9]) << 8) | uint32_t(m_data[10]);
+    }
+
+    bool MessageView::findIe(IeType type, IeView& ie) const {
+        if (!m_valid) return false;
+        size_t offset = kHeaderSize;
+        while (offset + kIeHeaderSize <= m_length) {
+            const uint16_t length = readU16(m_data + offset + 1);
+            if (m_data[offset] == static_cast<uint8_t>(type)) {
+                ie.type = type;
+                ie.instance = m_data[offset + 3] & 0x0F;
+                ie.value = m_data + offset + kIeHeaderSize;
+                ie.length = length;
+                return true;
+            }
+            offset += kIeHeaderSize + length;
+        }
+        return false;
+    }
+
+    size_t decodeImsi(const IeView& ie, char* digits, size_t capacity) {
+        if (ie.type != IeType::Imsi || ie.length == 0 || ie.length > kImsiBcdSize) return 0;
+        size_t count = 0;
+        for (size_t i = 0; i < ie.length; ++i) {
+            const uint8_t nibbles[2] = {
+                static_cast<uint8_t>(ie.value[i] & 0x0F),
+                static_cast<uint8_t>(ie.value[i] >> 4)
+            };
+            for (uint8_t nibble : nibbles) {
+                if (nibble == 0x0F) return count;
+                if (nibble > 9 || count == capacity) return 0;
+                digits[count++] = static_cast<char>('0' + nibble);
+            }
+        }
+        return count;
+    }
+
+    size_t encodeCreateSessionRequest(uint8_t* buffer, size_t capacity,
+                                      std::string_view imsi, uint32_t sequence) {
+        const size_t total = kHeaderSize + kIeHeaderSize + kImsiBcdSize;
+        if (imsi.empty() || imsi.size() > kMaxImsiDigits || capacity < total) return 0;
+
+        size_t offset = writeHeader(buffer, MessageType::CreateSessionRequest,
+                                    kIeHeaderSize + kImsiBcdSize, 0, sequence & kMaxSequence);
+        offset += writeIeHeader(buffer + offset, IeType::Imsi, kImsiBcdSize);
+        for (size_t i = 0; i < kImsiBcdSize; ++i) {
+            uint8_t byte = 0xFF;
+            for (size_t n = 0; n < 2; ++n) {
+                const size_t index = i * 2 + n;
+                if (index >= imsi.size()) break;
+                const char c = imsi[index];
+                if (c < '0' || c > '9') return 0;
+                const uint8_t digit = static_cast<uint8_t>(c - '0');
+                byte = n == 0 ? static_cast<uint8_t>(0xF0 | digit)
+                              : static_cast<uint8_t>((byte & 0x0F) | (digit << 4));
+            }
+            buffer[offset++] = byte;
+        }
+        return offset;
+    }
+
+    size_t encodeCreateSessionResponse(uint8_t* buffer, size_t capacity,
+                                       uint32_t sequence, Cause cause) {
+        constexpr uint16_t kCauseLength = 2;
+        const size_t total = kHeaderSize + kIeHeaderSize + kCauseLength;
+        if (capacity < total) return 0;
+
+        size_t offset = writeHeader(buffer, MessageType::CreateSessionResponse,
+                                    kIeHeaderSize + kCauseLength, 0, sequence & kMaxSequence);
+        offset += writeIeHeader(buffer + offset, IeType::Cause, kCauseLength);
+        buffer[offset++] = static_cast<uint8_t>(cause);
+        buffer[offset++] = 0;
+        return offset;
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+//GtpMessage.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Компактный бинарный протокол по образцу GTPv2-C Create Session Request/Response.
+//
+// Заголовок (12 байт, все поля big-endian):
+//   [0]     флаги: версия 2 в старших 3 битах, T=1 (есть TEID) -> 0x48
+//   [1]     тип сообщения
+//   [2..3]  длина сообщения без первых 4 байт
+//   [4..7]  TEID
+//   [8..10] номер последовательности (24 бита)
+//   [11]    резерв
+// Далее IE: тип (1), длина значения (2), резерв/instance (1), значение.
+// IMSI передается в IE типа 1 как 8 байт TBCD (младшая тетрада - первая цифра, заполнитель 0xF).
+namespace gtp {
+
+    constexpr uint8_t kVersion = 2;
+    constexpr size_t kHeaderSize = 12;
+    constexpr size_t kIeHeaderSize = 4;
+    constexpr size_t kImsiBcdSize = 8;
+    constexpr size_t kMaxImsiDigits = 15;
+    constexpr uint32_t kMaxSequence = 0xFFFFFF;
+
+    enum class MessageType : uint8_t {
+        CreateSessionRequest = 32,
+        CreateSessionResponse = 33
+    };
+
+    enum class IeType : uint8_t {
+        Imsi = 1,
+        Cause = 2
+    };
+
+    // Значения Cause; 17 используется для уже существующей сессии
+    enum class Cause : uint8_t {
+        RequestAccepted = 16,
+        ContextExists = 17,
+        NoResourcesAvailable = 73,
+        RequestRejected = 94
+    };
+
+    // Текстовый эквивалент ответа (как в текстовом протоколе)
+    std::string_view causeToText(Cause cause);
+
+    // Датаграмма бинарного протокола отличается от текстового IMSI по версии в первом байте
+    bool isGtpMessage(const uint8_t* data, size_t length);
+
+    // Представление IE поверх буфера приема (без копирования)
+    struct IeView {
+        IeType type;
+        uint8_t instance;
+        const uint8_t* value;
+        uint16_t length;
+    };
+
+    // Разбор сообщения поверх буфера приема без копирования
+    class MessageView {
+
+    public:
+
+        MessageView(const uint8_t* data, size_t length);
+
+        // Заголовок и границы IE корректны
+        bool valid() const { return m_valid; }
+
+        MessageType type() const;
+
+        uint32_t teid() const;
+
+        uint32_t sequence() const;
+
+        // Поиск первого IE заданного типа
+        bool findIe(IeType type, IeView& ie) const;
+
+    private:
+
+        const uint8_t* m_data;
+        size_t m_length;
+        bool m_valid;
+    };
+
+    // Декодирование IMSI из TBCD в цифры; возвращает кол-во цифр или 0 при ошибке
+    size_t decodeImsi(const IeView& ie, char* digits, size_t capacity);
+
+    // Кодирование запроса; возвращает длину сообщения или 0, если IMSI некорректен или не влез
+    size_t encodeCreateSessionRequest(uint8_t* buffer, size_t capacity,
+                                      std::string_view imsi, uint32_t sequence);
+
+    // Кодирование ответа с Cause; возвращает длину сообщения или 0
+    size_t encodeCreateSessionResponse(uint8_t* buffer, size_t capacity,
+                                       uint32_t sequence, Cause cause);
+
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 //Logger.cpp
 
 #include "Logger.h"
+#include "Clock.h"
 
 Logger::Logger(const std::string& log_file_path)
 : m_running(false) {
@@ -51,20 +52,38 @@ void Logger::sendToLog(const std::string& message) {
     m_condition.notify_one();
 }
 
+void Logger::sendToLog(LogLevel level, const std::string& message) {
+    if (!isEnabled(level)) return;
+    sendToLog(message);
+}
+
+void Logger::setLevel(LogLevel level) {
+    m_level.store(level, std::memory_order_relaxed);
+}
+
+bool Logger::isEnabled(LogLevel level) const {
+    return level >= m_level.load(std::memory_order_relaxed);
+}
+
+LogLevel Logger::parseLevel(const std::string& name) {
+    if (name == "DEBUG" || name == "debug") return LogLevel::Debug;
+    if (name == "INFO" || name == "info") return LogLevel::Info;
+    if (name == "WARN" || name == "warn" || name == "WARNING") return LogLevel::Warning;
+    if (name == "ERROR" || name == "error") return LogLevel::Error;
+    throw std::invalid_argument("Unknown log level: " + name);
+}
+
 void Logger::writeToFile(const std::string &message) {
     if (!m_log.is_open()) return;
     try {
-        const auto now = std::chrono::system_clock::now();
-        const auto now_time = std::chrono::system_clock::to_time_t(now);
-        char timestamp[20];
-        std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", std::localtime(&now_time));
-        m_log << "[" << timestamp << "] " << message << std::endl;
+        m_log << "[" << coarseClock::timestamp() << "] " << message << std::endl;
     } catch (...) {
         spdlog::error("Failed to write log message");
     }
 }
 
 void Logger::processMessages() {
+    threadPlacement::apply("logger");
     while (true) {
         std::unique_lock<std::mutex> lock(m_queue_mutex);
         
@@ -11,6 +11,15 @@
 #include <memory>
 #include <spdlog/spdlog.h>
 #include "ConfigDirPath.h"
+#include "ThreadPlacement.h"
+
+// Уровень сообщений файлового лога
+enum class LogLevel {
+    Debug = 0,
+    Info,
+    Warning,
+    Error
+};
 
 class Logger {
 
@@ -29,6 +38,18 @@ public:
     // Отправить сообщение в лог (добавляет в очередь)
     void sendToLog(const std::string& message);
 
+    // Отправить сообщение с уровнем (отбрасывается, если уровень ниже порога)
+    void sendToLog(LogLevel level, const std::string& message);
+
+    // Порог уровня сообщений
+    void setLevel(LogLevel level);
+
+    // Проверка перед формированием дорогих сообщений на горячем пути
+    bool isEnabled(LogLevel level) const;
+
+    // Разбор уровня из конфигурации ("DEBUG", "INFO", "WARN", "ERROR")
+    static LogLevel parseLevel(const std::string& name);
+
     // Записать сообщение непосредственно в файл
     void writeToFile(const std::string& message);
 
@@ -47,4 +68,6 @@ private:
     std::condition_variable m_condition;// Условная переменная для ожидания сообщений
     
     std::atomic<bool> m_running;// Флаг работы логгера
+
+    std::atomic<LogLevel> m_level{LogLevel::Info};// Порог уровня сообщений
 };
\ No newline at end of file
@@ -0,0 +1,29 @@
+//TextProtocol.h
+
+#pragma once
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+
+// Текстовый протокол: "IMSI" или "IMSI#seq".
+// Номер последовательности необязателен; сервер возвращает его в ответе ("created#seq"),
+// чтобы клиент отличал ответ на повтор от ответа на предыдущий запрос.
+namespace textProtocol {
+
+    constexpr char kSequenceSeparator = '#';
+
+    // Разделить запрос/ответ на тело и номер; false - номера нет или он некорректен
+    inline bool splitSequence(std::string_view message, std::string_view& body, uint32_t& sequence) {
+        body = message;
+        const size_t pos = message.rfind(kSequenceSeparator);
+        if (pos == std::string_view::npos) return false;
+
+        const char* first = message.data() + pos + 1;
+        const char* last = message.data() + message.size();
+        const auto result = std::from_chars(first, last, sequence);
+        if (result.ec != std::errc() || result.ptr != last || first == last) return false;
+        body = message.substr(0, pos);
+        return true;
+    }
+
+};
@@ -0,0 +1,142 @@
+//ThreadPlacement.cpp
+
+#include "ThreadPlacement.h"
+
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <pthread.h>
+#include <sched.h>
+#include <spdlog/spdlog.h>
+
+namespace {
+
+    // Имя потока в Linux - не длиннее 15 символов
+    constexpr size_t kMaxThreadName = 15;
+
+    std::mutex registry_mutex;
+    std::map<std::string, ThreadRole> registry;
+
+    int parseCpu(const std::string& token, const std::string& list) {
+        size_t pos = 0;
+        int cpu = -1;
+        try {
+            cpu = std::stoi(token, &pos);
+        } catch (const std::exception&) {
+            pos = 0;
+        }
+        if (pos != token.size() || cpu < 0 || cpu >= CPU_SETSIZE) {
+            throw std::invalid_argument("Invalid CPU list: " + list);
+        }
+        return cpu;
+    }
+
+    std::string trim(const std::string& value) {
+        const size_t first = value.find_first_not_of(" \t");
+        if (first == std::string::npos) return "";
+        const size_t last = value.find_last_not_of(" \t");
+        return value.substr(first, last - first + 1);
+    }
+
+    void place(const std::string& role, const std::string& name, const std::vector<int>& cpus) {
+        const std::string thread_name = name.substr(0, kMaxThreadName);
+        pthread_setname_np(pthread_self(), thread_name.c_str());
+        if (cpus.empty()) return;
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus) CPU_SET(cpu, &set);
+        const int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (error != 0) {
+            spdlog::warn("Failed to pin thread {} (role {}): {}", thread_name, role, std::strerror(error));
+            return;
+        }
+        std::ostringstream list;
+        for (size_t i = 0; i < cpus.size(); ++i) list << (i ? "," : "") << cpus[i];
+        spdlog::debug("Thread {} pinned to CPU {}", thread_name, list.str());
+    }
+
+    void applyRole(const std::string& role, const size_t* index) {
+        ThreadRole placement = threadPlacement::getRole(role);
+        std::string name = placement.name.empty() ? "pgw-" + role : placement.name;
+        if (index) name += "-" + std::to_string(*index);
+
+        if (index && placement.pin_each && !placement.cpus.empty()) {
+            placement.cpus = {placement.cpus[*index % placement.cpus.size()]};
+        }
+        place(role, name, placement.cpus);
+    }
+
+}
+
+std::vector<int> threadPlacement::parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream stream(list);
+    std::string token;
+    while (std::getline(stream, token, ',')) {
+        token = trim(token);
+        if (token.empty()) continue;
+
+        const size_t dash = token.find('-');
+        if (dash == std::string::npos) {
+            cpus.push_back(parseCpu(token, list));
+            continue;
+        }
+        const int first = parseCpu(trim(token.substr(0, dash)), list);
+        const int last = parseCpu(trim(token.substr(dash + 1)), list);
+        if (last < first) throw std::invalid_argument("Invalid CPU list: " + list);
+        for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+void threadPlacement::configure(const nlohmann::json& threads) {
+    std::map<std::string, ThreadRole> roles;
+    for (const auto& [role, entry] : threads.items()) {
+        if (!entry.is_object()) continue;
+
+        ThreadRole placement;
+        if (entry.contains("cpus")) {
+            const auto& cpus = entry["cpus"];
+            placement.cpus = cpus.is_string() ? parseCpuList(cpus.get<std::string>())
+                                              : cpus.get<std::vector<int>>();
+            for (int cpu : placement.cpus) {
+                if (cpu < 0 || cpu >= CPU_SETSIZE) {
+                    throw std::invalid_argument("Invalid CPU " + std::to_string(cpu) + " for role " + role);
+                }
+            }
+        }
+        placement.name = entry.value("name", std::string());
+        placement.pin_each = entry.value("pin_each", false);
+        roles[role] = placement;
+    }
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    registry = std::move(roles);
+}
+
+void threadPlacement::setRole(const std::string& role, const ThreadRole& placement) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    registry[role] = placement;
+}
+
+ThreadRole threadPlacement::getRole(const std::string& role) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    const auto it = registry.find(role);
+    return it != registry.end() ? it->second : ThreadRole{};
+}
+
+void threadPlacement::clear() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    registry.clear();
+}
+
+void threadPlacement::apply(const std::string& role) {
+    applyRole(role, nullptr);
+}
+
+void threadPlacement::apply(const std::string& role, size_t index) {
+    applyRole(role, &index);
+}
@@ -0,0 +1,38 @@
+//ThreadPlacement.h
+
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+// Размещение потоков одной роли (udp, processing, http, cleanup, logger, clock, replication)
+struct ThreadRole {
+    std::vector<int> cpus;      // Допустимые ядра (пусто - решает планировщик)
+    std::string name;           // Префикс имени потока (пусто - "pgw-<роль>")
+    bool pin_each = false;      // Поток с номером i - только на cpus[i % size]
+};
+
+// Привязка потоков сервера к ядрам и имена потоков (видны в top -H, perf, /proc).
+// Настройки задаются один раз при запуске; каждый поток применяет их к себе сам.
+namespace threadPlacement {
+
+    // Разбор списка ядер в формате "0-3,8,10-11"
+    std::vector<int> parseCpuList(const std::string& list);
+
+    // Загрузить роли из секции "threads" конфигурации (заменяет прежние)
+    void configure(const nlohmann::json& threads);
+
+    void setRole(const std::string& role, const ThreadRole& placement);
+
+    ThreadRole getRole(const std::string& role);
+
+    void clear();
+
+    // Применить роль к текущему потоку: имя "<name>" и маска ядер
+    void apply(const std::string& role);
+
+    // То же для потока с номером: имя "<name>-<index>"
+    void apply(const std::string& role, size_t index);
+
+};
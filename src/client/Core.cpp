@@ -18,12 +18,16 @@ Core::Core(std::shared_ptr<Logger> log)
         // Инициализация UDP клиента
         std::string server_ip = m_config["server_ip"];
         uint16_t server_port = m_config["server_port"];
+        UdpProtocol protocol = parseUdpProtocol(m_config.value("protocol", std::string("text")));
         
         m_udp_client = std::make_unique<UdpClient>(
             server_ip, 
             server_port, 
-            m_log
+            m_log,
+            protocol
         );
+        m_udp_client->setRetryPolicy(m_config.value("retries", 0u),
+                                     m_config.value("timeout_ms", 0u));
         
         spdlog::info("Core initialized successfully");
     } 
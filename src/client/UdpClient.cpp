@@ -2,10 +2,17 @@
 
 #include "UdpClient.h"
 
+UdpProtocol parseUdpProtocol(const std::string& name) {
+    if (name == "text") return UdpProtocol::Text;
+    if (name == "binary") return UdpProtocol::Binary;
+    throw std::invalid_argument("Unknown protocol: " + name);
+}
+
 UdpClient::UdpClient(const std::string& server_ip, 
     const uint16_t& server_port,
-    std::shared_ptr<Logger> log)
-    : m_log(log) {
+    std::shared_ptr<Logger> log,
+    UdpProtocol protocol)
+    : m_log(log), m_protocol(protocol) {
     createSocket();
     setupServerAddress(server_ip, server_port);
 }
@@ -39,20 +46,88 @@ void UdpClient::setupServerAddress(const std::string& ip, uint16_t port) {
     spdlog::info("Server address configured: {}:{}", ip, port);
 }
 
+void UdpClient::setRetryPolicy(uint32_t retries, uint32_t timeout_ms) {
+    m_retries = retries;
+    m_timeout_ms = timeout_ms;
+    timeval timeout{static_cast<time_t>(timeout_ms / 1000),
+                    static_cast<suseconds_t>((timeout_ms % 1000) * 1000)};
+    if (setsockopt(m_sockfd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0) {
+        throw std::system_error(errno, std::generic_category(), "setsockopt(SO_RCVTIMEO) failed");
+    }
+}
+
 std::string UdpClient::sendRequest(const std::string& imsi) {
     socklen_t len = sizeof(m_server_addr);
-    ssize_t send_to = sendto(m_sockfd, imsi.c_str(), imsi.size(), 0,
-          (sockaddr*)&m_server_addr, len);
+    const uint32_t sequence = (++m_sequence) & gtp::kMaxSequence;
+    uint8_t request[64];
+    std::string text_request = imsi;
+    const char* payload = text_request.c_str();
+    size_t payload_len = text_request.size();
+    if (m_protocol == UdpProtocol::Binary) {
+        payload_len = gtp::encodeCreateSessionRequest(request, sizeof(request), imsi, sequence);
+        if (payload_len == 0) {
+            throw std::invalid_argument("IMSI cannot be encoded: " + imsi);
+        }
+        payload = reinterpret_cast<const char*>(request);
+    } else if (m_timeout_ms > 0) {
+        text_request += textProtocol::kSequenceSeparator + std::to_string(sequence);
+        payload = text_request.c_str();
+        payload_len = text_request.size();
+    }
+
     char buffer[1024];
-    ssize_t n = recvfrom(m_sockfd, buffer, sizeof(buffer), 0,
-                    (sockaddr*)&m_server_addr, &len);    
-    if (n < 0) {
-        m_log->sendToLog("No response from server");
-        spdlog::warn("No response from server");
-        return "error";
-    }
-
-    m_log->sendToLog("Server response: " + std::string(buffer, n));
-    spdlog::info("Server response: {}", std::string(buffer, n));
-    return std::string(buffer, n);
-}
\ No newline at end of file
+    for (uint32_t attempt = 0; attempt <= m_retries; ++attempt) {
+        if (attempt > 0) {
+            m_log->sendToLog("No response from server, retransmitting (attempt " +
+                             std::to_string(attempt + 1) + ")");
+            spdlog::warn("No response from server, retransmitting (attempt {})", attempt + 1);
+        }
+        sendto(m_sockfd, payload, payload_len, 0, (sockaddr*)&m_server_addr, len);
+
+        // Ответы на прошлые попытки и запросы пропускаем до истечения таймаута
+        ssize_t n;
+        while ((n = recvfrom(m_sockfd, buffer, sizeof(buffer), 0,
+                             (sockaddr*)&m_server_addr, &len)) >= 0) {
+            std::string response;
+            if (!decodeResponse(buffer, n, sequence, response)) continue;
+            m_log->sendToLog("Server response: " + response);
+            spdlog::info("Server response: {}", response);
+            return response;
+        }
+    }
+
+    m_log->sendToLog("No response from server");
+    spdlog::warn("No response from server");
+    return "error";
+}
+
+bool UdpClient::decodeResponse(const char* data, size_t len, uint32_t sequence,
+                               std::string& response) const {
+    if (m_protocol == UdpProtocol::Binary) {
+        return decodeBinaryResponse(data, len, sequence, response);
+    }
+    std::string_view body;
+    uint32_t response_sequence = 0;
+    if (textProtocol::splitSequence(std::string_view(data, len), body, response_sequence) &&
+        response_sequence != sequence) {
+        return false;
+    }
+    response.assign(body);
+    return true;
+}
+
+bool UdpClient::decodeBinaryResponse(const char* data, size_t len, uint32_t sequence,
+                                     std::string& response) const {
+    const gtp::MessageView message(reinterpret_cast<const uint8_t*>(data), len);
+    gtp::IeView cause_ie{};
+    if (!message.valid() ||
+        message.type() != gtp::MessageType::CreateSessionResponse ||
+        !message.findIe(gtp::IeType::Cause, cause_ie) || cause_ie.length < 1) {
+        m_log->sendToLog("Malformed binary response from server");
+        spdlog::warn("Malformed binary response from server");
+        return false;
+    }
+    if (message.sequence() != sequence) return false;
+    response = std::string(gtp::causeToText(static_cast<gtp::Cause>(cause_ie.value[0])));
+    return true;
+}
@@ -11,6 +11,16 @@
 #include <sys/socket.h>
 #include <cstring>
 #include "../Logger.h"
+#include "../GtpMessage.h"
+#include "../TextProtocol.h"
+
+// Формат запросов к серверу
+enum class UdpProtocol {
+    Text,       // IMSI строкой ASCII
+    Binary      // Create Session Request (GTPv2-C подобный)
+};
+
+UdpProtocol parseUdpProtocol(const std::string& name);
 
 class UdpClient {
 
@@ -18,22 +28,44 @@ public:
 
     UdpClient(const std::string& server_ip, 
         const uint16_t& server_port,
-        std::shared_ptr<Logger> log);
+        std::shared_ptr<Logger> log,
+        UdpProtocol protocol = UdpProtocol::Text);
 
     ~UdpClient();
 
+    // Отправка IMSI; ответ в текстовом виде ("created", "exists", "rejected")
     std::string sendRequest(const std::string& imsi);
 
+    // Повторы при отсутствии ответа: timeout_ms на попытку (0 - ждать без ограничения).
+    // С таймаутом текстовые запросы несут номер последовательности ("IMSI#seq"),
+    // повтор отправляется с тем же номером и сервер отвечает на него из кэша
+    void setRetryPolicy(uint32_t retries, uint32_t timeout_ms);
+
 private:
 
     void createSocket();
     
     void setupServerAddress(const std::string& ip, uint16_t port);
 
+    // Разбор ответа; false - ответ не на этот запрос (опоздавший) или некорректен
+    bool decodeResponse(const char* data, size_t len, uint32_t sequence, std::string& response) const;
+
+    // Разбор бинарного ответа в текстовый вид
+    bool decodeBinaryResponse(const char* data, size_t len, uint32_t sequence,
+                              std::string& response) const;
+
     int m_sockfd;
 
     sockaddr_in m_server_addr;
 
     std::shared_ptr<Logger> m_log;
 
+    UdpProtocol m_protocol;
+
+    uint32_t m_sequence = 0;            // Номер последовательности запросов
+
+    uint32_t m_retries = 0;             // Повторных отправок без ответа
+
+    uint32_t m_timeout_ms = 0;          // Ожидание ответа на одну попытку (0 - без ограничения)
+
 };
\ No newline at end of file
@@ -0,0 +1,271 @@
+//Blacklist.cpp
+
+#include "Blacklist.h"
+#include "SessionTable.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+    // Заголовок бинарного образа: kMagic и число ключей
+    constexpr size_t kHeaderSize = sizeof(Blacklist::kMagic) + sizeof(uint64_t);
+
+    // Строка текстового файла без пробелов и комментария
+    std::string_view trimLine(std::string_view line) {
+        const size_t comment = line.find('#');
+        if (comment != std::string_view::npos) line = line.substr(0, comment);
+        const size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string_view::npos) return {};
+        const size_t end = line.find_last_not_of(" \t\r");
+        return line.substr(begin, end - begin + 1);
+    }
+
+    void writeAll(int fd, const char* data, size_t size, const std::string& path) {
+        while (size > 0) {
+            const ssize_t written = ::write(fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error("Failed to write blacklist file " + path + ": " + std::strerror(errno));
+            }
+            data += written;
+            size -= size_t(written);
+        }
+    }
+
+    void sortUnique(std::vector<uint64_t>& keys) {
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    }
+
+}
+
+void to_json(nlohmann::json& j, const BlacklistStats& stats) {
+    j = nlohmann::json{
+        {"entries", stats.entries},
+        {"file_entries", stats.file_entries},
+        {"invalid_entries", stats.invalid_entries},
+        {"prefix_rules", stats.prefix_rules},
+        {"range_rules", stats.range_rules},
+        {"trie_nodes", stats.trie_nodes},
+        {"memory_bytes", stats.memory_bytes},
+        {"mapped_bytes", stats.mapped_bytes},
+        {"bloom_bytes", stats.bloom_bytes},
+        {"load_ms", stats.load_ms},
+        {"file", stats.file},
+        {"mapped", stats.mapped}
+    };
+}
+
+Blacklist::Blacklist(const std::vector<std::string>& imsis, const std::string& file) {
+    const auto started = std::chrono::steady_clock::now();
+
+    for (const std::string& entry : imsis) {
+        if (!addEntry(entry)) ++m_stats.invalid_entries;
+    }
+    if (!file.empty()) {
+        m_stats.file = file;
+        if (!mapBinary(file)) loadText(file);
+    }
+    sortUnique(m_owned);
+    m_owned.shrink_to_fit();
+    m_rules.shrink();
+    buildBloom();
+
+    m_stats.entries = size();
+    m_stats.trie_nodes = m_rules.empty() ? 0 : m_rules.nodes();
+    m_stats.bloom_bytes = m_bloom.size() * sizeof(uint64_t);
+    m_stats.memory_bytes = m_owned.capacity() * sizeof(uint64_t) + m_stats.bloom_bytes +
+                           m_rules.memoryBytes();
+    m_stats.mapped_bytes = m_mapping_size;
+    m_stats.mapped = m_mapping != nullptr;
+    m_stats.load_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - started).count();
+}
+
+Blacklist::~Blacklist() {
+    if (m_mapping) munmap(m_mapping, m_mapping_size);
+}
+
+bool Blacklist::addEntry(std::string_view entry) {
+    try {
+        if (!entry.empty() && entry.back() == '*') {
+            m_rules.addPrefix(entry.substr(0, entry.size() - 1));
+            ++m_stats.prefix_rules;
+            return true;
+        }
+        const size_t dash = entry.find('-');
+        if (dash != std::string_view::npos) {
+            m_rules.addRange(entry.substr(0, dash), entry.substr(dash + 1));
+            ++m_stats.range_rules;
+            return true;
+        }
+    } catch (const std::invalid_argument&) {
+        return false;
+    }
+    const uint64_t key = imsiKey::pack(entry);
+    if (key == 0) return false;
+    m_owned.push_back(key);
+    return true;
+}
+
+void Blacklist::loadText(const std::string& file) {
+    std::ifstream input(file);
+    if (!input.is_open()) {
+        throw std::runtime_error("Failed to open blacklist file: " + file);
+    }
+    const size_t before = m_owned.size();
+    std::string line;
+    while (std::getline(input, line)) {
+        const std::string_view entry = trimLine(line);
+        if (entry.empty()) continue;
+        if (!addEntry(entry)) ++m_stats.invalid_entries;
+    }
+    m_stats.file_entries = m_owned.size() - before;
+}
+
+bool Blacklist::mapBinary(const std::string& file) {
+    const int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open blacklist file: " + file + ": " + std::strerror(errno));
+    }
+    char magic[sizeof(kMagic)] = {};
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < kHeaderSize ||
+        pread(fd, magic, sizeof(magic), 0) != ssize_t(sizeof(magic)) ||
+        std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+        close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to mmap blacklist file: " + file + ": " + std::strerror(errno));
+    }
+    m_mapping = mapping;
+    m_mapping_size = size_t(st.st_size);
+    // Деструктор не вызовется, если конструктор бросит исключение
+    auto corrupted = [&](const char* reason) {
+        munmap(m_mapping, m_mapping_size);
+        m_mapping = nullptr;
+        m_mapping_size = 0;
+        m_mapped = nullptr;
+        m_mapped_count = 0;
+        return std::runtime_error(std::string("Corrupted blacklist file (") + reason + "): " + file);
+    };
+
+    uint64_t count = 0;
+    std::memcpy(&count, static_cast<const char*>(mapping) + sizeof(kMagic), sizeof(count));
+    if (count != (m_mapping_size - kHeaderSize) / sizeof(uint64_t) ||
+        m_mapping_size != kHeaderSize + count * sizeof(uint64_t)) {
+        throw corrupted("size mismatch");
+    }
+    m_mapped = reinterpret_cast<const uint64_t*>(static_cast<const char*>(mapping) + kHeaderSize);
+    m_mapped_count = size_t(count);
+    // Двоичный поиск требует строгого порядка; проверка - один последовательный проход
+    for (size_t i = 1; i < m_mapped_count; ++i) {
+        if (m_mapped[i - 1] >= m_mapped[i]) throw corrupted("keys not sorted");
+    }
+    if (m_mapped_count > 0 && m_mapped[0] == 0) throw corrupted("empty key");
+    madvise(mapping, m_mapping_size, MADV_RANDOM);
+    m_stats.file_entries = m_mapped_count;
+    return true;
+}
+
+void Blacklist::buildBloom() {
+    const size_t keys = size();
+    if (keys == 0) return;
+    const size_t bits = keys * kBloomBitsPerKey;
+    m_bloom_blocks = (bits + kBlockWords * 64 - 1) / (kBlockWords * 64);
+    m_bloom.assign(m_bloom_blocks * kBlockWords, 0);
+    for (uint64_t key : m_owned) addToBloom(key);
+    for (size_t i = 0; i < m_mapped_count; ++i) addToBloom(m_mapped[i]);
+}
+
+void Blacklist::addToBloom(uint64_t key) {
+    const uint64_t hash = SessionTable::hash(key);
+    // Блок - по старшим битам (умножение вместо деления), биты внутри - двойным хэшированием
+    uint64_t* block = &m_bloom[((hash >> 32) * m_bloom_blocks >> 32) * kBlockWords];
+    const uint32_t h1 = uint32_t(hash);
+    const uint32_t h2 = uint32_t(hash >> 41) | 1;
+    for (size_t i = 0; i < kBloomHashes; ++i) {
+        const uint32_t bit = (h1 + uint32_t(i) * h2) & (kBlockWords * 64 - 1);
+        block[bit >> 6] |= uint64_t(1) << (bit & 63);
+    }
+}
+
+bool Blacklist::mayContain(uint64_t key) const {
+    if (m_bloom_blocks == 0) return false;
+    const uint64_t hash = SessionTable::hash(key);
+    const uint64_t* block = &m_bloom[((hash >> 32) * m_bloom_blocks >> 32) * kBlockWords];
+    const uint32_t h1 = uint32_t(hash);
+    const uint32_t h2 = uint32_t(hash >> 41) | 1;
+    for (size_t i = 0; i < kBloomHashes; ++i) {
+        const uint32_t bit = (h1 + uint32_t(i) * h2) & (kBlockWords * 64 - 1);
+        if (!(block[bit >> 6] & (uint64_t(1) << (bit & 63)))) return false;
+    }
+    return true;
+}
+
+bool Blacklist::contains(uint64_t key) const {
+    if (key == 0) return false;
+    if (mayContain(key) &&
+        (std::binary_search(m_owned.begin(), m_owned.end(), key) ||
+         std::binary_search(m_mapped, m_mapped + m_mapped_count, key))) {
+        return true;
+    }
+    if (m_rules.empty()) return false;
+    char digits[imsiKey::kMaxDigits];
+    return m_rules.matches(std::string_view(digits, imsiKey::unpack(key, digits)));
+}
+
+bool Blacklist::contains(std::string_view imsi) const {
+    return contains(imsiKey::pack(imsi));
+}
+
+size_t Blacklist::compile(const std::string& text_file, const std::string& binary_file) {
+    Blacklist source({}, text_file);
+    if (source.m_mapping) {
+        throw std::runtime_error("Blacklist file is already binary: " + text_file);
+    }
+    if (!source.m_rules.empty()) {
+        throw std::runtime_error("Prefix/range rules cannot be compiled into a binary blacklist "
+                                 "(keep them in a text file or in the config): " + text_file);
+    }
+    const uint64_t count = source.m_owned.size();
+    // Запись во временный файл и переименование: работающий сервер держит прежний образ
+    // отображенным, и усечение его на месте обернулось бы SIGBUS при чтении
+    const std::string temp_path = binary_file + ".tmp";
+    const int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create blacklist file " + temp_path + ": " + std::strerror(errno));
+    }
+    try {
+        writeAll(fd, kMagic, sizeof(kMagic), temp_path);
+        writeAll(fd, reinterpret_cast<const char*>(&count), sizeof(count), temp_path);
+        writeAll(fd, reinterpret_cast<const char*>(source.m_owned.data()), count * sizeof(uint64_t), temp_path);
+        if (::fsync(fd) != 0) {
+            throw std::runtime_error("Failed to sync blacklist file " + temp_path + ": " + std::strerror(errno));
+        }
+    } catch (...) {
+        ::close(fd);
+        ::unlink(temp_path.c_str());
+        throw;
+    }
+    ::close(fd);
+    if (::rename(temp_path.c_str(), binary_file.c_str()) != 0) {
+        const std::string error = std::strerror(errno);
+        ::unlink(temp_path.c_str());
+        throw std::runtime_error("Failed to replace blacklist file " + binary_file + ": " + error);
+    }
+    return size_t(count);
+}
@@ -0,0 +1,105 @@
+//Blacklist.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "DigitTrie.h"
+
+// Размер и время загрузки черного списка
+struct BlacklistStats {
+    uint64_t entries = 0;               // Уникальных IMSI всего
+    uint64_t file_entries = 0;          // Из них из внешнего файла
+    uint64_t invalid_entries = 0;       // Записи списка и строки файла, не являющиеся IMSI или правилом
+    uint64_t prefix_rules = 0;
+    uint64_t range_rules = 0;
+    uint64_t trie_nodes = 0;
+    uint64_t memory_bytes = 0;          // Память процесса: ключи, фильтр Блума и дерево правил
+    uint64_t mapped_bytes = 0;          // Ключи бинарного файла в mmap (страничный кэш)
+    uint64_t bloom_bytes = 0;
+    double load_ms = 0.0;
+    std::string file;
+    bool mapped = false;
+};
+
+void to_json(nlohmann::json& j, const BlacklistStats& stats);
+
+// Черный список IMSI: упакованные ключи (imsiKey) в отсортированных массивах,
+// перед ними блочный фильтр Блума - отрицательная проверка стоит одного промаха кэша.
+// Кроме IMSI, запись списка может быть правилом: "25099*" - префикс (MCC/MNC),
+// "250990000000000-250990000999999" - диапазон; правила компилируются в DigitTrie.
+// Внешний файл - текст (запись по строке, '#' - комментарий) или бинарный образ
+// (kMagic, число ключей, отсортированные uint64_t), который отображается через mmap.
+// После загрузки не меняется: проверки идут без блокировок.
+class Blacklist {
+
+public:
+
+    static constexpr char kMagic[8] = {'P', 'G', 'W', 'B', 'L', 'K', '0', '1'};
+
+    // Бит фильтра на ключ: ~1% ложных срабатываний
+    static constexpr size_t kBloomBitsPerKey = 10;
+
+    // imsis - список из конфигурации; file - внешний файл (пусто - только список)
+    explicit Blacklist(const std::vector<std::string>& imsis = {}, const std::string& file = "");
+
+    ~Blacklist();
+
+    Blacklist(const Blacklist&) = delete;
+    Blacklist& operator=(const Blacklist&) = delete;
+
+    bool contains(uint64_t key) const;
+
+    // Цифры IMSI; некорректный IMSI в списке не бывает
+    bool contains(std::string_view imsi) const;
+
+    // Только фильтр Блума: false - ключа точно нет
+    bool mayContain(uint64_t key) const;
+
+    // Точных IMSI (без правил)
+    size_t size() const { return m_owned.size() + m_mapped_count; }
+
+    BlacklistStats getStats() const { return m_stats; }
+
+    // Бинарный образ из текстового файла; возвращает число ключей. Правила в образ не входят
+    static size_t compile(const std::string& text_file, const std::string& binary_file);
+
+private:
+
+    static constexpr size_t kBlockWords = 8;        // Блок фильтра - одна кэш-линия
+    static constexpr size_t kBloomHashes = 7;
+
+    // IMSI или правило; false - запись некорректна
+    bool addEntry(std::string_view entry);
+
+    void loadText(const std::string& file);
+
+    // false - файл не бинарный образ
+    bool mapBinary(const std::string& file);
+
+    void buildBloom();
+
+    void addToBloom(uint64_t key);
+
+    std::vector<uint64_t> m_owned;          // Список конфигурации и текстовый файл
+
+    const uint64_t* m_mapped = nullptr;     // Ключи бинарного образа
+
+    size_t m_mapped_count = 0;
+
+    void* m_mapping = nullptr;
+
+    size_t m_mapping_size = 0;
+
+    DigitTrie m_rules;
+
+    std::vector<uint64_t> m_bloom;
+
+    size_t m_bloom_blocks = 0;
+
+    BlacklistStats m_stats;
+};
@@ -3,14 +3,16 @@
 #include "Core.h"
 
 namespace {
-    Core* core_instance = nullptr;
+    // Обработчик только выставляет флаги: остановку и перезагрузку выполняет основной цикл
+    // (stopIfRequested, reloadIfRequested) - обработчик может прервать поток, держащий блокировку
+    volatile std::sig_atomic_t reload_requested = 0;
+    volatile std::sig_atomic_t stop_requested = 0;
 
     void signal_handler(int signal) {
         if (signal == SIGINT || signal == SIGTERM) {
-            spdlog::warn("Received shutdown signal");
-            if (core_instance) {
-                core_instance->stop();
-            }
+            stop_requested = 1;
+        } else if (signal == SIGHUP) {
+            reload_requested = 1;
         }
     }
 }
@@ -21,11 +23,12 @@ Core::Core(std::shared_ptr<Logger> log)
     try {
         loadConfig(configDirPath::serverConfig());
         initSessionManager();
+        initReplication();
         initUdpServer();
         initHttpServer();
         std::signal(SIGINT, signal_handler);
         std::signal(SIGTERM, signal_handler);
-        core_instance = this;
+        std::signal(SIGHUP, signal_handler);
     } catch (const std::exception& e) {
         spdlog::critical("Initialization failed: {}", e.what());
         throw;
@@ -33,20 +36,37 @@ Core::Core(std::shared_ptr<Logger> log)
 }
 
 Core::~Core() {
-    if (core_instance == this) core_instance = nullptr;
     stop();
+    waitForShutdown();
+    if (m_clock_ticking) coarseClock::stop();
     spdlog::info("Core cleanup completed");
 }
 
 void Core::start() {
     spdlog::info("Starting servers...");
 
-    m_session_manager->startCleanupTimer();
-    m_udp_server->start();
+    // Часы горячего пути: сессии, CDR и лог читают время, опубликованное тикером
+    const uint32_t clock_tick_ms = m_config.value("clock_tick_ms", 1u);
+    if (clock_tick_ms > 0 && !m_clock_ticking) {
+        coarseClock::start(std::chrono::milliseconds(clock_tick_ms));
+        m_clock_ticking = true;
+    }
+
+    if (!m_cleanup_in_event_loop) {
+        m_session_manager->startCleanupTimer();
+    }
+    m_session_manager->startSnapshotTimer();
+    if (m_replicator) m_replicator->start();
+    for (auto& udp_server : m_udp_servers) {
+        udp_server->start();
+    }
     m_http_server->start();
 
     spdlog::info("Server started successfully");
-    spdlog::info("UDP port: {}", m_config["udp_port"].get<uint16_t>());
+    for (const auto& udp_server : m_udp_servers) {
+        spdlog::info("UDP listen: {} ({} sockets)",
+                     udp_server->getEndpoint(), udp_server->getSockfds().size());
+    }
     spdlog::info("HTTP port: {}", m_config["http_port"].get<uint16_t>());
 }
 
@@ -56,15 +76,86 @@ void Core::stop() {
     m_shutdown_flag = true;
     spdlog::info("Shutting down servers...");
     
-    m_udp_server->stop();
+    for (auto& udp_server : m_udp_servers) {
+        udp_server->stop();
+    }
+    // HTTP работает до конца выгрузки: проверки абонентов и ее ход в /metrics
+    m_session_manager->startDrain();
+}
+
+void Core::waitForShutdown() {
+    const DrainStats drain = m_session_manager->getDrainStats();
+    if (drain.state == "draining") {
+        spdlog::info("Waiting for session drain: {} of {} session(s) left, ETA {:.0f} s",
+                     drain.remaining, drain.total, drain.eta_sec);
+    }
+    m_session_manager->waitDrain();
+    // Изменения выгрузки уходят резервному до закрытия соединения
+    if (m_replicator) m_replicator->stop();
     m_http_server->stop();
-    m_session_manager->stopCleanupTimer();
 }
 
 bool Core::isRunning() const { 
     return !m_shutdown_flag; 
 }
 
+void Core::stopIfRequested() {
+    if (!stop_requested) return;
+    stop_requested = 0;
+    spdlog::warn("Received shutdown signal");
+    stop();
+}
+
+void Core::reloadIfRequested() {
+    if (!reload_requested) return;
+    reload_requested = 0;
+    spdlog::info("SIGHUP: reloading configuration");
+    try {
+        reload();
+    } catch (const std::exception& e) {
+        spdlog::error("Reload failed, previous settings kept: {}", e.what());
+    }
+}
+
+nlohmann::json Core::reload() {
+    // Перезагрузки по SIGHUP и по HTTP не выполняются одновременно
+    std::lock_guard<std::mutex> lock(m_reload_mutex);
+    const auto started = std::chrono::steady_clock::now();
+
+    const std::string config_path = configDirPath::serverConfig();
+    std::ifstream config_file(config_path);
+    if (!config_file.is_open()) {
+        throw std::runtime_error("Failed to open config file: " + config_path);
+    }
+    const nlohmann::json config = nlohmann::json::parse(config_file);
+
+    // Меняются таймаут сессий, черный список и уровень лога; порты, потоки и размеры
+    // таблиц читаются только при запуске
+    const SessionManagerConfig session_config = sessionConfig(config);
+    m_session_manager->reload(session_config);
+    applyLogLevel(config);
+
+    const double reload_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - started).count();
+    m_log->sendToLog("Configuration reloaded from " + config_path);
+    return nlohmann::json{
+        {"session_timeout_ms", m_session_manager->getSessionTimeoutMs()},
+        {"blacklist", m_session_manager->getBlacklistStats()},
+        {"log_level", config.value("log_level", std::string("INFO"))},
+        {"reload_ms", reload_ms}
+    };
+}
+
+void Core::applyLogLevel(const nlohmann::json& config) {
+    // Построчные сообщения горячего пути пишутся только при DEBUG
+    const std::string log_level = config.value("log_level", std::string("INFO"));
+    m_log->setLevel(Logger::parseLevel(log_level));
+    std::string spdlog_level = log_level;
+    std::transform(spdlog_level.begin(), spdlog_level.end(), spdlog_level.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    spdlog::set_level(spdlog::level::from_str(spdlog_level));
+}
+
 void Core::loadConfig(const std::string& config_path) {
     std::ifstream config_file(config_path);
     if (!config_file.is_open()) {
@@ -72,35 +163,160 @@ void Core::loadConfig(const std::string& config_path) {
     }
     m_config = nlohmann::json::parse(config_file);
     spdlog::debug("Config loaded successfully");
+
+    applyLogLevel(m_config);
+
+    // Ядра и имена потоков по ролям; потоки применяют их при старте
+    if (m_config.contains("threads")) {
+        threadPlacement::configure(m_config["threads"]);
+        spdlog::info("Thread placement configured for {} role(s)", m_config["threads"].size());
+    }
+}
+
+SessionManagerConfig Core::sessionConfig(const nlohmann::json& config) {
+    SessionManagerConfig session_config;
+    session_config.session_timeout_sec = config["session_timeout_sec"].get<unsigned int>();
+    session_config.session_timeout_ms = config.value("session_timeout_ms", 0u);
+    session_config.cleanup_interval_ms = config.value("cleanup_interval_ms", 1000u);
+    session_config.timer_tick_ms = config.value("timer_tick_ms", session_config.timer_tick_ms);
+    session_config.graceful_shutdown_rate = config["graceful_shutdown_rate"].get<unsigned int>();
+    session_config.drain_rate = config.value("shutdown_drain_rate", session_config.drain_rate);
+    session_config.cdr_file = config["cdr_file"].get<std::string>();
+    session_config.blacklist = config.value("blacklist", std::vector<std::string>());
+    session_config.blacklist_file = config.value("blacklist_file", std::string());
+    session_config.shards = config.value("session_shards", session_config.shards);
+    session_config.max_sessions = config.value("max_sessions", session_config.max_sessions);
+    session_config.memory_limit_bytes = config.value("session_memory_limit_mb", uint64_t(0)) * 1024 * 1024;
+    session_config.capacity_policy = parseCapacityPolicy(config.value("session_limit_policy", std::string("reject")));
+    session_config.huge_pages = config.value("session_huge_pages", session_config.huge_pages);
+    session_config.snapshot_file = config.value("session_snapshot_file", std::string());
+    session_config.snapshot_interval_sec = config.value("session_snapshot_interval_sec",
+                                                        session_config.snapshot_interval_sec);
+    session_config.snapshot_load = config.value("session_snapshot_load", session_config.snapshot_load);
+    return session_config;
 }
 
 void Core::initSessionManager() {
     try {
         spdlog::debug("Initializing SessionManager...");
-        m_session_manager = std::make_shared<SessionManager>(
-            m_config["session_timeout_sec"].get<unsigned int>(),
-            m_config["graceful_shutdown_rate"].get<unsigned int>(),
-            m_config["cdr_file"].get<std::string>(),
-            m_config["blacklist"].get<std::vector<std::string>>(),
-            m_log
-        );
-        spdlog::info("SessionManager initialized successfully");
+        m_session_manager = std::make_shared<SessionManager>(sessionConfig(m_config), m_log);
+        const SessionStats session_stats = m_session_manager->getStats();
+        spdlog::info("SessionManager initialized successfully ({} shards, {} entries, {} KiB{})",
+                     session_stats.shards, session_stats.capacity, session_stats.memory_bytes / 1024,
+                     session_stats.huge_pages ? ", huge pages" : "");
+        spdlog::info("Session limits: sessions {}, memory {}, policy {}",
+                     session_stats.session_limit ? std::to_string(session_stats.session_limit) : "unlimited",
+                     session_stats.memory_limit_bytes
+                         ? std::to_string(session_stats.memory_limit_bytes / 1024) + " KiB" : "unlimited",
+                     session_stats.capacity_policy);
+        const BlacklistStats blacklist_stats = m_session_manager->getBlacklistStats();
+        spdlog::info("Blacklist loaded: {} IMSI ({} from file{}), {} prefix and {} range rule(s), "
+                     "{} KiB in memory, {} KiB mapped, {:.1f} ms",
+                     blacklist_stats.entries, blacklist_stats.file_entries,
+                     blacklist_stats.file.empty() ? "" : " " + blacklist_stats.file,
+                     blacklist_stats.prefix_rules, blacklist_stats.range_rules,
+                     blacklist_stats.memory_bytes / 1024, blacklist_stats.mapped_bytes / 1024,
+                     blacklist_stats.load_ms);
+        if (blacklist_stats.invalid_entries > 0) {
+            spdlog::warn("Blacklist: {} invalid entry(ies) skipped", blacklist_stats.invalid_entries);
+        }
     } catch (const std::exception& e) {
         spdlog::error("SessionManager initialization failed: {}", e.what());
         throw std::runtime_error("Cannot initialize SessionManager: " + std::string(e.what()));
     }
 }
 
+void Core::initReplication() {
+    try {
+        ReplicationConfig config;
+        config.role = parseReplicationRole(m_config.value("replication_role", std::string("off")));
+        if (config.role == ReplicationRole::Off) return;
+        config.ip = m_config.value("replication_ip", config.ip);
+        config.port = m_config.value("replication_port", config.port);
+        config.queue_size = m_config.value("replication_queue_size", config.queue_size);
+        config.batch_ms = m_config.value("replication_batch_ms", config.batch_ms);
+        config.refresh_ms = m_config.value("replication_refresh_ms", config.refresh_ms);
+        config.heartbeat_ms = m_config.value("replication_heartbeat_ms", config.heartbeat_ms);
+        config.reconnect_ms = m_config.value("replication_reconnect_ms", config.reconnect_ms);
+        m_replicator = std::make_unique<SessionReplicator>(config, m_session_manager);
+        spdlog::info("Replication initialized ({} {}:{}, queue {}, batch {} ms, refresh window {} ms)",
+                     config.role == ReplicationRole::Primary ? "primary on" : "standby of",
+                     config.ip, m_replicator->port(), config.queue_size, config.batch_ms, config.refresh_ms);
+    } catch (const std::exception& e) {
+        spdlog::error("Replication initialization failed: {}", e.what());
+        throw std::runtime_error("Cannot initialize replication: " + std::string(e.what()));
+    }
+}
+
 void Core::initUdpServer() {
     try {
         spdlog::debug("Initializing UDP server...");
-        m_udp_server = std::make_unique<UdpServer>(
-            m_config["udp_port"].get<uint16_t>(),
-            m_session_manager,
-            m_log
-        );
-        spdlog::info("UDP server initialized (port: {})", 
-                     m_config["udp_port"].get<uint16_t>());
+        UdpServerConfig defaults;
+        defaults.ip = m_config.value("udp_ip", std::string("0.0.0.0"));
+        defaults.port = m_config["udp_port"].get<uint16_t>();
+        defaults.batch_size = m_config.value("udp_batch_size", 1);
+        defaults.workers = m_config.value("udp_workers", 1);
+        defaults.engine = parseUdpEngine(m_config.value("udp_engine", std::string("blocking")));
+        defaults.processing_workers = m_config.value("processing_workers", 0);
+        defaults.processing_max_workers = m_config.value("processing_max_workers", 0);
+        defaults.processing_queue_size = m_config.value("processing_queue_size", 4096);
+        defaults.overload_target_us = m_config.value("overload_target_us", 0);
+        defaults.overload_interval_ms = m_config.value("overload_interval_ms", 100);
+        defaults.response_cache_size = m_config.value("response_cache_size", 0);
+        defaults.response_cache_window_ms = m_config.value("response_cache_window_ms", 2000);
+        defaults.kernel_stats = m_config.value("udp_kernel_stats", false);
+        defaults.rcvbuf_bytes = m_config.value("udp_rcvbuf_bytes", 0);
+        if (m_config.contains("threads") && m_config["threads"].contains("udp")) {
+            const auto& udp_threads = m_config["threads"]["udp"];
+            defaults.busy_poll_us = udp_threads.value("busy_poll_us", 0);
+            defaults.busy_poll_budget = udp_threads.value("busy_poll_budget", 0);
+        }
+
+        // Список адресов прослушивания; по умолчанию - udp_ip:udp_port
+        std::vector<UdpServerConfig> listeners;
+        if (m_config.contains("udp_listen")) {
+            for (const auto& entry : m_config["udp_listen"]) {
+                UdpServerConfig udp_config = defaults;
+                udp_config.ip = entry.value("ip", defaults.ip);
+                udp_config.port = entry.value("port", defaults.port);
+                udp_config.workers = entry.value("workers", defaults.workers);
+                listeners.push_back(udp_config);
+            }
+        }
+        if (listeners.empty()) listeners.push_back(defaults);
+
+        // В режиме epoll очистку сессий ведет timerfd первого цикла вместо отдельного потока
+        if (defaults.engine == UdpEngine::Epoll) {
+            listeners.front().cleanup_interval_ms = m_config.value("cleanup_interval_ms", 1000);
+            m_cleanup_in_event_loop = listeners.front().cleanup_interval_ms > 0;
+        }
+
+        // Лимит по адресу источника общий для всех адресов прослушивания
+        if (m_config.contains("rate_limit_rps")) {
+            RateLimiterConfig limiter_config;
+            limiter_config.rate = m_config["rate_limit_rps"].get<double>();
+            limiter_config.burst = m_config.value("rate_limit_burst", limiter_config.rate * 2);
+            limiter_config.table_size = m_config.value("rate_limit_table_size", limiter_config.table_size);
+            limiter_config.action = parseRateLimitAction(m_config.value("rate_limit_action", std::string("reject")));
+            m_rate_limiter = std::make_shared<RateLimiter>(limiter_config);
+            spdlog::info("Rate limit: {} rps per source, burst {}, table {} ({} KiB)",
+                         limiter_config.rate, limiter_config.burst,
+                         m_rate_limiter->getStats().table_size,
+                         m_rate_limiter->getStats().memory_bytes / 1024);
+        }
+
+        for (const auto& udp_config : listeners) {
+            m_udp_servers.push_back(std::make_unique<UdpServer>(
+                udp_config,
+                m_session_manager,
+                m_log
+            ));
+            m_udp_servers.back()->setRateLimiter(m_rate_limiter);
+            spdlog::info("UDP server initialized ({}:{}, workers: {}, batch: {}, processing workers: {})",
+                         udp_config.ip, udp_config.port,
+                         udp_config.workers, udp_config.batch_size,
+                         udp_config.processing_workers);
+        }
     } catch (const std::exception& e) {
         spdlog::error("UDP server initialization failed: {}", e.what());
         throw std::runtime_error("Cannot initialize UDP server: " + std::string(e.what()));
@@ -115,6 +331,70 @@ void Core::initHttpServer() {
             m_session_manager,
             m_log
         );
+        m_http_server->addMetricsSource("sessions", [this]() {
+            return nlohmann::json(m_session_manager->getStats());
+        });
+        m_http_server->addAdminCommand("reload", [this]() {
+            return reload();
+        });
+        m_http_server->addAdminCommand("snapshot", [this]() {
+            const size_t sessions = m_session_manager->saveSnapshot();
+            return nlohmann::json{{"sessions", sessions}, {"snapshot", m_session_manager->getSnapshotStats()}};
+        });
+        m_http_server->addMetricsSource("shutdown_drain", [this]() {
+            return nlohmann::json(m_session_manager->getDrainStats());
+        });
+        m_http_server->addMetricsSource("session_snapshot", [this]() {
+            return nlohmann::json(m_session_manager->getSnapshotStats());
+        });
+        if (m_replicator) {
+            m_http_server->addMetricsSource("replication", [this]() {
+                return nlohmann::json(m_replicator->getStats());
+            });
+        }
+        m_http_server->addMetricsSource("blacklist", [this]() {
+            return nlohmann::json(m_session_manager->getBlacklistStats());
+        });
+        m_http_server->addMetricsSource("udp_batch", [this]() {
+            nlohmann::json stats = nlohmann::json::object();
+            for (const auto& udp_server : m_udp_servers) {
+                stats[udp_server->getEndpoint()] = udp_server->getBatchStats();
+            }
+            return stats;
+        });
+        if (m_rate_limiter) {
+            m_http_server->addMetricsSource("rate_limit", [this]() {
+                return nlohmann::json(m_rate_limiter->getStats());
+            });
+        }
+        m_http_server->addMetricsSource("overload", [this]() {
+            nlohmann::json stats = nlohmann::json::object();
+            for (const auto& udp_server : m_udp_servers) {
+                stats[udp_server->getEndpoint()] = udp_server->getOverloadStats();
+            }
+            return stats;
+        });
+        m_http_server->addMetricsSource("response_cache", [this]() {
+            nlohmann::json stats = nlohmann::json::object();
+            for (const auto& udp_server : m_udp_servers) {
+                stats[udp_server->getEndpoint()] = udp_server->getResponseCacheStats();
+            }
+            return stats;
+        });
+        m_http_server->addMetricsSource("udp_kernel", [this]() {
+            nlohmann::json stats = nlohmann::json::object();
+            for (const auto& udp_server : m_udp_servers) {
+                stats[udp_server->getEndpoint()] = udp_server->getKernelRxStats();
+            }
+            return stats;
+        });
+        m_http_server->addMetricsSource("udp_queue", [this]() {
+            nlohmann::json stats = nlohmann::json::object();
+            for (const auto& udp_server : m_udp_servers) {
+                stats[udp_server->getEndpoint()] = udp_server->getQueueStats();
+            }
+            return stats;
+        });
         spdlog::info("HTTP server initialized (port: {})", 
                      m_config["http_port"].get<uint16_t>());
     } catch (const std::exception& e) {
@@ -3,15 +3,21 @@
 #ifndef CORE_H
 #define CORE_H
 
+#include <algorithm>
 #include <memory>
 #include <thread>
+#include <vector>
 #include <atomic>
+#include <mutex>
 #include <csignal>
 #include <nlohmann/json.hpp>
 #include "SessionManager.h"
+#include "SessionReplicator.h"
 #include "UdpServer.h"
 #include "HttpServer.h"
+#include "../Clock.h"
 #include "../ConfigDirPath.h"
+#include "../ThreadPlacement.h"
 
 class Core {
 
@@ -24,20 +30,41 @@ public:
     // Запуск всех серверов (UDP + HTTP)
     void start();
 
-    // Корректная остановка серверов
+    // Остановка приема запросов и начало выгрузки сессий; HTTP продолжает работать
     void stop();
 
+    // Дождаться окончания выгрузки сессий и остановить HTTP
+    void waitForShutdown();
+
     // Проверка состояния работы
     bool isRunning() const;
 
+    // Перечитать server.json: таймаут сессий, черный список, уровень лога.
+    // Исключение - настройки не изменились
+    nlohmann::json reload();
+
+    // Выполнить перезагрузку, запрошенную SIGHUP (вызывается из основного цикла)
+    void reloadIfRequested();
+
+    // Выполнить остановку, запрошенную SIGINT/SIGTERM (вызывается из основного цикла)
+    void stopIfRequested();
+
 private:
     // Загрузка конфигурации из JSON файла
     void loadConfig(const std::string& config_path);
 
+    // Настройки менеджера сессий из конфигурации
+    static SessionManagerConfig sessionConfig(const nlohmann::json& config);
+
+    void applyLogLevel(const nlohmann::json& config);
+
     // Инициализация менеджера сессий
     void initSessionManager();
 
-    // Инициализация UDP сервера
+    // Репликация сессий на резервный сервер или с основного (replication_role)
+    void initReplication();
+
+    // Инициализация UDP серверов (по одному на адрес прослушивания)
     void initUdpServer();
 
     // Инициализация HTTP сервера
@@ -45,10 +72,15 @@ private:
 
     std::shared_ptr<Logger> m_log;                      // Логгер системы
     std::atomic<bool> m_shutdown_flag;                  // Флаг завершения работы
+    bool m_cleanup_in_event_loop = false;               // Очистку сессий ведет таймер UDP цикла
+    bool m_clock_ticking = false;                       // Запущен тикер coarseClock
     nlohmann::json m_config;                            // Конфигурация системы
+    std::mutex m_reload_mutex;                          // Одна перезагрузка за раз
 
     std::shared_ptr<SessionManager> m_session_manager;  // Менеджер сессий
-    std::unique_ptr<UdpServer> m_udp_server;            // UDP сервер
+    std::unique_ptr<SessionReplicator> m_replicator;    // Репликация основной/резервный
+    std::shared_ptr<RateLimiter> m_rate_limiter;        // Лимит запросов по источнику
+    std::vector<std::unique_ptr<UdpServer>> m_udp_servers; // UDP серверы
     std::unique_ptr<HttpServer> m_http_server;          // HTTP сервер
 };
 
@@ -0,0 +1,118 @@
+//DigitTrie.cpp
+
+#include "DigitTrie.h"
+
+#include <stdexcept>
+#include <string>
+
+DigitTrie::DigitTrie() : m_nodes(1, Node{}) {}
+
+void DigitTrie::checkDigits(std::string_view digits) {
+    if (digits.empty() || digits.size() > kMaxDigits) {
+        throw std::invalid_argument("IMSI rule must have 1-15 digits: '" + std::string(digits) + "'");
+    }
+    for (char c : digits) {
+        if (c < '0' || c > '9') {
+            throw std::invalid_argument("IMSI rule must contain only digits: '" + std::string(digits) + "'");
+        }
+    }
+}
+
+size_t DigitTrie::descend(size_t node, size_t digit) {
+    const uint32_t child = m_nodes[node].children[digit];
+    if (child != 0 && !(child & kLeaf)) return child;
+    // Маска листа переходит в новый узел
+    Node fresh{};
+    fresh.lengths = child & kAnyLength;
+    const uint32_t index = uint32_t(m_nodes.size());
+    m_nodes.push_back(fresh);
+    m_nodes[node].children[digit] = index;
+    return index;
+}
+
+void DigitTrie::mark(std::string_view prefix, uint32_t lengths) {
+    if (prefix.empty()) {
+        m_nodes[0].lengths |= lengths;
+        return;
+    }
+    size_t node = 0;
+    for (size_t i = 0; i + 1 < prefix.size(); ++i) {
+        node = descend(node, size_t(prefix[i] - '0'));
+    }
+    uint32_t& child = m_nodes[node].children[size_t(prefix.back() - '0')];
+    if (child == 0 || (child & kLeaf)) {
+        child |= kLeaf | lengths;
+    } else {
+        m_nodes[child].lengths |= lengths;
+    }
+}
+
+void DigitTrie::addPrefix(std::string_view prefix) {
+    checkDigits(prefix);
+    mark(prefix, kAnyLength);
+    ++m_rules;
+}
+
+void DigitTrie::addRange(std::string_view first, std::string_view last) {
+    checkDigits(first);
+    checkDigits(last);
+    if (first.size() != last.size()) {
+        throw std::invalid_argument("IMSI range bounds must have equal length: '" +
+                                    std::string(first) + "-" + std::string(last) + "'");
+    }
+    // Строки одной длины из цифр сравниваются как числа
+    if (first > last) {
+        throw std::invalid_argument("IMSI range is reversed: '" +
+                                    std::string(first) + "-" + std::string(last) + "'");
+    }
+    std::string prefix;
+    prefix.reserve(first.size());
+    coverRange(prefix, first, last, uint32_t(1) << first.size());
+    ++m_rules;
+}
+
+void DigitTrie::coverRange(std::string& prefix, std::string_view first, std::string_view last, uint32_t length_bit) {
+    // Хвосты 0..0 - 9..9: весь префикс (остаток длины задает бит length_bit)
+    if (first.find_first_not_of('0') == std::string_view::npos &&
+        last.find_first_not_of('9') == std::string_view::npos) {
+        mark(prefix, length_bit);
+        return;
+    }
+    const char low = first[0];
+    const char high = last[0];
+    if (low == high) {
+        prefix.push_back(low);
+        coverRange(prefix, first.substr(1), last.substr(1), length_bit);
+        prefix.pop_back();
+        return;
+    }
+    // Левый край, целые цифры между краями, правый край: не больше 2*9 префиксов на разряд
+    const std::string zeros(first.size() - 1, '0');
+    const std::string nines(first.size() - 1, '9');
+    prefix.push_back(low);
+    coverRange(prefix, first.substr(1), nines, length_bit);
+    prefix.pop_back();
+    for (char digit = char(low + 1); digit < high; ++digit) {
+        prefix.push_back(digit);
+        mark(prefix, length_bit);
+        prefix.pop_back();
+    }
+    prefix.push_back(high);
+    coverRange(prefix, zeros, last.substr(1), length_bit);
+    prefix.pop_back();
+}
+
+bool DigitTrie::matches(std::string_view digits) const {
+    if (digits.size() > kMaxDigits) return false;
+    const uint32_t length_bit = uint32_t(1) << digits.size();
+    size_t node = 0;
+    for (char c : digits) {
+        if (m_nodes[node].lengths & length_bit) return true;
+        const uint32_t child = m_nodes[node].children[size_t(c - '0')];
+        // За листом правил нет: ответ - его маска
+        if (child & kLeaf) return (child & length_bit) != 0;
+        if (child == 0) return false;
+        node = child;
+    }
+    return (m_nodes[node].lengths & length_bit) != 0;
+}
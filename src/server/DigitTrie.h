@@ -0,0 +1,69 @@
+//DigitTrie.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Правила черного списка по префиксу и диапазону IMSI в плоском 10-ичном дереве цифр.
+// Узел хранит индексы детей и маску длин IMSI, для которых совпадение на этом узле -
+// запрет: префикс запрещает любую длину, диапазон раскладывается на префиксы своей длины.
+// Лист без детей не занимает узла: ссылка на него (kLeaf | маска длин) хранит ответ.
+// Проверка - не больше kMaxDigits шагов без выделения памяти при любом числе правил.
+class DigitTrie {
+
+public:
+
+    static constexpr size_t kMaxDigits = 15;
+
+    DigitTrie();
+
+    // Все IMSI, начинающиеся с prefix (включая сам prefix)
+    void addPrefix(std::string_view prefix);
+
+    // IMSI длины first.size() от first до last включительно; std::invalid_argument при ошибке
+    void addRange(std::string_view first, std::string_view last);
+
+    // digits - только цифры, не длиннее kMaxDigits
+    bool matches(std::string_view digits) const;
+
+    bool empty() const { return m_rules == 0; }
+
+    size_t rules() const { return m_rules; }
+
+    size_t nodes() const { return m_nodes.size(); }
+
+    // Вернуть запас памяти после загрузки правил
+    void shrink() { m_nodes.shrink_to_fit(); }
+
+    size_t memoryBytes() const { return m_nodes.capacity() * sizeof(Node); }
+
+private:
+
+    // 0 - ребенка нет (корень ничьим ребенком не бывает), kLeaf - лист
+    struct Node {
+        uint32_t children[10];
+        uint32_t lengths;           // Бит L - запрещены IMSI длины L, проходящие через узел
+    };
+
+    static constexpr uint32_t kAnyLength = (uint32_t(1) << (kMaxDigits + 1)) - 1;
+
+    static constexpr uint32_t kLeaf = uint32_t(1) << 31;
+
+    // Позиция prefix (узлы создаются по пути) помечается маской lengths
+    void mark(std::string_view prefix, uint32_t lengths);
+
+    // Ребенок digit как узел: отсутствующий или лист превращается в узел
+    size_t descend(size_t node, size_t digit);
+
+    // Префиксы, покрывающие [first, last] при общем начале prefix
+    void coverRange(std::string& prefix, std::string_view first, std::string_view last, uint32_t length_bit);
+
+    static void checkDigits(std::string_view digits);
+
+    std::vector<Node> m_nodes;
+
+    size_t m_rules = 0;
+};
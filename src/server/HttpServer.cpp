@@ -23,6 +23,7 @@ void HttpServer::start() {
     
     m_running = true;
     m_http_server_thread = std::thread([this]() {
+        threadPlacement::apply("http");
         try {
             setupRoutes();
             m_log->sendToLog("HTTP server starting on port: " + std::to_string(m_port));
@@ -57,6 +58,16 @@ void HttpServer::stop() {
     }
 }
 
+void HttpServer::addMetricsSource(const std::string& name, MetricsProvider provider) {
+    std::lock_guard<std::mutex> lock(m_metrics_mutex);
+    m_metrics[name] = std::move(provider);
+}
+
+void HttpServer::addAdminCommand(const std::string& name, AdminCommand command) {
+    std::lock_guard<std::mutex> lock(m_metrics_mutex);
+    m_admin[name] = std::move(command);
+}
+
 void HttpServer::setupRoutes() {
     m_log->sendToLog("Setting up HTTP routes for port: " + std::to_string(m_port));
 
@@ -84,6 +95,48 @@ void HttpServer::setupRoutes() {
         }
     });
 
+    m_server->Get("/metrics", [this](const httplib::Request&, httplib::Response& res) {
+        nlohmann::json body = nlohmann::json::object();
+        try {
+            std::lock_guard<std::mutex> lock(m_metrics_mutex);
+            for (const auto& [name, provider] : m_metrics) {
+                body[name] = provider();
+            }
+        } catch (const std::exception& e) {
+            m_log->sendToLog("HTTP 500: Error collecting metrics: " + std::string(e.what()));
+            res.status = 500;
+            res.set_content("Internal server error", "text/plain");
+            return;
+        }
+        res.status = 200;
+        res.set_content(body.dump(), "application/json");
+    });
+
+    m_server->Post(R"(/admin/(\w+))", [this](const httplib::Request& req, httplib::Response& res) {
+        const std::string name = req.matches[1];
+        AdminCommand command;
+        {
+            std::lock_guard<std::mutex> lock(m_metrics_mutex);
+            const auto it = m_admin.find(name);
+            if (it != m_admin.end()) command = it->second;
+        }
+        if (!command) {
+            res.status = 404;
+            res.set_content("Unknown admin command: " + name, "text/plain");
+            return;
+        }
+        m_log->sendToLog("HTTP: admin command " + name);
+        try {
+            // Команда выполняется в потоке HTTP, вне горячего пути UDP
+            res.status = 200;
+            res.set_content(command().dump(), "application/json");
+        } catch (const std::exception& e) {
+            m_log->sendToLog("HTTP 500: admin command " + name + " failed: " + e.what());
+            res.status = 500;
+            res.set_content(nlohmann::json{{"error", e.what()}}.dump(), "application/json");
+        }
+    });
+
     m_server->Get("/stop", [this](const httplib::Request&, httplib::Response& res) {
         m_log->sendToLog("HTTP: Received shutdown command");
         spdlog::info("HTTP: Received stop command");
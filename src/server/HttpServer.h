@@ -6,13 +6,21 @@
 #include <memory>
 #include <string>
 #include <cstdint>
+#include <functional>
+#include <map>
 #include <httplib.h>
+#include <nlohmann/json.hpp>
 #include "SessionManager.h"
 
 class HttpServer {
 
 public:
 
+    using MetricsProvider = std::function<nlohmann::json()>;
+
+    // Команда администратора: результат в JSON, исключение - ошибка 500
+    using AdminCommand = std::function<nlohmann::json()>;
+
     HttpServer(const uint16_t& port,
                std::shared_ptr<ISessionManager> session_manager,
                std::shared_ptr<Logger> log);
@@ -25,6 +33,12 @@ public:
     // Остановка сервера
     void stop();
 
+    // Регистрация источника метрик, отдаваемых по /metrics
+    void addMetricsSource(const std::string& name, MetricsProvider provider);
+
+    // Регистрация команды, выполняемой по POST /admin/<name>
+    void addAdminCommand(const std::string& name, AdminCommand command);
+
 private:
     // Настройка маршрутов сервера
     void setupRoutes();
@@ -37,6 +51,10 @@ private:
     std::shared_ptr<ISessionManager> m_session_manager; // Менеджер сессий
     std::shared_ptr<Logger> m_log;                      // Логгер
     std::unique_ptr<httplib::Server> m_server;          // Экземпляр сервера httplib
+
+    std::mutex m_metrics_mutex;
+    std::map<std::string, MetricsProvider> m_metrics;   // Источники метрик
+    std::map<std::string, AdminCommand> m_admin;        // Команды /admin/<name> (под m_metrics_mutex)
 };
 
 #endif // HTTPSERVER_H
\ No newline at end of file
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <mutex>
 #include <chrono>
@@ -14,6 +15,31 @@
 #include <spdlog/spdlog.h>
 #include "../Logger.h"
 
+// Результат обработки запроса UE
+enum class SessionResult : uint8_t {
+    Created,
+    Exists,
+    Rejected,
+    ShuttingDown,
+    RateLimited,    // Отказ до обращения к менеджеру сессий (лимит источника)
+    Overloaded,     // Создание сессии отложено из-за перегрузки
+    CapacityExceeded // Достигнут предел числа сессий или памяти (политика Reject)
+};
+
+// Фиксированный ответ клиенту (строки со статическим временем жизни)
+constexpr std::string_view toResponse(SessionResult result) {
+    switch (result) {
+        case SessionResult::Created:      return "created";
+        case SessionResult::Exists:       return "exists";
+        case SessionResult::ShuttingDown: return "rejected (server shutting down)";
+        case SessionResult::RateLimited:  return "rejected (rate limited)";
+        case SessionResult::Overloaded:   return "rejected (overload)";
+        case SessionResult::CapacityExceeded: return "rejected (capacity)";
+        case SessionResult::Rejected:     break;
+    }
+    return "rejected";
+}
+
 class ISessionManager {
 
 public:
@@ -22,8 +48,21 @@ public:
 
     virtual std::string handleImsi(const std::string& imsi) = 0;
 
+    // Горячий путь: без выделения памяти для создания/обновления сессии
+    virtual SessionResult handleImsi(std::string_view raw_imsi) = 0;
+
+    // Только продление существующей сессии; false - сессии нет (новая не создается)
+    virtual bool refreshSession(std::string_view raw_imsi) = 0;
+
+    // Строковые литералы иначе неоднозначны между std::string и std::string_view
+    std::string handleImsi(const char* raw_imsi) { return handleImsi(std::string(raw_imsi)); }
+
     virtual bool isSessionActive(const std::string& imsi) const = 0;
 
+    virtual bool isSessionActive(std::string_view imsi) const = 0;
+
+    bool isSessionActive(const char* imsi) const { return isSessionActive(std::string_view(imsi)); }
+
     virtual void startCleanupTimer() = 0;
 
     virtual void stopCleanupTimer() = 0;
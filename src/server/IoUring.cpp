@@ -0,0 +1,173 @@
+//IoUring.cpp
+
+#include "IoUring.h"
+
+#ifdef PGW_HAVE_IO_URING
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+    int sysSetup(unsigned entries, io_uring_params* params) {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int sysEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+                                        flags, nullptr, 0));
+    }
+
+    int sysRegister(int fd, unsigned opcode, void* arg, unsigned nr_args) {
+        return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+    }
+
+}
+
+IoUring::~IoUring() {
+    if (m_ring_fd >= 0) close(m_ring_fd);
+    unmapAll();
+}
+
+bool IoUring::init(unsigned entries, std::string& error) {
+    io_uring_params params{};
+    m_ring_fd = sysSetup(entries, &params);
+    if (m_ring_fd < 0) {
+        error = "io_uring_setup: " + std::string(std::strerror(errno));
+        return false;
+    }
+
+    m_sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        m_sq_size = m_cq_size = std::max(m_sq_size, m_cq_size);
+    }
+
+    m_sq_ptr = mmap(nullptr, m_sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    m_ring_fd, IORING_OFF_SQ_RING);
+    if (m_sq_ptr == MAP_FAILED) {
+        m_sq_ptr = nullptr;
+        error = "mmap SQ ring: " + std::string(std::strerror(errno));
+        return false;
+    }
+    if (single_mmap) {
+        m_cq_ptr = m_sq_ptr;
+    } else {
+        m_cq_ptr = mmap(nullptr, m_cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        m_ring_fd, IORING_OFF_CQ_RING);
+        if (m_cq_ptr == MAP_FAILED) {
+            m_cq_ptr = nullptr;
+            error = "mmap CQ ring: " + std::string(std::strerror(errno));
+            return false;
+        }
+    }
+
+    m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      m_ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        error = "mmap SQEs: " + std::string(std::strerror(errno));
+        return false;
+    }
+    m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+    auto* sq = static_cast<char*>(m_sq_ptr);
+    m_sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    m_sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    m_sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    m_sq_entries = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+    m_sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    m_sq_local_tail = *m_sq_tail;
+
+    auto* cq = static_cast<char*>(m_cq_ptr);
+    m_cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    m_cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    m_cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+}
+
+bool IoUring::registerBufferRing(uint16_t group, char* base, unsigned count,
+                                 unsigned buffer_size, std::string& error) {
+    m_buf_ring_size = count * sizeof(io_uring_buf);
+    void* ring = mmap(nullptr, m_buf_ring_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) {
+        error = "mmap buffer ring: " + std::string(std::strerror(errno));
+        return false;
+    }
+    m_buf_ring = static_cast<io_uring_buf_ring*>(ring);
+
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(m_buf_ring);
+    reg.ring_entries = count;
+    reg.bgid = group;
+    if (sysRegister(m_ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        error = "register buffer ring: " + std::string(std::strerror(errno));
+        return false;
+    }
+
+    m_buf_base = base;
+    m_buf_size = buffer_size;
+    m_buf_mask = count - 1;
+    m_buf_group = group;
+    m_buf_local_tail = 0;
+    for (unsigned bid = 0; bid < count; ++bid) {
+        recycleBuffer(static_cast<uint16_t>(bid));
+    }
+    publishBuffers();
+    return true;
+}
+
+void IoUring::recycleBuffer(uint16_t bid) {
+    // Не через bufs[]: в C++ __DECLARE_FLEX_ARRAY смещает массив на 8 байт
+    io_uring_buf& buf = reinterpret_cast<io_uring_buf*>(m_buf_ring)[m_buf_local_tail & m_buf_mask];
+    buf.addr = reinterpret_cast<uint64_t>(m_buf_base + size_t(bid) * m_buf_size);
+    buf.len = m_buf_size;
+    buf.bid = bid;
+    ++m_buf_local_tail;
+}
+
+void IoUring::publishBuffers() {
+    __atomic_store_n(&m_buf_ring->tail, m_buf_local_tail, __ATOMIC_RELEASE);
+}
+
+io_uring_sqe* IoUring::getSqe() {
+    const unsigned head = __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE);
+    if (m_sq_local_tail - head >= m_sq_entries) return nullptr;
+    const unsigned index = m_sq_local_tail & m_sq_mask;
+    m_sq_array[index] = index;
+    ++m_sq_local_tail;
+    ++m_to_submit;
+    io_uring_sqe* sqe = &m_sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+int IoUring::submit(unsigned wait_nr) {
+    __atomic_store_n(m_sq_tail, m_sq_local_tail, __ATOMIC_RELEASE);
+    const unsigned flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+    int submitted = sysEnter(m_ring_fd, m_to_submit, wait_nr, flags);
+    if (submitted >= 0) {
+        m_to_submit -= static_cast<unsigned>(submitted);
+    }
+    return submitted;
+}
+
+void IoUring::unmapAll() noexcept {
+    if (m_buf_ring) munmap(m_buf_ring, m_buf_ring_size);
+    if (m_sqes) munmap(m_sqes, m_sqes_size);
+    if (m_cq_ptr && m_cq_ptr != m_sq_ptr) munmap(m_cq_ptr, m_cq_size);
+    if (m_sq_ptr) munmap(m_sq_ptr, m_sq_size);
+    m_buf_ring = nullptr;
+    m_sqes = nullptr;
+    m_cq_ptr = nullptr;
+    m_sq_ptr = nullptr;
+}
+
+#endif // PGW_HAVE_IO_URING
\ No newline at end of file
@@ -0,0 +1,103 @@
+//IoUring.h
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#if defined(IORING_RECV_MULTISHOT)
+#define PGW_HAVE_IO_URING 1
+#endif
+#endif
+
+#ifdef PGW_HAVE_IO_URING
+
+// Минимальная обертка над io_uring на системных вызовах (без liburing).
+// Кольцо принадлежит одному потоку, внутренней синхронизации нет.
+class IoUring {
+
+public:
+
+    IoUring() = default;
+
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+
+    IoUring& operator=(const IoUring&) = delete;
+
+    // Создание кольца; false - ядро не поддерживает io_uring или запретило его
+    bool init(unsigned entries, std::string& error);
+
+    // Регистрация кольца предоставленных буферов (count - степень двойки)
+    bool registerBufferRing(uint16_t group, char* base, unsigned count,
+                            unsigned buffer_size, std::string& error);
+
+    // Вернуть буфер ядру (публикуется вызовом publishBuffers)
+    void recycleBuffer(uint16_t bid);
+
+    void publishBuffers();
+
+    // Свободный SQE или nullptr, если очередь отправки заполнена
+    io_uring_sqe* getSqe();
+
+    // Отправить накопленные SQE и дождаться wait_nr завершений
+    int submit(unsigned wait_nr);
+
+    // Обработать все готовые CQE, возвращает их количество
+    template <typename Handler>
+    unsigned reap(Handler&& handler) {
+        unsigned head = *m_cq_head;
+        const unsigned tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+        unsigned count = 0;
+        while (head != tail) {
+            handler(m_cqes[head & m_cq_mask]);
+            ++head;
+            ++count;
+        }
+        __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+        return count;
+    }
+
+private:
+
+    void unmapAll() noexcept;
+
+    int m_ring_fd = -1;
+
+    // Очередь отправки
+    void* m_sq_ptr = nullptr;
+    size_t m_sq_size = 0;
+    unsigned* m_sq_head = nullptr;
+    unsigned* m_sq_tail = nullptr;
+    unsigned* m_sq_array = nullptr;
+    unsigned m_sq_mask = 0;
+    unsigned m_sq_entries = 0;
+    unsigned m_sq_local_tail = 0;
+    unsigned m_to_submit = 0;
+    io_uring_sqe* m_sqes = nullptr;
+    size_t m_sqes_size = 0;
+
+    // Очередь завершений
+    void* m_cq_ptr = nullptr;
+    size_t m_cq_size = 0;
+    unsigned* m_cq_head = nullptr;
+    unsigned* m_cq_tail = nullptr;
+    unsigned m_cq_mask = 0;
+    io_uring_cqe* m_cqes = nullptr;
+
+    // Кольцо предоставленных буферов
+    io_uring_buf_ring* m_buf_ring = nullptr;
+    size_t m_buf_ring_size = 0;
+    char* m_buf_base = nullptr;
+    unsigned m_buf_size = 0;
+    unsigned m_buf_mask = 0;
+    uint16_t m_buf_group = 0;
+    uint16_t m_buf_local_tail = 0;
+};
+
+#endif // PGW_HAVE_IO_URING
\ No newline at end of file
@@ -0,0 +1,66 @@
+//KernelRxStats.cpp
+
+#include "KernelRxStats.h"
+
+#include <algorithm>
+
+void to_json(nlohmann::json& j, const KernelRxStats& stats) {
+    // Верхние границы корзин; последняя корзина не ограничена
+    nlohmann::json histogram = nlohmann::json::array();
+    for (size_t i = 0; i < stats.delay_histogram.size(); ++i) {
+        nlohmann::json bucket = {{"count", stats.delay_histogram[i]}};
+        if (i + 1 < stats.delay_histogram.size()) {
+            bucket["lt_us"] = uint64_t(1) << i;
+        } else {
+            bucket["lt_us"] = "inf";
+        }
+        histogram.push_back(bucket);
+    }
+    j = nlohmann::json{
+        {"sockets", stats.sockets},
+        {"drops", stats.drops},
+        {"rcvbuf_bytes", stats.rcvbuf_bytes},
+        {"datagrams", stats.datagrams},
+        {"delay_avg_us", stats.datagrams ? double(stats.delay_sum_us) / stats.datagrams : 0.0},
+        {"delay_max_us", stats.delay_max_us},
+        {"delay_histogram", histogram}
+    };
+}
+
+size_t KernelRxCounters::delayBucket(uint64_t delay_us) {
+    size_t bucket = 0;
+    while (delay_us > 0 && bucket + 1 < KernelRxStats::kDelayBuckets) {
+        delay_us >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+void KernelRxCounters::recordDrops(uint32_t counter) {
+    // Разность по модулю 2^32: счетчик ядра может переполниться
+    const uint32_t delta = counter - m_last_counter;
+    m_last_counter = counter;
+    if (delta > 0) increment(m_drops, delta);
+}
+
+void KernelRxCounters::recordDelay(int64_t delay_ns) {
+    // Часы могли сдвинуться назад - считаем такую задержку нулевой
+    const uint64_t delay_us = delay_ns > 0 ? uint64_t(delay_ns) / 1000 : 0;
+    increment(m_datagrams);
+    increment(m_delay_sum_us, delay_us);
+    increment(m_delay_histogram[delayBucket(delay_us)]);
+    if (delay_us > m_delay_max_us.load(std::memory_order_relaxed)) {
+        m_delay_max_us.store(delay_us, std::memory_order_relaxed);
+    }
+}
+
+void KernelRxCounters::addTo(KernelRxStats& stats) const {
+    ++stats.sockets;
+    stats.drops += m_drops.load(std::memory_order_relaxed);
+    stats.datagrams += m_datagrams.load(std::memory_order_relaxed);
+    stats.delay_sum_us += m_delay_sum_us.load(std::memory_order_relaxed);
+    stats.delay_max_us = std::max(stats.delay_max_us, m_delay_max_us.load(std::memory_order_relaxed));
+    for (size_t i = 0; i < stats.delay_histogram.size(); ++i) {
+        stats.delay_histogram[i] += m_delay_histogram[i].load(std::memory_order_relaxed);
+    }
+}
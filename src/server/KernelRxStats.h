@@ -0,0 +1,56 @@
+//KernelRxStats.h
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+// Потери и задержки датаграмм в ядре до recvmsg (сумма по сокетам)
+struct KernelRxStats {
+    // Корзины задержки по степеням двойки микросекунд: [0,1), [1,2), [2,4) ... и все, что дольше
+    static constexpr size_t kDelayBuckets = 22;
+
+    uint64_t sockets = 0;
+    uint64_t drops = 0;                 // Отброшено ядром: буфер приема сокета был полон (SO_RXQ_OVFL)
+    uint64_t rcvbuf_bytes = 0;          // Фактический SO_RCVBUF (ядро удваивает запрошенный)
+    uint64_t datagrams = 0;             // Датаграмм с меткой времени ядра
+    uint64_t delay_sum_us = 0;
+    uint64_t delay_max_us = 0;
+    std::array<uint64_t, kDelayBuckets> delay_histogram{};
+};
+
+void to_json(nlohmann::json& j, const KernelRxStats& stats);
+
+// Счетчики одного сокета. Пишет только поток приема этого сокета,
+// поэтому обновления - load/store без атомарных read-modify-write.
+class alignas(64) KernelRxCounters {
+
+public:
+
+    // Накопительный счетчик потерь сокета из SO_RXQ_OVFL (приходит, только когда он не 0)
+    void recordDrops(uint32_t counter);
+
+    // Задержка от прихода в ядро (SO_TIMESTAMPNS) до recvmsg
+    void recordDelay(int64_t delay_ns);
+
+    // Добавить значения к сумме по сокетам
+    void addTo(KernelRxStats& stats) const;
+
+    static size_t delayBucket(uint64_t delay_us);
+
+private:
+
+    static void increment(std::atomic<uint64_t>& counter, uint64_t value = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    uint32_t m_last_counter = 0;
+
+    std::atomic<uint64_t> m_drops{0};
+    std::atomic<uint64_t> m_datagrams{0};
+    std::atomic<uint64_t> m_delay_sum_us{0};
+    std::atomic<uint64_t> m_delay_max_us{0};
+    std::array<std::atomic<uint64_t>, KernelRxStats::kDelayBuckets> m_delay_histogram{};
+};
@@ -0,0 +1,61 @@
+//OverloadController.cpp
+
+#include "OverloadController.h"
+
+void to_json(nlohmann::json& j, const OverloadStats& stats) {
+    j = nlohmann::json{
+        {"overloaded", stats.overloaded},
+        {"episodes", stats.episodes},
+        {"shed", stats.shed},
+        {"refreshes", stats.refreshes},
+        {"last_sojourn_us", stats.last_sojourn_us},
+        {"max_sojourn_us", stats.max_sojourn_us}
+    };
+}
+
+OverloadController::OverloadController(const OverloadConfig& config)
+: m_target_ns(int64_t(config.target_us) * 1000),
+  m_interval_ns(int64_t(config.interval_ms) * 1000000) {}
+
+bool OverloadController::observe(int64_t arrival_ns, int64_t now_ns) {
+    // Часы реального времени могут сдвинуться назад - отрицательную задержку не считаем
+    const int64_t sojourn_ns = now_ns > arrival_ns ? now_ns - arrival_ns : 0;
+    const uint64_t sojourn_us = static_cast<uint64_t>(sojourn_ns / 1000);
+    m_last_sojourn_us.store(sojourn_us, std::memory_order_relaxed);
+    uint64_t max = m_max_sojourn_us.load(std::memory_order_relaxed);
+    while (sojourn_us > max &&
+           !m_max_sojourn_us.compare_exchange_weak(max, sojourn_us, std::memory_order_relaxed)) {}
+
+    if (sojourn_ns < m_target_ns) {
+        // Очередь разошлась
+        m_first_above_ns.store(0, std::memory_order_relaxed);
+        if (m_overloaded.load(std::memory_order_relaxed)) {
+            m_overloaded.store(false, std::memory_order_relaxed);
+        }
+        return false;
+    }
+
+    int64_t first_above = m_first_above_ns.load(std::memory_order_relaxed);
+    if (first_above == 0) {
+        m_first_above_ns.compare_exchange_strong(first_above, now_ns + m_interval_ns,
+                                                 std::memory_order_relaxed);
+        return m_overloaded.load(std::memory_order_relaxed);
+    }
+    if (now_ns >= first_above && !m_overloaded.load(std::memory_order_relaxed)) {
+        if (!m_overloaded.exchange(true, std::memory_order_relaxed)) {
+            m_episodes.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    return m_overloaded.load(std::memory_order_relaxed);
+}
+
+OverloadStats OverloadController::getStats() const {
+    OverloadStats stats;
+    stats.overloaded = m_overloaded.load(std::memory_order_relaxed);
+    stats.episodes = m_episodes.load(std::memory_order_relaxed);
+    stats.shed = m_shed.load(std::memory_order_relaxed);
+    stats.refreshes = m_refreshes.load(std::memory_order_relaxed);
+    stats.last_sojourn_us = m_last_sojourn_us.load(std::memory_order_relaxed);
+    stats.max_sojourn_us = m_max_sojourn_us.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,62 @@
+//OverloadController.h
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+// Настройки контроля перегрузки по задержке в очереди
+struct OverloadConfig {
+    uint32_t target_us = 5000;          // Допустимая задержка датаграммы до обработки
+    uint32_t interval_ms = 100;         // Сколько задержка должна держаться выше цели
+};
+
+struct OverloadStats {
+    bool overloaded = false;            // Сейчас создание сессий отклоняется
+    uint64_t episodes = 0;              // Сколько раз входили в перегрузку
+    uint64_t shed = 0;                  // Отклонено созданий сессий
+    uint64_t refreshes = 0;             // Продлено сессий во время перегрузки
+    uint64_t last_sojourn_us = 0;       // Задержка последней датаграммы
+    uint64_t max_sojourn_us = 0;        // Максимальная задержка с запуска
+};
+
+void to_json(nlohmann::json& j, const OverloadStats& stats);
+
+// Детектор перегрузки в духе CoDel: короткие всплески очередь поглощает,
+// а задержка выше target_us на протяжении interval_ms означает стоячую очередь.
+// Выход из перегрузки - по первой датаграмме с задержкой ниже цели.
+// Без блокировок: вызывается из всех потоков обработки, гонки между ними безвредны.
+class OverloadController {
+
+public:
+
+    explicit OverloadController(const OverloadConfig& config);
+
+    // Учесть датаграмму: arrival_ns - время прихода в ядро, now_ns - начало обработки
+    // (CLOCK_REALTIME, как у SO_TIMESTAMPNS). true - создание новых сессий отклонять
+    bool observe(int64_t arrival_ns, int64_t now_ns);
+
+    void recordShed() { m_shed.fetch_add(1, std::memory_order_relaxed); }
+
+    void recordRefresh() { m_refreshes.fetch_add(1, std::memory_order_relaxed); }
+
+    OverloadStats getStats() const;
+
+private:
+
+    int64_t m_target_ns;
+
+    int64_t m_interval_ns;
+
+    // Когда задержка впервые превысила цель плюс интервал; 0 - задержка в норме
+    std::atomic<int64_t> m_first_above_ns{0};
+
+    std::atomic<bool> m_overloaded{false};
+
+    std::atomic<uint64_t> m_episodes{0};
+    std::atomic<uint64_t> m_shed{0};
+    std::atomic<uint64_t> m_refreshes{0};
+    std::atomic<uint64_t> m_last_sojourn_us{0};
+    std::atomic<uint64_t> m_max_sojourn_us{0};
+};
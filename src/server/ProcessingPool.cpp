@@ -0,0 +1,204 @@
+//ProcessingPool.cpp
+
+#include "ProcessingPool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sys/socket.h>
+
+namespace {
+
+    // Очередь длиннее этого на каждый активный поток - добавляем поток
+    constexpr size_t kGrowDepthPerWorker = 32;
+
+    // Пустая очередь столько интервалов подряд - убираем поток
+    constexpr uint32_t kShrinkIdleIntervals = 10;
+
+    // Попыток забрать запрос перед засыпанием
+    constexpr unsigned kSpinLimit = 64;
+
+}
+
+void to_json(nlohmann::json& j, const QueueStats& stats) {
+    j = nlohmann::json{
+        {"capacity", stats.capacity},
+        {"depth", stats.depth},
+        {"peak_depth", stats.peak_depth},
+        {"active_workers", stats.active_workers},
+        {"max_workers", stats.max_workers},
+        {"enqueued", stats.enqueued},
+        {"processed", stats.processed},
+        {"dropped", stats.dropped}
+    };
+}
+
+ProcessingPool::ProcessingPool(const ProcessingPoolConfig& config,
+                               Handler handler,
+                               std::shared_ptr<Logger> log)
+: m_config(config), m_handler(std::move(handler)), m_log(log),
+  m_queue(config.queue_capacity) {
+    if (m_config.min_workers == 0) m_config.min_workers = 1;
+    if (m_config.max_workers < m_config.min_workers) m_config.max_workers = m_config.min_workers;
+    if (m_config.scale_interval_ms == 0) m_config.scale_interval_ms = 1;
+}
+
+ProcessingPool::~ProcessingPool() {
+    stop();
+}
+
+void ProcessingPool::start() {
+    if (m_running) return;
+
+    m_running = true;
+    m_active_workers = m_config.min_workers;
+    m_last_adjust = std::chrono::steady_clock::now();
+    m_idle_intervals = 0;
+    for (size_t i = 0; i < m_config.max_workers; ++i) {
+        m_threads.emplace_back(&ProcessingPool::workerLoop, this, i);
+    }
+    m_log->sendToLog("Processing pool started: " + std::to_string(m_config.min_workers) + ".." +
+                     std::to_string(m_config.max_workers) + " worker(s), queue " +
+                     std::to_string(m_queue.capacity()));
+}
+
+void ProcessingPool::stop() {
+    if (!m_running) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_wait_mutex);
+        m_running = false;
+    }
+    m_wait_cv.notify_all();
+    for (auto& thread : m_threads) {
+        if (thread.joinable()) thread.join();
+    }
+    m_threads.clear();
+}
+
+bool ProcessingPool::submit(int sockfd, const sockaddr_in& addr, const char* data, size_t len,
+                            int64_t arrival_ns) {
+    if (len > kMaxRequestSize) return false;
+
+    Request request;
+    request.sockfd = sockfd;
+    request.addr = addr;
+    request.arrival_ns = arrival_ns;
+    request.len = static_cast<uint16_t>(len);
+    std::memcpy(request.data.data(), data, len);
+    if (!m_queue.tryPush(request)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    m_enqueued.fetch_add(1, std::memory_order_relaxed);
+
+    const uint64_t depth = m_queue.sizeApprox();
+    uint64_t peak = m_peak_depth.load(std::memory_order_relaxed);
+    while (depth > peak && !m_peak_depth.compare_exchange_weak(peak, depth, std::memory_order_relaxed)) {}
+
+    // Будим поток, только если кто-то заснул (иначе без системных вызовов)
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_idle_workers.load(std::memory_order_relaxed) > 0) {
+        { std::lock_guard<std::mutex> lock(m_wait_mutex); }
+        m_wait_cv.notify_one();
+    }
+    return true;
+}
+
+QueueStats ProcessingPool::getStats() const {
+    QueueStats stats;
+    stats.capacity = m_queue.capacity();
+    stats.depth = m_queue.sizeApprox();
+    stats.peak_depth = m_peak_depth.load(std::memory_order_relaxed);
+    stats.active_workers = m_active_workers.load(std::memory_order_relaxed);
+    stats.max_workers = m_config.max_workers;
+    stats.enqueued = m_enqueued.load(std::memory_order_relaxed);
+    stats.processed = m_processed.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ProcessingPool::workerLoop(size_t index) {
+    threadPlacement::apply("processing", index);
+    const auto interval = std::chrono::milliseconds(m_config.scale_interval_ms);
+    Request request;
+    unsigned spins = 0;
+
+    while (true) {
+        // Масштабированием занимается первый поток, он активен всегда
+        if (index == 0 && std::chrono::steady_clock::now() - m_last_adjust >= interval) {
+            adjustWorkers();
+        }
+
+        // Поток сверх текущего числа активных ждет, пока его не позовут
+        if (index >= m_active_workers.load(std::memory_order_relaxed)) {
+            std::unique_lock<std::mutex> lock(m_wait_mutex);
+            if (!m_running) break;
+            m_wait_cv.wait_for(lock, interval, [&]() {
+                return !m_running || index < m_active_workers.load(std::memory_order_relaxed);
+            });
+            continue;
+        }
+
+        if (m_queue.tryPop(request)) {
+            process(request);
+            spins = 0;
+            continue;
+        }
+        // После остановки работаем, пока очередь не опустеет
+        if (!m_running) break;
+        if (++spins < kSpinLimit) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        spins = 0;
+        std::unique_lock<std::mutex> lock(m_wait_mutex);
+        m_idle_workers.fetch_add(1);
+        m_wait_cv.wait_for(lock, interval, [&]() {
+            return !m_running || m_queue.sizeApprox() > 0;
+        });
+        m_idle_workers.fetch_sub(1);
+    }
+}
+
+void ProcessingPool::process(const Request& request) {
+    char response[kMaxResponseSize];
+    size_t response_len = 0;
+    try {
+        response_len = m_handler(request.data.data(), request.len, request.addr,
+                                 request.arrival_ns, response, sizeof(response));
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] " << e.what() << std::endl;
+    }
+    m_processed.fetch_add(1, std::memory_order_relaxed);
+    if (response_len == 0) return;
+
+    if (sendto(request.sockfd, response, response_len, 0,
+               (const sockaddr*)&request.addr, sizeof(request.addr)) < 0) {
+        m_log->sendToLog("Failed to send data");
+    }
+}
+
+void ProcessingPool::adjustWorkers() {
+    m_last_adjust = std::chrono::steady_clock::now();
+    const size_t depth = m_queue.sizeApprox();
+    const size_t active = m_active_workers.load(std::memory_order_relaxed);
+
+    if (depth > active * kGrowDepthPerWorker && active < m_config.max_workers) {
+        m_active_workers.store(active + 1, std::memory_order_relaxed);
+        m_idle_intervals = 0;
+        m_wait_cv.notify_all();
+        m_log->sendToLog(LogLevel::Debug, "Processing pool grown to " + std::to_string(active + 1) +
+                         " worker(s), queue depth " + std::to_string(depth));
+        return;
+    }
+
+    if (depth > 0) {
+        m_idle_intervals = 0;
+    } else if (++m_idle_intervals >= kShrinkIdleIntervals && active > m_config.min_workers) {
+        m_active_workers.store(active - 1, std::memory_order_relaxed);
+        m_idle_intervals = 0;
+        m_log->sendToLog(LogLevel::Debug, "Processing pool shrunk to " + std::to_string(active - 1) +
+                         " worker(s)");
+    }
+}
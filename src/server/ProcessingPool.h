@@ -0,0 +1,120 @@
+//ProcessingPool.h
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <netinet/in.h>
+#include <nlohmann/json.hpp>
+#include "MpmcQueue.h"
+#include "../Logger.h"
+#include "../ThreadPlacement.h"
+
+// Настройки пула обработки запросов
+struct ProcessingPoolConfig {
+    uint16_t min_workers = 1;           // Рабочих потоков всегда активно
+    uint16_t max_workers = 1;           // Предел роста при длинной очереди
+    uint32_t queue_capacity = 4096;     // Емкость очереди (округляется до степени двойки)
+    uint32_t scale_interval_ms = 10;    // Период пересчета числа активных потоков
+};
+
+// Датчики очереди между приемом и обработкой
+struct QueueStats {
+    uint64_t capacity = 0;
+    uint64_t depth = 0;                 // Текущая глубина
+    uint64_t peak_depth = 0;            // Максимальная глубина с запуска
+    uint64_t active_workers = 0;
+    uint64_t max_workers = 0;
+    uint64_t enqueued = 0;
+    uint64_t processed = 0;
+    uint64_t dropped = 0;               // Отброшено из-за переполнения очереди
+};
+
+void to_json(nlohmann::json& j, const QueueStats& stats);
+
+// Пул потоков обработки: поток приема кладет датаграммы в lock-free очередь,
+// рабочие потоки обрабатывают их и отправляют ответы с того же сокета.
+// Число активных потоков меняется от min_workers до max_workers по глубине очереди.
+class ProcessingPool {
+
+public:
+
+    // Обработчик запроса: ответ пишется в буфер, 0 - ответ не отправляется
+    // arrival_ns - время прихода датаграммы в ядро (0 - неизвестно)
+    using Handler = std::function<size_t(const char* data, size_t len, const sockaddr_in& addr,
+                                         int64_t arrival_ns, char* response, size_t capacity)>;
+
+    // Датаграммы длиннее не ставятся в очередь (обрабатываются в потоке приема)
+    static constexpr size_t kMaxRequestSize = 256;
+
+    static constexpr size_t kMaxResponseSize = 256;
+
+    ProcessingPool(const ProcessingPoolConfig& config,
+                   Handler handler,
+                   std::shared_ptr<Logger> log);
+
+    ~ProcessingPool();
+
+    void start();
+
+    // Останавливает потоки после обработки уже принятых запросов
+    void stop();
+
+    // Поставить запрос в очередь; false - очередь заполнена, запрос отброшен
+    bool submit(int sockfd, const sockaddr_in& addr, const char* data, size_t len,
+                int64_t arrival_ns = 0);
+
+    QueueStats getStats() const;
+
+private:
+
+    struct Request {
+        int sockfd = -1;
+        sockaddr_in addr{};
+        int64_t arrival_ns = 0;
+        uint16_t len = 0;
+        std::array<char, kMaxRequestSize> data;
+    };
+
+    void workerLoop(size_t index);
+
+    // Обработка и отправка ответа
+    void process(const Request& request);
+
+    // Пересчет числа активных потоков по глубине очереди
+    void adjustWorkers();
+
+    ProcessingPoolConfig m_config;
+
+    Handler m_handler;
+
+    std::shared_ptr<Logger> m_log;
+
+    MpmcQueue<Request> m_queue;
+
+    std::vector<std::thread> m_threads;
+
+    std::atomic<bool> m_running{false};
+
+    std::atomic<size_t> m_active_workers{0};
+
+    // Ожидание работы простаивающими и "припаркованными" потоками
+    std::mutex m_wait_mutex;
+    std::condition_variable m_wait_cv;
+    std::atomic<size_t> m_idle_workers{0};
+
+    std::chrono::steady_clock::time_point m_last_adjust;
+    uint32_t m_idle_intervals = 0;
+
+    std::atomic<uint64_t> m_enqueued{0};
+    std::atomic<uint64_t> m_processed{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_peak_depth{0};
+};
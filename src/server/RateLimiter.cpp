@@ -0,0 +1,103 @@
+//RateLimiter.cpp
+
+#include "RateLimiter.h"
+#include "../Clock.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+RateLimitAction parseRateLimitAction(const std::string& name) {
+    if (name == "reject") return RateLimitAction::Reject;
+    if (name == "drop") return RateLimitAction::Drop;
+    throw std::invalid_argument("Unknown rate limit action: " + name);
+}
+
+void to_json(nlohmann::json& j, const RateLimiterStats& stats) {
+    j = nlohmann::json{
+        {"allowed", stats.allowed},
+        {"limited", stats.limited},
+        {"evictions", stats.evictions},
+        {"table_size", stats.table_size},
+        {"memory_bytes", stats.memory_bytes}
+    };
+}
+
+RateLimiter::RateLimiter(const RateLimiterConfig& config)
+: m_config(config), m_epoch_ms(coarseClock::monotonicMs()) {
+    if (m_config.rate <= 0) {
+        throw std::invalid_argument("Rate limit must be positive");
+    }
+    m_config.burst = std::max(m_config.burst, 1.0);
+
+    size_t size = kGroupSize;
+    while (size < m_config.table_size) size <<= 1;
+    m_config.table_size = static_cast<uint32_t>(size);
+    m_group_mask = size / kGroupSize - 1;
+    m_entries = std::make_unique<Entry[]>(size);
+    std::fill(m_entries.get(), m_entries.get() + size, Entry{0, 0, 0.0f});
+
+    m_refill_ms = static_cast<uint32_t>(std::ceil(m_config.burst * 1000.0 / m_config.rate));
+}
+
+uint32_t RateLimiter::nowMs() const {
+    return static_cast<uint32_t>(coarseClock::monotonicMs() - m_epoch_ms);
+}
+
+bool RateLimiter::allow(uint32_t addr) {
+    const uint32_t now = nowMs();
+    const size_t group = ((uint64_t(addr) * 0x9E3779B97F4A7C15ull) >> 32) & m_group_mask;
+    Entry* entries = m_entries.get() + group * kGroupSize;
+
+    bool allowed;
+    {
+        std::lock_guard<std::mutex> lock(m_locks[group % kLockStripes]);
+
+        // Ищем адрес; попутно выбираем запись на вытеснение (самую старую)
+        Entry* entry = nullptr;
+        Entry* victim = nullptr;
+        for (size_t i = 0; i < kGroupSize; ++i) {
+            Entry& candidate = entries[i];
+            if (candidate.addr == addr) {
+                entry = &candidate;
+                break;
+            }
+            if (victim && victim->addr == 0) continue;
+            if (!victim || candidate.addr == 0 ||
+                now - candidate.last_ms > now - victim->last_ms) {
+                victim = &candidate;
+            }
+        }
+
+        if (!entry) {
+            // Запись, не тронутая дольше полного пополнения, эквивалентна свободной
+            if (victim->addr != 0 && now - victim->last_ms < m_refill_ms) {
+                m_evictions.fetch_add(1, std::memory_order_relaxed);
+            }
+            entry = victim;
+            entry->addr = addr;
+            entry->last_ms = now;
+            entry->tokens = static_cast<float>(m_config.burst);
+        } else {
+            const double refill = double(now - entry->last_ms) * m_config.rate / 1000.0;
+            entry->tokens = static_cast<float>(std::min(m_config.burst, entry->tokens + refill));
+            entry->last_ms = now;
+        }
+
+        allowed = entry->tokens >= 1.0f;
+        if (allowed) entry->tokens -= 1.0f;
+    }
+
+    (allowed ? m_allowed : m_limited).fetch_add(1, std::memory_order_relaxed);
+    return allowed;
+}
+
+RateLimiterStats RateLimiter::getStats() const {
+    RateLimiterStats stats;
+    stats.allowed = m_allowed.load(std::memory_order_relaxed);
+    stats.limited = m_limited.load(std::memory_order_relaxed);
+    stats.evictions = m_evictions.load(std::memory_order_relaxed);
+    stats.table_size = m_config.table_size;
+    stats.memory_bytes = m_config.table_size * sizeof(Entry);
+    return stats;
+}
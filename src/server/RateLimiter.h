@@ -0,0 +1,88 @@
+//RateLimiter.h
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <nlohmann/json.hpp>
+
+// Что делать с запросом сверх лимита
+enum class RateLimitAction {
+    Reject,     // Ответ "rejected (rate limited)"
+    Drop        // Молча отбросить
+};
+
+RateLimitAction parseRateLimitAction(const std::string& name);
+
+// Настройки ограничения запросов по адресу источника
+struct RateLimiterConfig {
+    double rate = 100.0;                // Запросов в секунду на адрес
+    double burst = 200.0;               // Емкость корзины
+    uint32_t table_size = 65536;        // Отслеживаемых адресов (округляется до степени двойки)
+    RateLimitAction action = RateLimitAction::Reject;
+};
+
+struct RateLimiterStats {
+    uint64_t allowed = 0;
+    uint64_t limited = 0;
+    uint64_t evictions = 0;             // Вытеснено записей активных источников
+    uint64_t table_size = 0;
+    uint64_t memory_bytes = 0;          // Память таблицы (фиксирована)
+};
+
+void to_json(nlohmann::json& j, const RateLimiterStats& stats);
+
+// Token bucket на каждый IPv4 адрес источника.
+// Таблица фиксированного размера, разбитая на группы по kGroupSize записей:
+// адрес ищется только в своей группе, при нехватке места вытесняется запись,
+// к которой дольше всего не обращались. Память не растет с числом источников.
+class RateLimiter {
+
+public:
+
+    explicit RateLimiter(const RateLimiterConfig& config);
+
+    // Списать токен для адреса (network byte order); false - лимит превышен
+    bool allow(uint32_t addr);
+
+    RateLimitAction action() const { return m_config.action; }
+
+    RateLimiterStats getStats() const;
+
+private:
+
+    static constexpr size_t kGroupSize = 8;
+    static constexpr size_t kLockStripes = 64;
+
+    // Запись источника; addr == 0 - свободна (0.0.0.0 не бывает адресом источника)
+    struct Entry {
+        uint32_t addr;
+        uint32_t last_ms;   // Время последнего пополнения от m_epoch_ms
+        float tokens;
+    };
+
+    uint32_t nowMs() const;
+
+    RateLimiterConfig m_config;
+
+    std::unique_ptr<Entry[]> m_entries;
+
+    size_t m_group_mask = 0;
+
+    // Полное пополнение пустой корзины, мс: запись старше - то же, что свободная
+    uint32_t m_refill_ms = 0;
+
+    uint64_t m_epoch_ms;
+
+    // Блокировки по группам (чередованием), группа целиком под одной блокировкой
+    std::array<std::mutex, kLockStripes> m_locks;
+
+    std::atomic<uint64_t> m_allowed{0};
+    std::atomic<uint64_t> m_limited{0};
+    std::atomic<uint64_t> m_evictions{0};
+};
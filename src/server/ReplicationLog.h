@@ -0,0 +1,67 @@
+//ReplicationLog.h
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "MpmcQueue.h"
+
+// Изменение таблицы сессий, передаваемое резервному серверу
+enum class SessionDeltaOp : uint8_t {
+    Create = 1,
+    Refresh = 2,
+    Remove = 3
+};
+
+struct SessionDelta {
+    uint64_t key = 0;                       // Упакованный IMSI (imsiKey::pack)
+    SessionDeltaOp op = SessionDeltaOp::Create;
+};
+
+// Изменения основного сервера для репликации. Горячий путь только кладет запись
+// в lock-free очередь (под блокировкой шарда - порядок изменений одного ключа сохраняется),
+// поток репликации забирает их пакетами. Заполненная очередь не задерживает запросы:
+// изменение отбрасывается с отметкой, и резервный сервер догоняет по снимку.
+class ReplicationLog {
+
+public:
+
+    // refresh_ms - продление сессии передается не чаще раза за окно refresh_ms
+    ReplicationLog(size_t capacity, uint32_t refresh_ms)
+    : m_queue(capacity), m_refresh_ms(refresh_ms ? refresh_ms : 1) {}
+
+    void record(SessionDeltaOp op, uint64_t key) {
+        if (m_queue.tryPush(SessionDelta{key, op})) return;
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        m_overflow.store(true, std::memory_order_release);
+    }
+
+    // Метка активности перешла границу окна: у резервного она отстает не больше чем на окно
+    bool refreshDue(uint32_t previous_ms, uint32_t now_ms) const {
+        return previous_ms / m_refresh_ms != now_ms / m_refresh_ms;
+    }
+
+    bool tryPop(SessionDelta& delta) { return m_queue.tryPop(delta); }
+
+    // Было ли переполнение с прошлого вызова (сбрасывает отметку)
+    bool takeOverflow() { return m_overflow.exchange(false, std::memory_order_acq_rel); }
+
+    size_t depth() const { return m_queue.sizeApprox(); }
+
+    size_t capacity() const { return m_queue.capacity(); }
+
+    uint32_t refreshMs() const { return m_refresh_ms; }
+
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+
+    MpmcQueue<SessionDelta> m_queue;
+
+    uint32_t m_refresh_ms;
+
+    std::atomic<bool> m_overflow{false};
+
+    std::atomic<uint64_t> m_dropped{0};
+};
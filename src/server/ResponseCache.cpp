@@ -0,0 +1,117 @@
+//ResponseCache.cpp
+
+#include "ResponseCache.h"
+#include "../Clock.h"
+
+#include <cstring>
+
+void to_json(nlohmann::json& j, const ResponseCacheStats& stats) {
+    j = nlohmann::json{
+        {"hits", stats.hits},
+        {"misses", stats.misses},
+        {"stores", stats.stores},
+        {"evictions", stats.evictions},
+        {"size", stats.size},
+        {"window_ms", stats.window_ms},
+        {"memory_bytes", stats.memory_bytes}
+    };
+}
+
+ResponseCache::ResponseCache(const ResponseCacheConfig& config)
+: m_config(config), m_epoch_ms(coarseClock::monotonicMs()) {
+    size_t size = kWays;
+    while (size < m_config.size) size <<= 1;
+    m_config.size = static_cast<uint32_t>(size);
+    m_set_mask = size / kWays - 1;
+    m_entries = std::make_unique<Entry[]>(size);
+    for (size_t i = 0; i < size; ++i) {
+        m_entries[i].len = 0;
+    }
+}
+
+uint32_t ResponseCache::nowMs() const {
+    return static_cast<uint32_t>(coarseClock::monotonicMs() - m_epoch_ms);
+}
+
+size_t ResponseCache::setIndex(const Key& key) const {
+    uint64_t hash = (uint64_t(key.addr) << 32) ^ (uint64_t(key.port) << 16) ^ key.protocol;
+    hash ^= uint64_t(key.sequence) * 0x9E3779B97F4A7C15ull;
+    hash *= 0xC2B2AE3D27D4EB4Full;
+    return (hash >> 32) & m_set_mask;
+}
+
+bool ResponseCache::matches(const Entry& entry, const Key& key) {
+    return entry.len != 0 && entry.addr == key.addr && entry.port == key.port &&
+           entry.protocol == key.protocol && entry.sequence == key.sequence;
+}
+
+size_t ResponseCache::lookup(const Key& key, char* response, size_t capacity) {
+    const uint32_t now = nowMs();
+    const size_t set = setIndex(key);
+    Entry* entries = m_entries.get() + set * kWays;
+    size_t len = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_locks[set % kLockStripes]);
+        for (size_t i = 0; i < kWays; ++i) {
+            const Entry& entry = entries[i];
+            if (matches(entry, key) && now - entry.stored_ms <= m_config.window_ms &&
+                entry.len <= capacity) {
+                len = entry.len;
+                std::memcpy(response, entry.data, len);
+                break;
+            }
+        }
+    }
+    (len ? m_hits : m_misses).fetch_add(1, std::memory_order_relaxed);
+    return len;
+}
+
+void ResponseCache::store(const Key& key, const char* response, size_t len) {
+    if (len == 0 || len > kMaxResponseSize) return;
+
+    const uint32_t now = nowMs();
+    const size_t set = setIndex(key);
+    Entry* entries = m_entries.get() + set * kWays;
+    {
+        std::lock_guard<std::mutex> lock(m_locks[set % kLockStripes]);
+
+        // Тот же ключ, свободная запись или самая старая
+        Entry* target = nullptr;
+        for (size_t i = 0; i < kWays && !target; ++i) {
+            if (matches(entries[i], key)) target = &entries[i];
+        }
+        for (size_t i = 0; i < kWays && !target; ++i) {
+            if (entries[i].len == 0) target = &entries[i];
+        }
+        if (!target) {
+            target = entries;
+            for (size_t i = 1; i < kWays; ++i) {
+                if (now - entries[i].stored_ms > now - target->stored_ms) target = &entries[i];
+            }
+            if (now - target->stored_ms <= m_config.window_ms) {
+                m_evictions.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        target->addr = key.addr;
+        target->port = key.port;
+        target->protocol = key.protocol;
+        target->sequence = key.sequence;
+        target->stored_ms = now;
+        target->len = static_cast<uint8_t>(len);
+        std::memcpy(target->data, response, len);
+    }
+    m_stores.fetch_add(1, std::memory_order_relaxed);
+}
+
+ResponseCacheStats ResponseCache::getStats() const {
+    ResponseCacheStats stats;
+    stats.hits = m_hits.load(std::memory_order_relaxed);
+    stats.misses = m_misses.load(std::memory_order_relaxed);
+    stats.stores = m_stores.load(std::memory_order_relaxed);
+    stats.evictions = m_evictions.load(std::memory_order_relaxed);
+    stats.size = m_config.size;
+    stats.window_ms = m_config.window_ms;
+    stats.memory_bytes = m_config.size * sizeof(Entry);
+    return stats;
+}
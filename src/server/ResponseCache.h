@@ -0,0 +1,94 @@
+//ResponseCache.h
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+
+// Настройки кэша ответов на повторные запросы
+struct ResponseCacheConfig {
+    uint32_t size = 16384;          // Записей (округляется до степени двойки)
+    uint32_t window_ms = 2000;      // Сколько ответ считается актуальным для повтора
+};
+
+struct ResponseCacheStats {
+    uint64_t hits = 0;              // Повторы, отвеченные из кэша
+    uint64_t misses = 0;
+    uint64_t stores = 0;
+    uint64_t evictions = 0;         // Вытеснено актуальных записей
+    uint64_t size = 0;
+    uint64_t window_ms = 0;
+    uint64_t memory_bytes = 0;
+};
+
+void to_json(nlohmann::json& j, const ResponseCacheStats& stats);
+
+// Кэш ответов по (адрес, порт источника, номер последовательности).
+// Повтор запроса в пределах окна получает тот же ответ без обращения к SessionManager.
+// Таблица фиксированного размера, наборы по kWays записей, вытесняется самая старая.
+class ResponseCache {
+
+public:
+
+    // Ключ запроса; protocol различает номера текстового и бинарного протоколов
+    struct Key {
+        uint32_t addr;
+        uint16_t port;
+        uint8_t protocol;
+        uint32_t sequence;
+    };
+
+    // Ответы длиннее не кэшируются
+    static constexpr size_t kMaxResponseSize = 48;
+
+    explicit ResponseCache(const ResponseCacheConfig& config);
+
+    // Ответ из кэша в буфер; 0 - промах
+    size_t lookup(const Key& key, char* response, size_t capacity);
+
+    void store(const Key& key, const char* response, size_t len);
+
+    ResponseCacheStats getStats() const;
+
+private:
+
+    static constexpr size_t kWays = 4;
+    static constexpr size_t kLockStripes = 64;
+
+    // Одна запись - одна кэш-линия; len == 0 - запись свободна
+    struct alignas(64) Entry {
+        uint32_t addr;
+        uint16_t port;
+        uint8_t protocol;
+        uint8_t len;
+        uint32_t sequence;
+        uint32_t stored_ms;
+        char data[kMaxResponseSize];
+    };
+
+    size_t setIndex(const Key& key) const;
+
+    uint32_t nowMs() const;
+
+    static bool matches(const Entry& entry, const Key& key);
+
+    ResponseCacheConfig m_config;
+
+    std::unique_ptr<Entry[]> m_entries;
+
+    size_t m_set_mask = 0;
+
+    uint64_t m_epoch_ms;
+
+    std::array<std::mutex, kLockStripes> m_locks;
+
+    std::atomic<uint64_t> m_hits{0};
+    std::atomic<uint64_t> m_misses{0};
+    std::atomic<uint64_t> m_stores{0};
+    std::atomic<uint64_t> m_evictions{0};
+};
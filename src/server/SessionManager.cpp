@@ -1,6 +1,112 @@
 //SessionManager.cpp
 
 #include "SessionManager.h"
+#include "../Clock.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+CapacityPolicy parseCapacityPolicy(const std::string& name) {
+    if (name == "reject") return CapacityPolicy::Reject;
+    if (name == "evict") return CapacityPolicy::Evict;
+    throw std::invalid_argument("Unknown session limit policy: " + name);
+}
+
+void to_json(nlohmann::json& j, const SessionStats& stats) {
+    j = nlohmann::json{
+        {"sessions", stats.sessions},
+        {"shards", stats.shards},
+        {"max_shard_sessions", stats.max_shard_sessions},
+        {"capacity", stats.capacity},
+        {"memory_bytes", stats.memory_bytes},
+        {"timer_records", stats.timer_records},
+        {"accounted_bytes", stats.accounted_bytes},
+        {"session_limit", stats.session_limit},
+        {"memory_limit_bytes", stats.memory_limit_bytes},
+        {"capacity_policy", stats.capacity_policy},
+        {"evictions", stats.evictions},
+        {"timer_compactions", stats.timer_compactions},
+        {"capacity_rejects", stats.capacity_rejects},
+        {"huge_pages", stats.huge_pages},
+        {"bytes_per_session", stats.sessions ? double(stats.memory_bytes) / stats.sessions : 0.0}
+    };
+}
+
+void to_json(nlohmann::json& j, const DrainStats& stats) {
+    j = nlohmann::json{
+        {"state", stats.state},
+        {"rate", stats.rate},
+        {"total", stats.total},
+        {"drained", stats.drained},
+        {"remaining", stats.remaining},
+        {"batches", stats.batches},
+        {"elapsed_ms", stats.elapsed_ms},
+        {"actual_rate", stats.actual_rate},
+        {"eta_sec", stats.eta_sec}
+    };
+}
+
+SessionPolicy::SessionPolicy(const SessionManagerConfig& config)
+    : session_timeout_ms(config.session_timeout_ms ? config.session_timeout_ms
+                                                   : uint32_t(config.session_timeout_sec) * 1000),
+    blacklist(config.blacklist, config.blacklist_file) {}
+
+SessionManager::SessionManager(const SessionManagerConfig& config, std::shared_ptr<Logger> log)
+    : m_epoch_ms(coarseClock::monotonicMs()), m_shutting_down(false),
+    m_cleanup_interval_ms(config.cleanup_interval_ms ? config.cleanup_interval_ms : 1000),
+    m_drain_rate(drainRate(config)),
+    m_policy(std::make_shared<const SessionPolicy>(config)), m_log(log), m_cleanup_running(false) {
+    size_t shards = 1;
+    while (shards < config.shards) shards <<= 1;
+    m_shards = std::make_unique<Shard[]>(shards);
+    m_shard_mask = shards - 1;
+    // Таблицы выделяются под max_sessions сразу, чтобы не расти под нагрузкой
+    m_huge_pages = config.huge_pages;
+    for (size_t i = 0; i < shards; ++i) {
+        m_shards[i].sessions = SessionTable((config.max_sessions + shards - 1) / shards, m_huge_pages);
+        m_shards[i].wheel = TimerWheel(config.timer_tick_ms, nowMs());
+        accountMemory(m_shards[i]);
+    }
+
+    // Пределы делятся между шардами: проверка не выходит за блокировку своего шарда
+    m_session_limit = config.max_sessions;
+    m_memory_limit = config.memory_limit_bytes;
+    m_capacity_policy = config.capacity_policy;
+    m_shard_session_limit = (m_session_limit + shards - 1) / shards;
+    m_shard_memory_limit = m_memory_limit / shards;
+    if (m_memory_limit > 0 && m_memory_bytes > m_memory_limit) {
+        throw std::invalid_argument("Session tables for max_sessions (" +
+                                    std::to_string(m_memory_bytes / 1024) + " KiB) exceed the memory limit (" +
+                                    std::to_string(m_memory_limit / 1024) + " KiB)");
+    }
+
+    m_cdr_file.open(config.cdr_file, std::ios::app);
+    if (!m_cdr_file.is_open()) {
+        spdlog::error("Failed to open CDR file: {}", config.cdr_file);
+        throw std::runtime_error("CDR file error");
+    }
+
+    m_snapshot_file = config.snapshot_file;
+    m_snapshot_interval_sec = config.snapshot_interval_sec;
+    m_snapshot_stats.file = m_snapshot_file;
+    if (!m_snapshot_file.empty() && config.snapshot_load) loadSnapshot();
+}
+
+namespace {
+
+    // Настройки прежнего конструктора; остальные поля - по умолчанию
+    SessionManagerConfig legacyConfig(uint16_t session_timeout_sec, uint16_t graceful_shutdown_rate,
+                                      const std::string& cdr_file_path, const std::vector<std::string>& blacklist) {
+        SessionManagerConfig config;
+        config.session_timeout_sec = session_timeout_sec;
+        config.graceful_shutdown_rate = graceful_shutdown_rate;
+        config.cdr_file = cdr_file_path;
+        config.blacklist = blacklist;
+        return config;
+    }
+
+}
 
 SessionManager::SessionManager(
     const uint16_t& session_timeout_sec,
@@ -8,14 +114,19 @@ SessionManager::SessionManager(
     const std::string& cdr_file_path,
     const std::vector<std::string>& blacklist,
     std::shared_ptr<Logger> log)
-    : m_shutting_down(false), m_session_timeout_sec(session_timeout_sec),
-    m_graceful_shutdown_rate(graceful_shutdown_rate),
-    m_blacklist(blacklist), m_log(log), m_cleanup_running(false) {
-    m_cdr_file.open(cdr_file_path, std::ios::app);
-    if (!m_cdr_file.is_open()) {
-        spdlog::error("Failed to open CDR file: {}", cdr_file_path);
-        throw std::runtime_error("CDR file error");
-    }
+    : SessionManager(legacyConfig(session_timeout_sec, graceful_shutdown_rate, cdr_file_path, blacklist), log) {}
+
+SessionManager::Shard& SessionManager::shardFor(uint64_t key) const {
+    // Младшие биты хэша выбирают шард, старшие - позицию в его таблице
+    return m_shards[SessionTable::hash(key) & m_shard_mask];
+}
+
+uint64_t SessionManager::wallMs() {
+    return coarseClock::wallMs();
+}
+
+uint32_t SessionManager::nowMs() const {
+    return static_cast<uint32_t>(coarseClock::monotonicMs() - m_epoch_ms);
 }
 
 SessionManager::~SessionManager() {
@@ -23,53 +134,183 @@ SessionManager::~SessionManager() {
 }
 
 std::string SessionManager::handleImsi(const std::string& raw_imsi) {
-    std::string imsi = validImsi(raw_imsi);
-    
-    if (imsi.empty()) return "rejected";
+    return std::string(toResponse(handleImsi(std::string_view(raw_imsi))));
+}
+
+size_t SessionManager::collectDigits(std::string_view raw_imsi, char* digits) {
+    // Как и в validImsi, прочие символы отбрасываются
+    size_t length = 0;
+    for (char c : raw_imsi) {
+        if (!std::isdigit(static_cast<unsigned char>(c))) continue;
+        if (length == kMaxImsiDigits) return 0;
+        digits[length++] = c;
+    }
+    return length;
+}
+
+SessionResult SessionManager::handleImsi(std::string_view raw_imsi) {
+    // Цифры IMSI собираются в буфер на стеке
+    char digits[kMaxImsiDigits];
+    const size_t length = collectDigits(raw_imsi, digits);
+    if (length == 0) return SessionResult::Rejected;
 
-    if (m_shutting_down) return "rejected (server shutting down)";
+    if (m_shutting_down) return SessionResult::ShuttingDown;
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    const std::string_view imsi(digits, length);
+    const uint64_t key = imsiKey::pack(imsi);
 
-    if (isBlacklisted(imsi)) {
-        writeToCdr(imsi, "rejected_blacklist");
-        m_log->sendToLog("Session rejected for IMSI: " + imsi);
-        spdlog::info("Session rejected for IMSI: {}", imsi);
-        return "rejected";
+    // Снимок настроек неизменяем и читается один раз на запрос, до блокировки шарда
+    const SessionPolicy* policy = m_policy.get();
+    if (policy->blacklist.contains(key)) {
+        const std::string rejected(imsi);
+        writeToCdr(rejected, "rejected_blacklist");
+        m_log->sendToLog("Session rejected for IMSI: " + rejected);
+        spdlog::info("Session rejected for IMSI: {}", rejected);
+        return SessionResult::Rejected;
     }
 
-    auto it = m_sessions.find(imsi);
-    if (it != m_sessions.end()) {
-        it->second.created_at = std::chrono::system_clock::now();
-        return "exists";
+    Shard& shard = shardFor(key);
+    // Повторный запрос существующей сессии не берет исключительную блокировку
+    if (refreshExisting(shard, key)) return SessionResult::Exists;
+
+    bool inserted = false;
+    uint64_t evicted = 0;
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        const uint32_t now_ms = nowMs();
+        if (!makeRoom(shard, key, now_ms, evicted)) {
+            m_capacity_rejects.fetch_add(1, std::memory_order_relaxed);
+            return SessionResult::CapacityExceeded;
+        }
+        inserted = touchSession(shard, key, now_ms, policy->session_timeout_ms);
+        accountMemory(shard);
+        if (m_replication) replicateInsert(key, inserted, evicted);
     }
+    if (evicted != 0) recordEvicted(evicted);
+    if (!inserted) return SessionResult::Exists;
 
-    addSession(imsi);
-    return "created";
+    // IMSI не длиннее 15 символов умещается в SSO std::string без выделения памяти
+    recordCreated(std::string(imsi));
+    return SessionResult::Created;
 }
 
-bool SessionManager::isSessionActive(const std::string &imsi) const {
-    std::cout << "SessionManager::isSessionActive:IMSI: " << imsi << std::endl;
-    spdlog::debug("SessionManager::isSessionActive:IMSI: {}", imsi);
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto it = m_sessions.find(imsi);
+bool SessionManager::refreshSession(std::string_view raw_imsi) {
+    char digits[kMaxImsiDigits];
+    const size_t length = collectDigits(raw_imsi, digits);
+    if (length == 0 || m_shutting_down) return false;
 
-    if (it != m_sessions.end()) {
-        std::cout << "SessionManager::isSessionActive:it->second.active: "
-            << it->second.active << std::endl;
-    } else if (it == m_sessions.end()) {
-        std::cout << "it == m_sessions.end() " << std::endl;
+    const uint64_t key = imsiKey::pack(std::string_view(digits, length));
+    return refreshExisting(shardFor(key), key);
+}
+
+bool SessionManager::refreshExisting(Shard& shard, uint64_t key) const {
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    SessionEntry* entry = shard.sessions.find(key);
+    if (!entry) return false;
+    // Колесо не трогаем: при наступлении старого срока запись переставится на новый.
+    // Таблица под блокировкой на чтение не перестраивается - меняется только атомарная метка
+    const uint32_t now_ms = nowMs();
+    if (m_replication &&
+        m_replication->refreshDue(entry->touched_ms.load(std::memory_order_relaxed), now_ms)) {
+        m_replication->record(SessionDeltaOp::Refresh, key);
     }
+    entry->touched_ms.store(now_ms | SessionEntry::kReferenced, std::memory_order_relaxed);
+    return true;
+}
 
-    return it != m_sessions.end() && it->second.active;
+bool SessionManager::makeRoom(Shard& shard, uint64_t key, uint32_t now_ms, uint64_t& evicted) {
+    const SessionTable& table = shard.sessions;
+    const bool full =
+        (m_shard_session_limit > 0 && table.size() >= m_shard_session_limit) ||
+        (m_shard_memory_limit > 0 &&
+         shard.accounted_bytes + table.growthBytes() + kTimerRecordBytes > m_shard_memory_limit);
+    // Существующая сессия места не требует
+    if (!full || table.find(key)) return true;
+    if (m_capacity_policy == CapacityPolicy::Reject) return false;
+    const size_t victim = shard.sessions.clockVictim();
+    if (victim >= shard.sessions.capacity()) return false;
+    evicted = shard.sessions.at(victim).key;
+    shard.sessions.eraseAt(victim);
+    dropStaleTimers(shard, now_ms);
+    return true;
+}
+
+void SessionManager::dropStaleTimers(Shard& shard, uint32_t now_ms) {
+    // Запись удаленной сессии остается в колесе до прежнего срока. При вытеснении под
+    // потоком новых сессий таких записей за таймаут набралось бы сколько угодно -
+    // колесо перестраивается по живым сессиям, когда устаревших больше четверти живых.
+    // Перестройка O(емкости) приходится на size/4 удалений - в среднем O(1) на удаление
+    const size_t live = shard.sessions.size();
+    if (shard.wheel.size() <= live + live / 4 + kStaleTimerSlack) return;
+    TimerWheel wheel(shard.wheel.tickMs(), now_ms);
+    const SessionTable& table = shard.sessions;
+    for (size_t index = table.next(0); index < table.capacity(); index = table.next(index + 1)) {
+        wheel.schedule(table.at(index).key, table.at(index).wheel_ms);
+    }
+    std::swap(shard.wheel, wheel);
+    m_timer_compactions.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SessionManager::accountMemory(Shard& shard) {
+    const size_t bytes = shard.sessions.memoryBytes() + shard.wheel.size() * kTimerRecordBytes;
+    if (bytes >= shard.accounted_bytes) {
+        m_memory_bytes.fetch_add(bytes - shard.accounted_bytes, std::memory_order_relaxed);
+    } else {
+        m_memory_bytes.fetch_sub(shard.accounted_bytes - bytes, std::memory_order_relaxed);
+    }
+    shard.accounted_bytes = bytes;
+}
+
+void SessionManager::recordEvicted(uint64_t key) {
+    m_evictions.fetch_add(1, std::memory_order_relaxed);
+    char digits[imsiKey::kMaxDigits];
+    const std::string imsi(digits, imsiKey::unpack(key, digits));
+    writeToCdr(imsi, "capacity_evict");
+    if (m_log->isEnabled(LogLevel::Debug)) {
+        m_log->sendToLog(LogLevel::Debug, "Capacity evict: " + imsi);
+    }
+}
+
+void SessionManager::replicateInsert(uint64_t key, bool inserted, uint64_t evicted) {
+    if (evicted != 0) m_replication->record(SessionDeltaOp::Remove, evicted);
+    if (inserted) m_replication->record(SessionDeltaOp::Create, key);
+}
+
+bool SessionManager::touchSession(Shard& shard, uint64_t key, uint32_t now_ms, uint32_t timeout_ms) {
+    bool inserted = false;
+    SessionEntry& entry = shard.sessions.insert(key, inserted);
+    // Новая сессия без бита обращения: при вытеснении продленные получают второй шанс
+    entry.touched_ms.store(inserted ? now_ms & ~SessionEntry::kReferenced : now_ms | SessionEntry::kReferenced,
+                           std::memory_order_relaxed);
+    if (inserted) {
+        entry.wheel_ms = now_ms + timeout_ms;
+        shard.wheel.schedule(key, entry.wheel_ms);
+    }
+    return inserted;
+}
+
+bool SessionManager::isSessionActive(std::string_view imsi) const {
+    // Запросы мониторинга: без вывода в консоль и выделения памяти, блокировка на чтение
+    const uint64_t key = imsiKey::pack(imsi);
+    if (key == 0) return false;
+    const Shard& shard = shardFor(key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.sessions.find(key) != nullptr;
+}
+
+bool SessionManager::isSessionActive(const std::string &imsi) const {
+    return isSessionActive(std::string_view(imsi));
 }
 
 void SessionManager::startCleanupTimer() {
     m_cleanup_running = true;
     m_cleanup_thread = std::thread([this]() {
+        threadPlacement::apply("cleanup");
         while (m_cleanup_running) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+            std::this_thread::sleep_for(std::chrono::milliseconds(m_cleanup_interval_ms));
             cleanupExpiredSessions();
+            // Снимки настроек, которые потоки запросов уже отпустили, освобождаются здесь
+            m_policy.reclaim();
         }
     });
 }
@@ -82,71 +323,611 @@ void SessionManager::stopCleanupTimer() {
 }
 
 void SessionManager::gracefulShutdown() {
+    startDrain();
+    waitDrain();
+    std::lock_guard<std::mutex> lock(m_cdr_mutex);
+    if (m_cdr_file.is_open()) m_cdr_file.close();
+}
+
+uint32_t SessionManager::drainRate(const SessionManagerConfig& config) {
+    if (config.drain_rate > 0) return config.drain_rate;
+    return config.graceful_shutdown_rate > 0 ? 1000u / config.graceful_shutdown_rate : 0;
+}
+
+void SessionManager::startDrain() {
+    std::lock_guard<std::mutex> lock(m_drain_mutex);
+    if (m_drain_state != DrainState::Idle) return;
     m_log->sendToLog("Starting graceful shutdown...");
+    m_shutting_down = true;
     stopCleanupTimer();
-    
-    while (!m_sessions.empty()) {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        auto it = m_sessions.begin();
-        writeToCdr(it->first, "shutdown_remove");
-        m_sessions.erase(it);
-        std::this_thread::sleep_for(
-            std::chrono::milliseconds(m_graceful_shutdown_rate)
-        );
+    stopSnapshotTimer();
+    m_drain_started = std::chrono::steady_clock::now();
+    m_drain_total = getStats().sessions;
+    m_drain_state = m_snapshot_file.empty() ? DrainState::Draining : DrainState::Snapshot;
+    m_drain_thread = std::thread([this]() {
+        threadPlacement::apply("drain");
+        drainSessions();
+    });
+}
+
+void SessionManager::waitDrain() {
+    std::unique_lock<std::mutex> lock(m_drain_mutex);
+    m_drain_cv.wait(lock, [this]() {
+        return m_drain_state == DrainState::Idle || m_drain_state == DrainState::Done;
+    });
+    // После Done поток только возвращается и блокировку не ждет
+    if (m_drain_thread.joinable()) m_drain_thread.join();
+}
+
+void SessionManager::drainSessions() {
+    const auto finish = [this]() {
+        std::lock_guard<std::mutex> lock(m_drain_mutex);
+        m_drain_finished = std::chrono::steady_clock::now();
+        m_drain_state = DrainState::Done;
+        m_drain_cv.notify_all();
+    };
+
+    // Теплый перезапуск: сессии остаются в снимке, CDR об удалении не пишутся
+    if (m_drain_state == DrainState::Snapshot) {
+        try {
+            const size_t saved = saveSnapshot();
+            m_log->sendToLog("Sessions kept for warm restart: " + std::to_string(saved));
+            spdlog::info("Sessions kept for warm restart: {} ({})", saved, m_snapshot_file);
+            finish();
+            return;
+        } catch (const std::exception& e) {
+            spdlog::error("Session snapshot on shutdown failed, draining sessions: {}", e.what());
+        }
     }
-    if (m_cdr_file.is_open()) m_cdr_file.close();
+
+    m_drain_state = DrainState::Draining;
+    spdlog::info("Draining {} session(s) at {} per second", getDrainStats().total,
+                 m_drain_rate ? std::to_string(m_drain_rate) : std::string("unlimited"));
+
+    std::vector<uint64_t> batch;
+    batch.reserve(kDrainBatch);
+    double tokens = 0.0;
+    auto refilled = std::chrono::steady_clock::now();
+    for (size_t i = 0; i <= m_shard_mask; ++i) {
+        Shard& shard = m_shards[i];
+        // Удаление сдвигает записи только на освободившуюся позицию - курсор не откатывается
+        size_t cursor = 0;
+        while (true) {
+            {
+                // Пустой шард не ждет токенов
+                std::shared_lock<std::shared_mutex> lock(shard.mutex);
+                if (shard.sessions.size() == 0) break;
+            }
+            size_t allowed = kDrainBatch;
+            const uint32_t rate = m_drain_rate.load(std::memory_order_relaxed);
+            if (rate > 0) {
+                // Пакет - сотая доля секундной нормы (от 1 до kDrainBatch сессий); корзина вмещает
+                // два пакета, чтобы опоздание пробуждения не снижало среднюю скорость
+                const double target = std::clamp(rate / 100.0, 1.0, double(kDrainBatch));
+                const auto now = std::chrono::steady_clock::now();
+                tokens = std::min(tokens + rate * std::chrono::duration<double>(now - refilled).count(),
+                                  2 * target);
+                refilled = now;
+                if (tokens < target) {
+                    std::this_thread::sleep_for(std::chrono::duration<double>((target - tokens) / rate));
+                    continue;
+                }
+                allowed = std::min(kDrainBatch, size_t(tokens));
+            }
+
+            batch.clear();
+            {
+                std::unique_lock<std::shared_mutex> lock(shard.mutex);
+                while (batch.size() < allowed) {
+                    cursor = shard.sessions.next(cursor);
+                    if (cursor >= shard.sessions.capacity()) {
+                        // Запись, сдвинутая через конец таблицы, может оказаться перед курсором
+                        if (shard.sessions.size() == 0) break;
+                        cursor = 0;
+                        continue;
+                    }
+                    batch.push_back(shard.sessions.at(cursor).key);
+                    shard.sessions.eraseAt(cursor);
+                    if (m_replication) m_replication->record(SessionDeltaOp::Remove, batch.back());
+                }
+            }
+            if (!batch.empty()) {
+                // CDR пишутся без блокировки шарда: isSessionActive не ждет записи в файл.
+                // Сессии резервного сервера остаются открытыми на основном - без CDR
+                if (!m_replica) writeCdrBatch(batch.data(), batch.size(), "shutdown_remove");
+                tokens -= double(batch.size());
+                m_drained.fetch_add(batch.size(), std::memory_order_relaxed);
+                m_drain_batches.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (batch.size() < allowed) break;
+        }
+    }
+
+    // Итог пишется до finish: после него waitDrain присоединяет поток под m_drain_mutex
+    const uint64_t drained = m_drained.load(std::memory_order_relaxed);
+    const double elapsed_sec = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - m_drain_started).count();
+    m_log->sendToLog("Graceful shutdown: " + std::to_string(drained) + " session(s) drained");
+    spdlog::info("Graceful shutdown: {} session(s) drained in {:.1f} s ({:.0f} per second, {} batches)",
+                 drained, elapsed_sec, elapsed_sec > 0.0 ? drained / elapsed_sec : 0.0,
+                 m_drain_batches.load(std::memory_order_relaxed));
+    finish();
+}
+
+DrainStats SessionManager::getDrainStats() const {
+    DrainStats stats;
+    std::lock_guard<std::mutex> lock(m_drain_mutex);
+    const DrainState state = m_drain_state;
+    switch (state) {
+        case DrainState::Idle: stats.state = "idle"; break;
+        case DrainState::Snapshot: stats.state = "snapshot"; break;
+        case DrainState::Draining: stats.state = "draining"; break;
+        case DrainState::Done: stats.state = "done"; break;
+    }
+    stats.rate = m_drain_rate.load(std::memory_order_relaxed);
+    stats.total = m_drain_total;
+    stats.drained = m_drained.load(std::memory_order_relaxed);
+    stats.remaining = stats.total > stats.drained ? stats.total - stats.drained : 0;
+    stats.batches = m_drain_batches.load(std::memory_order_relaxed);
+    if (state == DrainState::Idle) return stats;
+
+    const auto end = state == DrainState::Done ? m_drain_finished : std::chrono::steady_clock::now();
+    stats.elapsed_ms = std::chrono::duration<double, std::milli>(end - m_drain_started).count();
+    if (stats.elapsed_ms > 0.0) stats.actual_rate = stats.drained * 1000.0 / stats.elapsed_ms;
+    const double eta_rate = stats.rate > 0 ? double(stats.rate) : stats.actual_rate;
+    if (state == DrainState::Draining && eta_rate > 0.0) stats.eta_sec = stats.remaining / eta_rate;
+    return stats;
+}
+
+size_t SessionManager::saveSnapshot() {
+    if (m_snapshot_file.empty()) {
+        throw std::runtime_error("Session snapshot file is not configured");
+    }
+    std::unique_lock<std::mutex> write_lock(m_snapshot_mutex);
+    const auto started = std::chrono::steady_clock::now();
+    const SessionSnapshot snapshot = takeSnapshot();
+
+    size_t bytes = 0;
+    try {
+        bytes = snapshot.save(m_snapshot_file);
+    } catch (const std::exception&) {
+        ++m_snapshot_stats.write_failures;
+        throw;
+    }
+    ++m_snapshot_stats.writes;
+    m_snapshot_stats.last_sessions = snapshot.size();
+    m_snapshot_stats.last_bytes = bytes;
+    m_snapshot_stats.last_write_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - started).count();
+    spdlog::debug("Session snapshot written: {} sessions, {} bytes, {:.1f} ms",
+                  snapshot.size(), bytes, m_snapshot_stats.last_write_ms);
+    return snapshot.size();
+}
+
+SessionSnapshot SessionManager::takeSnapshot() const {
+    SessionSnapshot snapshot(wallMs());
+    for (size_t i = 0; i <= m_shard_mask; ++i) {
+        // Копия шарда под блокировкой на чтение: продления и проверки не ждут
+        const Shard& shard = m_shards[i];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        const SessionTable& table = shard.sessions;
+        const uint32_t now_ms = nowMs();
+        snapshot.reserve(snapshot.size() + table.size());
+        for (size_t index = table.next(0); index < table.capacity(); index = table.next(index + 1)) {
+            const SessionEntry& entry = table.at(index);
+            snapshot.add(entry.key, now_ms - entry.touched_ms.load(std::memory_order_relaxed));
+        }
+    }
+    return snapshot;
+}
+
+void SessionManager::loadSnapshot() {
+    const auto started = std::chrono::steady_clock::now();
+    if (!std::filesystem::exists(m_snapshot_file)) {
+        spdlog::info("No session snapshot at {}, starting with an empty table", m_snapshot_file);
+        return;
+    }
+    SessionSnapshot snapshot;
+    try {
+        snapshot = SessionSnapshot::load(m_snapshot_file);
+    } catch (const std::exception& e) {
+        // Испорченный снимок не мешает запуску: сессии создадутся заново
+        m_log->sendToLog("Session snapshot ignored: " + std::string(e.what()));
+        spdlog::warn("Session snapshot ignored: {}", e.what());
+        return;
+    }
+
+    // Пока сервер стоял, сессии старели: возраст из снимка плюс время простоя
+    const uint64_t now_wall = wallMs();
+    const uint64_t downtime_ms = now_wall > snapshot.wallMs() ? now_wall - snapshot.wallMs() : 0;
+    const uint32_t timeout_ms = m_policy->session_timeout_ms;
+
+    // Таблицы выделяются под снимок сразу (с запасом на неравномерность шардов)
+    const size_t shards = m_shard_mask + 1;
+    const size_t per_shard = (snapshot.size() + shards - 1) / shards;
+    for (size_t i = 0; i < shards; ++i) {
+        if (m_shards[i].sessions.capacity() / 4 * 3 < per_shard + per_shard / 8) {
+            m_shards[i].sessions = SessionTable(per_shard + per_shard / 8, m_huge_pages);
+        }
+    }
+
+    // Запросы еще не обрабатываются - шарды заполняются без блокировок
+    const uint32_t now_ms = nowMs();
+    std::vector<uint64_t> expired;
+    std::vector<uint64_t> evicted;          // Не уместились в пределы
+    uint64_t loaded = 0;
+    for (size_t i = 0; i < snapshot.size(); ++i) {
+        const uint64_t key = snapshot.key(i);
+        const uint64_t age_ms = uint64_t(snapshot.ageMs(i)) + downtime_ms;
+        if (key == 0) continue;
+        if (age_ms >= timeout_ms) {
+            expired.push_back(key);
+            continue;
+        }
+        Shard& shard = shardFor(key);
+        uint64_t victim = 0;
+        if (!makeRoom(shard, key, now_ms, victim)) {
+            evicted.push_back(key);
+            continue;
+        }
+        if (victim != 0) {
+            evicted.push_back(victim);
+            --loaded;
+        }
+        bool inserted = false;
+        SessionEntry& entry = shard.sessions.insert(key, inserted);
+        if (!inserted) continue;
+        entry.touched_ms.store((now_ms - uint32_t(age_ms)) & ~SessionEntry::kReferenced, std::memory_order_relaxed);
+        entry.wheel_ms = entry.touched_ms.load(std::memory_order_relaxed) + timeout_ms;
+        shard.wheel.schedule(key, entry.wheel_ms);
+        accountMemory(shard);
+        ++loaded;
+    }
+
+    // Истекшие за время простоя закрываются так же, как при очистке
+    for (size_t i = 0; i < expired.size(); i += kDrainBatch) {
+        const size_t end = std::min(expired.size(), i + kDrainBatch);
+        writeCdrBatch(expired.data() + i, end - i, "timeout_remove");
+    }
+    // Сверх пределов max_sessions и памяти - как при вытеснении
+    for (size_t i = 0; i < evicted.size(); i += kDrainBatch) {
+        const size_t end = std::min(evicted.size(), i + kDrainBatch);
+        writeCdrBatch(evicted.data() + i, end - i, "capacity_evict");
+    }
+    m_evictions.fetch_add(evicted.size(), std::memory_order_relaxed);
+
+    m_snapshot_stats.loaded_sessions = loaded;
+    m_snapshot_stats.expired_on_load = expired.size();
+    m_snapshot_stats.load_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - started).count();
+    m_log->sendToLog("Sessions restored from snapshot: " + std::to_string(loaded) +
+                     " (expired while stopped: " + std::to_string(expired.size()) + ")");
+    spdlog::info("Sessions restored from snapshot {}: {} (expired while stopped: {}, downtime {} ms) in {:.1f} ms",
+                 m_snapshot_file, loaded, expired.size(), downtime_ms, m_snapshot_stats.load_ms);
+    if (!evicted.empty()) {
+        spdlog::warn("Session snapshot exceeds the session limits: {} session(s) closed as capacity_evict",
+                     evicted.size());
+    }
+}
+
+void SessionManager::startSnapshotTimer() {
+    if (m_snapshot_file.empty() || m_snapshot_interval_sec == 0) return;
+    {
+        std::lock_guard<std::mutex> lock(m_snapshot_mutex);
+        if (m_snapshot_running) return;
+        m_snapshot_running = true;
+    }
+    m_snapshot_thread = std::thread([this]() {
+        threadPlacement::apply("snapshot");
+        std::unique_lock<std::mutex> lock(m_snapshot_mutex);
+        while (true) {
+            m_snapshot_cv.wait_for(lock, std::chrono::seconds(m_snapshot_interval_sec),
+                                   [this]() { return !m_snapshot_running; });
+            if (!m_snapshot_running) break;
+            // saveSnapshot сам берет m_snapshot_mutex
+            lock.unlock();
+            try {
+                saveSnapshot();
+            } catch (const std::exception& e) {
+                spdlog::error("Session snapshot failed: {}", e.what());
+            }
+            lock.lock();
+        }
+    });
+}
+
+void SessionManager::stopSnapshotTimer() {
+    {
+        std::lock_guard<std::mutex> lock(m_snapshot_mutex);
+        m_snapshot_running = false;
+    }
+    m_snapshot_cv.notify_all();
+    if (m_snapshot_thread.joinable()) {
+        m_snapshot_thread.join();
+    }
+}
+
+SessionSnapshotStats SessionManager::getSnapshotStats() const {
+    std::lock_guard<std::mutex> lock(m_snapshot_mutex);
+    return m_snapshot_stats;
 }
 
 void SessionManager::addSession(const std::string& imsi) {
-    std::cout << "SessionManager::addSession:IMSI: " << imsi << std::endl;
-    m_sessions[imsi] = Session{
-        .created_at = std::chrono::system_clock::now(),
-        .active = true
-    };
+    const uint64_t key = imsiKey::pack(imsi);
+    if (key == 0) return;
+    Shard& shard = shardFor(key);
+    const uint32_t timeout_ms = m_policy->session_timeout_ms;
+    bool inserted = false;
+    uint64_t evicted = 0;
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        const uint32_t now_ms = nowMs();
+        if (!makeRoom(shard, key, now_ms, evicted)) {
+            m_capacity_rejects.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        inserted = touchSession(shard, key, now_ms, timeout_ms);
+        accountMemory(shard);
+        if (m_replication) replicateInsert(key, inserted, evicted);
+    }
+    if (evicted != 0) recordEvicted(evicted);
+    if (inserted) recordCreated(imsi);
+}
+
+void SessionManager::recordCreated(const std::string& imsi) {
     writeToCdr(imsi, "created");
-    m_log->sendToLog("Created: " + imsi);
-    spdlog::info("Session created for IMSI: {}", imsi);
+    if (m_log->isEnabled(LogLevel::Debug)) {
+        m_log->sendToLog(LogLevel::Debug, "Created: " + imsi);
+    }
+    spdlog::debug("Session created for IMSI: {}", imsi);
 }
 
 void SessionManager::removeSession(const std::string& imsi) {
-    if (m_sessions.erase(imsi)) {
+    const uint64_t key = imsiKey::pack(imsi);
+    if (key == 0) return;
+    Shard& shard = shardFor(key);
+    bool erased = false;
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        erased = shard.sessions.erase(key);
+        if (erased) {
+            if (m_replication) m_replication->record(SessionDeltaOp::Remove, key);
+            dropStaleTimers(shard, nowMs());
+            accountMemory(shard);
+        }
+    }
+    if (erased) {
         writeToCdr(imsi, "timeout_remove");
         m_log->sendToLog("Timeout remove IMSI: " + imsi);
     }
 }
 
 void SessionManager::writeToCdr(const std::string& imsi, const std::string& action) {
-    static std::mutex cdr_mutex;
-    std::lock_guard<std::mutex> lock(cdr_mutex);
-    const auto now = std::chrono::system_clock::now();
-    const std::time_t now_time = std::chrono::system_clock::to_time_t(now);
-    char timestamp[20];
-    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", std::localtime(&now_time));
+    const std::string_view timestamp = coarseClock::timestamp();
+    std::lock_guard<std::mutex> lock(m_cdr_mutex);
     m_cdr_file << timestamp << ", " << imsi << ", " << action << std::endl;
 }
 
+void SessionManager::writeCdrBatch(const uint64_t* keys, size_t count, const char* action) {
+    const std::string_view timestamp = coarseClock::timestamp();
+    const size_t action_length = std::strlen(action);
+    // Строки пакета собираются в буфер потока: его емкость переиспользуется
+    thread_local std::string lines;
+    lines.clear();
+    lines.reserve(count * (timestamp.size() + imsiKey::kMaxDigits + action_length + 5));
+    char digits[imsiKey::kMaxDigits];
+    for (const uint64_t* key_it = keys; key_it != keys + count; ++key_it) {
+        const uint64_t key = *key_it;
+        lines.append(timestamp).append(", ");
+        lines.append(digits, imsiKey::unpack(key, digits)).append(", ");
+        lines.append(action, action_length).push_back('\n');
+    }
+    std::lock_guard<std::mutex> lock(m_cdr_mutex);
+    m_cdr_file.write(lines.data(), std::streamsize(lines.size()));
+    m_cdr_file.flush();
+}
+
 bool SessionManager::isBlacklisted(const std::string& imsi) const {
-    return std::find(m_blacklist.begin(), m_blacklist.end(), imsi) != m_blacklist.end();
+    return isBlacklisted(std::string_view(imsi));
+}
+
+bool SessionManager::isBlacklisted(std::string_view imsi) const {
+    return m_policy->blacklist.contains(imsi);
+}
+
+BlacklistStats SessionManager::getBlacklistStats() const {
+    return m_policy->blacklist.getStats();
+}
+
+uint32_t SessionManager::getSessionTimeoutMs() const {
+    return m_policy->session_timeout_ms;
+}
+
+void SessionManager::setReplicationLog(std::shared_ptr<ReplicationLog> log) {
+    m_replication = std::move(log);
+}
+
+void SessionManager::applyReplicaDeltas(const SessionDelta* deltas, size_t count) {
+    if (m_shutting_down) return;
+    const uint32_t timeout_ms = m_policy->session_timeout_ms;
+    for (const SessionDelta* delta = deltas; delta != deltas + count; ++delta) {
+        Shard& shard = shardFor(delta->key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        if (delta->op == SessionDeltaOp::Remove) {
+            if (shard.sessions.erase(delta->key)) {
+                dropStaleTimers(shard, nowMs());
+                accountMemory(shard);
+            }
+            continue;
+        }
+        // Создание и продление одинаковы: сессия есть и активна сейчас
+        const uint32_t now_ms = nowMs();
+        uint64_t evicted = 0;
+        if (!makeRoom(shard, delta->key, now_ms, evicted)) {
+            m_capacity_rejects.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        if (evicted != 0) m_evictions.fetch_add(1, std::memory_order_relaxed);
+        touchSession(shard, delta->key, now_ms, timeout_ms);
+        accountMemory(shard);
+    }
+}
+
+size_t SessionManager::applyReplicaSnapshot(const SessionSnapshot& snapshot) {
+    const uint32_t timeout_ms = m_policy->session_timeout_ms;
+    // Записи раскладываются по шардам заранее: каждый шард строится без блокировки
+    // и заменяется целиком под своей. Возраст не проверяется: открытость сессии решает основной
+    std::vector<std::vector<uint32_t>> by_shard(m_shard_mask + 1);
+    for (size_t i = 0; i < snapshot.size(); ++i) {
+        const uint64_t key = snapshot.key(i);
+        if (key == 0) continue;
+        by_shard[SessionTable::hash(key) & m_shard_mask].push_back(uint32_t(i));
+    }
+
+    size_t loaded = 0;
+    for (size_t i = 0; i <= m_shard_mask; ++i) {
+        const std::vector<uint32_t>& indices = by_shard[i];
+        Shard& shard = m_shards[i];
+        size_t expected = indices.size();
+        uint32_t tick_ms = 0;
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            expected = std::max<size_t>(expected, m_shard_session_limit);
+            tick_ms = shard.wheel.tickMs();
+        }
+        const uint32_t now_ms = nowMs();
+        SessionTable sessions(expected, m_huge_pages);
+        TimerWheel wheel(tick_ms, now_ms);
+        for (uint32_t index : indices) {
+            if (m_shard_session_limit > 0 && sessions.size() >= m_shard_session_limit) break;
+            bool inserted = false;
+            SessionEntry& entry = sessions.insert(snapshot.key(index), inserted);
+            entry.touched_ms.store((now_ms - snapshot.ageMs(index)) & ~SessionEntry::kReferenced,
+                                   std::memory_order_relaxed);
+            entry.wheel_ms = entry.touched_ms.load(std::memory_order_relaxed) + timeout_ms;
+            wheel.schedule(entry.key, entry.wheel_ms);
+        }
+        loaded += sessions.size();
+
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        std::swap(shard.sessions, sessions);
+        std::swap(shard.wheel, wheel);
+        accountMemory(shard);
+    }
+    return loaded;
+}
+
+void SessionManager::setReplicaMode(bool replica, uint32_t grace_ms) {
+    m_replica_grace_ms.store(replica ? grace_ms : 0, std::memory_order_relaxed);
+    m_replica.store(replica, std::memory_order_relaxed);
+}
+
+bool SessionManager::isReplica() const {
+    return m_replica.load(std::memory_order_relaxed);
+}
+
+void SessionManager::reload(const SessionManagerConfig& config) {
+    // Файл черного списка читается здесь, в потоке перезагрузки; запросы видят прежний снимок
+    auto policy = std::make_shared<const SessionPolicy>(config);
+    const uint32_t previous_timeout_ms = m_policy->session_timeout_ms;
+    const uint32_t timeout_ms = policy->session_timeout_ms;
+    const BlacklistStats stats = policy->blacklist.getStats();
+    m_policy.publish(std::move(policy));
+    m_drain_rate = drainRate(config);
+
+    // Сессии в колесе досрочно не переставляются: при уменьшении таймаута
+    // они истекают не позже прежнего срока, новые и продленные - по новому
+    m_log->sendToLog("Session settings reloaded: timeout " + std::to_string(previous_timeout_ms) +
+                     " -> " + std::to_string(timeout_ms) + " ms, blacklist " +
+                     std::to_string(stats.entries) + " IMSI, " +
+                     std::to_string(stats.prefix_rules + stats.range_rules) + " rule(s)");
+    spdlog::info("Session settings reloaded: timeout {} -> {} ms, blacklist {} IMSI, {} rule(s) in {:.1f} ms",
+                 previous_timeout_ms, timeout_ms, stats.entries,
+                 stats.prefix_rules + stats.range_rules, stats.load_ms);
 }
 
 void SessionManager::cleanupExpiredSessions() {
-    auto now = std::chrono::system_clock::now();
-    std::lock_guard<std::mutex> lock(m_mutex);
-    
-    for (auto it = m_sessions.begin(); it != m_sessions.end(); ) {
-        auto duration = std::chrono::duration_cast<std::chrono::seconds>(
-            now - it->second.created_at).count();
-            
-        if (duration > m_session_timeout_sec) {
-            writeToCdr(it->first, "timeout_remove"); 
-            m_log->sendToLog("Timeout remove IMSI: " + it->first);
-            it = m_sessions.erase(it);
-        } else {
-            ++it;
+    // Буфер потока очистки переживает проходы: в установившемся режиме память не выделяется
+    thread_local std::vector<uint64_t> expired;
+    size_t removed = 0;
+    // По одному шарду: запросы к остальным шардам обслуживаются без ожидания
+    for (size_t i = 0; i <= m_shard_mask; ++i) {
+        expired.clear();
+        cleanupShard(m_shards[i], nowMs(), expired);
+        removed += expired.size();
+    }
+    if (removed > 0) {
+        m_log->sendToLog("Timeout remove: " + std::to_string(removed) + " session(s)");
+    }
+}
+
+void SessionManager::cleanupShard(Shard& shard, uint32_t now_ms, std::vector<uint64_t>& expired) {
+    // Резервный сервер ждет удаления от основного дольше его таймаута
+    const uint32_t timeout_ms = m_policy->session_timeout_ms + m_replica_grace_ms.load(std::memory_order_relaxed);
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        // Разности по модулю 2^32 верны, пока таймаут меньше 24 суток
+        shard.wheel.advance(now_ms,
+            [&](uint64_t key, uint32_t tick_ms) {
+                SessionEntry* entry = shard.sessions.find(key);
+                // Сессия удалена или стоит в колесе на более поздний срок - запись устарела
+                if (!entry || int32_t(entry->wheel_ms - tick_ms) > 0) return;
+                const uint32_t deadline_ms = entry->touched_ms.load(std::memory_order_relaxed) + timeout_ms;
+                if (int32_t(deadline_ms - tick_ms) <= 0) {
+                    expired.push_back(key);
+                    shard.sessions.erase(key);
+                    if (m_replication) m_replication->record(SessionDeltaOp::Remove, key);
+                    return;
+                }
+                // Сессию продлевали - переставляем на новый срок
+                entry->wheel_ms = deadline_ms;
+                shard.wheel.schedule(key, deadline_ms);
+            },
+            [&](uint64_t key, uint32_t& deadline_ms) {
+                const SessionEntry* entry = shard.sessions.find(key);
+                if (!entry) return false;
+                deadline_ms = entry->wheel_ms;
+                return true;
+            });
+        accountMemory(shard);
+    }
+    // CDR и лог пишутся уже без блокировки шарда, CDR - пакетами
+    for (size_t i = 0; i < expired.size(); i += kDrainBatch) {
+        const size_t end = std::min(expired.size(), i + kDrainBatch);
+        writeCdrBatch(expired.data() + i, end - i, "timeout_remove");
+    }
+    if (m_log->isEnabled(LogLevel::Debug)) {
+        char digits[imsiKey::kMaxDigits];
+        for (uint64_t key : expired) {
+            m_log->sendToLog(LogLevel::Debug, "Timeout remove IMSI: " +
+                             std::string(digits, imsiKey::unpack(key, digits)));
         }
     }
 }
 
+SessionStats SessionManager::getStats() const {
+    SessionStats stats;
+    stats.shards = m_shard_mask + 1;
+    for (size_t i = 0; i <= m_shard_mask; ++i) {
+        std::shared_lock<std::shared_mutex> lock(m_shards[i].mutex);
+        const SessionTable& table = m_shards[i].sessions;
+        stats.sessions += table.size();
+        stats.max_shard_sessions = std::max<uint64_t>(stats.max_shard_sessions, table.size());
+        stats.capacity += table.capacity();
+        stats.memory_bytes += table.memoryBytes();
+        stats.timer_records += m_shards[i].wheel.size();
+    }
+    stats.accounted_bytes = m_memory_bytes.load(std::memory_order_relaxed);
+    stats.session_limit = m_session_limit;
+    stats.memory_limit_bytes = m_memory_limit;
+    stats.capacity_policy = m_capacity_policy == CapacityPolicy::Evict ? "evict" : "reject";
+    stats.evictions = m_evictions.load(std::memory_order_relaxed);
+    stats.timer_compactions = m_timer_compactions.load(std::memory_order_relaxed);
+    stats.capacity_rejects = m_capacity_rejects.load(std::memory_order_relaxed);
+    stats.huge_pages = m_huge_pages;
+    return stats;
+}
+
 std::string SessionManager::validImsi(const std::string& raw_imsi) const {
     std::string clean_imsi;
     std::copy_if(raw_imsi.begin(), raw_imsi.end(), 
@@ -2,17 +2,104 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <shared_mutex>
+#include <nlohmann/json.hpp>
 #include "ISessionManager.h"
+#include "Blacklist.h"
+#include "ReplicationLog.h"
+#include "Snapshot.h"
+#include "SessionSnapshot.h"
+#include "SessionTable.h"
+#include "TimerWheel.h"
 
-struct Session {
-    std::chrono::system_clock::time_point created_at;
-    bool active;
+// Что делать с новой сессией, когда шард заполнен
+enum class CapacityPolicy {
+    Reject,     // Отказ "rejected (capacity)"
+    Evict       // Вытеснить давно не продлевавшуюся сессию (CDR "capacity_evict")
 };
 
+CapacityPolicy parseCapacityPolicy(const std::string& name);
+
+// Настройки менеджера сессий
+struct SessionManagerConfig {
+    uint16_t session_timeout_sec = 30;
+    uint32_t session_timeout_ms = 0;        // Таймаут в мс (если задан, вместо session_timeout_sec)
+    uint16_t graceful_shutdown_rate = 10;   // Пауза между удалениями при остановке, мс (если drain_rate = 0)
+    uint32_t drain_rate = 0;                // Скорость выгрузки сессий при остановке, сессий/с
+    std::string cdr_file = "cdr.log";
+    std::vector<std::string> blacklist;
+    std::string blacklist_file;             // Внешний черный список (текст или бинарный образ)
+    uint32_t shards = 16;                   // Число шардов таблицы (округляется до степени двойки)
+    uint64_t max_sessions = 0;              // Предел числа сессий (0 - нет); таблицы выделяются под него сразу
+    uint64_t memory_limit_bytes = 0;        // Предел памяти таблиц и колес таймеров (0 - нет)
+    CapacityPolicy capacity_policy = CapacityPolicy::Reject;
+    bool huge_pages = false;                // Таблицы от 2 MiB на прозрачных huge pages
+    uint32_t cleanup_interval_ms = 1000;    // Период потока очистки (startCleanupTimer)
+    uint32_t timer_tick_ms = 10;            // Шаг колеса таймеров (точность срока сессии)
+    std::string snapshot_file;              // Снимок таблицы для теплого перезапуска (пусто - выключено)
+    uint32_t snapshot_interval_sec = 60;    // Период фоновой записи снимка (0 - только при остановке)
+    bool snapshot_load = true;              // Восстановить неистекшие сессии из снимка при запуске
+};
+
+// Настройки, которые меняются перезагрузкой без перезапуска (SessionManager::reload)
+struct SessionPolicy {
+    uint32_t session_timeout_ms;
+    Blacklist blacklist;
+
+    explicit SessionPolicy(const SessionManagerConfig& config);
+};
+
+// Заполнение таблицы сессий по шардам
+struct SessionStats {
+    uint64_t sessions = 0;
+    uint64_t shards = 0;
+    uint64_t max_shard_sessions = 0;        // Самый заполненный шард (перекос хэша)
+    uint64_t capacity = 0;                  // Записей выделено во всех шардах
+    uint64_t memory_bytes = 0;              // Память таблиц сессий
+    uint64_t timer_records = 0;             // Записей в колесах таймеров (включая устаревшие)
+    uint64_t accounted_bytes = 0;           // Учтенная память: таблицы и записи колес (без блокировок)
+    uint64_t session_limit = 0;             // max_sessions (0 - без предела)
+    uint64_t memory_limit_bytes = 0;
+    std::string capacity_policy;
+    uint64_t evictions = 0;                 // Вытеснено при заполнении (CDR "capacity_evict")
+    uint64_t timer_compactions = 0;         // Перестроек колес от устаревших записей
+    uint64_t capacity_rejects = 0;          // Отказано при заполнении
+    bool huge_pages = false;
+};
+
+void to_json(nlohmann::json& j, const SessionStats& stats);
+
+// Ход выгрузки сессий при остановке (SessionManager::startDrain)
+struct DrainStats {
+    std::string state = "idle";             // idle, snapshot, draining, done
+    uint32_t rate = 0;                      // Целевая скорость, сессий/с (0 - без ограничения)
+    uint64_t total = 0;                     // Сессий в начале выгрузки
+    uint64_t drained = 0;
+    uint64_t remaining = 0;
+    uint64_t batches = 0;                   // Пакетов: одна блокировка шарда и одна запись CDR на пакет
+    double elapsed_ms = 0.0;
+    double actual_rate = 0.0;               // Фактическая скорость, сессий/с
+    double eta_sec = 0.0;
+};
+
+void to_json(nlohmann::json& j, const DrainStats& stats);
+
+// Таблица сессий разбита на шарды со своими блокировками; шард выбирается по хэшу IMSI.
+// Со снимком (snapshot_file) остановка сохраняет сессии в файл вместо поочередного удаления,
+// а запуск восстанавливает неистекшие - без CDR "created" для каждого абонента.
+// Без снимка остановка выгружает сессии в фоне с заданной скоростью (startDrain),
+// а проверки сессий обслуживаются до конца выгрузки.
+// Предел числа сессий и памяти делится между шардами поровну и проверяется под блокировкой шарда.
+// Запросы к разным шардам не ждут друг друга, очистка блокирует один шард за раз.
+// Проверка и продление сессии берут блокировку шарда на чтение и не мешают друг другу;
+// исключительная блокировка нужна только для создания и удаления.
 class SessionManager : public ISessionManager {
 
 public:
 
+    SessionManager(const SessionManagerConfig& config, std::shared_ptr<Logger> log);
+
     SessionManager(
         const uint16_t& session_timeout_sec,
         const uint16_t& graceful_shutdown_rate,
@@ -23,52 +110,249 @@ public:
     
     ~SessionManager();
 
+    using ISessionManager::handleImsi;
+    using ISessionManager::isSessionActive;
+
+    // Максимальная длина IMSI в цифрах
+    static constexpr size_t kMaxImsiDigits = 15;
+
     // Обработка IMSI: создание/отклонение сессии
     std::string handleImsi(const std::string& raw_imsi) final;
 
+    SessionResult handleImsi(std::string_view raw_imsi) final;
+
+    bool refreshSession(std::string_view raw_imsi) final;
+
     // Проверка активности сессии
     bool isSessionActive(const std::string& imsi) const final;
 
+    bool isSessionActive(std::string_view imsi) const final;
+
     void startCleanupTimer() final;
     
     void stopCleanupTimer() final;
 
+    // startDrain и ожидание ее окончания
     void gracefulShutdown() final;
 
+    // Начать остановку: новые сессии не создаются, существующие сохраняются в снимок
+    // или удаляются в фоне пакетами не быстрее drain_rate с CDR "shutdown_remove".
+    // Повторный вызов ничего не делает
+    void startDrain();
+
+    // Дождаться окончания выгрузки (сразу, если она не начиналась)
+    void waitDrain();
+
+    DrainStats getDrainStats() const;
+
     void cleanupExpiredSessions() final;
 
+    SessionStats getStats() const;
+
+    BlacklistStats getBlacklistStats() const;
+
+    uint32_t getSessionTimeoutMs() const;
+
+    // Копия таблицы сессий; шарды копируются по одному под блокировкой на чтение
+    SessionSnapshot takeSnapshot() const;
+
+    // Записать снимок таблицы сессий (takeSnapshot), файл пишется без блокировок.
+    // Возвращает число сессий; std::runtime_error при ошибке записи
+    size_t saveSnapshot();
+
+    // Фоновая запись снимка раз в snapshot_interval_sec
+    void startSnapshotTimer();
+
+    void stopSnapshotTimer();
+
+    SessionSnapshotStats getSnapshotStats() const;
+
+    // Основной сервер: изменения таблицы дублируются в log для резервного.
+    // Задается до начала обработки запросов
+    void setReplicationLog(std::shared_ptr<ReplicationLog> log);
+
+    // Резервный сервер: применить изменения основного (без CDR и лога по каждой сессии)
+    void applyReplicaDeltas(const SessionDelta* deltas, size_t count);
+
+    // Резервный сервер: заменить таблицу снимком основного, шард за шардом.
+    // Возвращает число загруженных сессий
+    size_t applyReplicaSnapshot(const SessionSnapshot& snapshot);
+
+    // Пока есть связь с основным, его сессии закрывает он: свой срок истечения
+    // продлен на grace_ms, выгрузка при остановке не пишет CDR
+    void setReplicaMode(bool replica, uint32_t grace_ms = 0);
+
+    bool isReplica() const;
+
+    // Новые таймаут, черный список и скорость выгрузки из config (остальные поля не меняются).
+    // Строится вне горячего пути и публикуется атомарной заменой; при ошибке остаются прежние
+    void reload(const SessionManagerConfig& config);
+
 private:
 
+    // Сессий за одну блокировку шарда при выгрузке
+    static constexpr size_t kDrainBatch = 256;
+
+    enum class DrainState : uint8_t { Idle, Snapshot, Draining, Done };
+
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        SessionTable sessions;
+        TimerWheel wheel;                   // Сроки сессий шарда
+        size_t accounted_bytes = 0;         // Доля шарда в m_memory_bytes
+    };
+
+    // Байт на запись колеса таймеров
+    static constexpr size_t kTimerRecordBytes = sizeof(uint64_t);
+
+    // Устаревших записей колеса шарда сверх четверти живых сессий до перестройки
+    static constexpr size_t kStaleTimerSlack = 256;
+
+    // Найти или добавить сессию и отметить активность (под исключительной блокировкой шарда)
+    bool touchSession(Shard& shard, uint64_t key, uint32_t now_ms, uint32_t timeout_ms);
+
+    // Место для новой сессии key под исключительной блокировкой шарда. Шард заполнен:
+    // Evict вытесняет сессию (ее ключ в evicted), Reject - false
+    bool makeRoom(Shard& shard, uint64_t key, uint32_t now_ms, uint64_t& evicted);
+
+    // Пересчитать память шарда после изменения (под исключительной блокировкой)
+    void accountMemory(Shard& shard);
+
+    // Перестроить колесо шарда, если устаревших записей удаленных сессий стало много
+    void dropStaleTimers(Shard& shard, uint32_t now_ms);
+
+    // CDR и счетчик вытесненной сессии (вне блокировки шарда)
+    void recordEvicted(uint64_t key);
+
+    // Создание и вытеснение для резервного сервера (под блокировкой шарда)
+    void replicateInsert(uint64_t key, bool inserted, uint64_t evicted);
+
+    // Продлить существующую сессию под блокировкой на чтение; false - сессии нет
+    bool refreshExisting(Shard& shard, uint64_t key) const;
+
+    Shard& shardFor(uint64_t key) const;
+
+    // Мс от запуска менеджера (по модулю 2^32, как SessionEntry::touched_ms)
+    uint32_t nowMs() const;
+
+    // Удалить сессии, срок которых наступил, в одном шарде: O(просроченных); ключи - в expired
+    void cleanupShard(Shard& shard, uint32_t now_ms, std::vector<uint64_t>& expired);
+
+    // Поток выгрузки: token bucket на m_drain_rate, пакеты до kDrainBatch сессий
+    void drainSessions();
+
+    // Скорость выгрузки из настроек: drain_rate или пауза graceful_shutdown_rate
+    static uint32_t drainRate(const SessionManagerConfig& config);
+
+    // Восстановление из снимка при запуске (до начала обработки запросов)
+    void loadSnapshot();
+
+    // Время для снимка: мс от эпохи по системным часам
+    static uint64_t wallMs();
+
+    // CDR и лог о созданной сессии (вне блокировки шарда)
+    void recordCreated(const std::string& imsi);
+
     void addSession(const std::string& imsi) final;
 
     void removeSession(const std::string& imsi) final;
     
     void writeToCdr(const std::string& imsi, const std::string& action) final;
+
+    // Строки CDR для пакета сессий: одна метка времени, одна блокировка и один сброс на пакет
+    void writeCdrBatch(const uint64_t* keys, size_t count, const char* action);
     
     bool isBlacklisted(const std::string& imsi) const final;
 
+    bool isBlacklisted(std::string_view imsi) const;
+
+    // Цифры IMSI в буфер (прочие символы отбрасываются); 0 - IMSI некорректен
+    static size_t collectDigits(std::string_view raw_imsi, char* digits);
+
     std::string validImsi(const std::string& raw_imsi) const final;
 
     //Глобальные переменныые
 
-    std::unordered_map<std::string, Session> m_sessions;
-        
-    mutable std::mutex m_mutex;
+    std::unique_ptr<Shard[]> m_shards;
+
+    uint64_t m_epoch_ms;                    // Отсчет nowMs (coarseClock::monotonicMs)
+
+    size_t m_shard_mask = 0;
+
+    uint64_t m_session_limit = 0;
+
+    uint64_t m_memory_limit = 0;
+
+    uint64_t m_shard_session_limit = 0;     // Доли пределов на шард (0 - без предела)
+
+    uint64_t m_shard_memory_limit = 0;
+
+    CapacityPolicy m_capacity_policy = CapacityPolicy::Reject;
+
+    bool m_huge_pages = false;
+
+    std::atomic<uint64_t> m_memory_bytes{0};
+
+    std::atomic<uint64_t> m_evictions{0};
+
+    std::atomic<uint64_t> m_timer_compactions{0};
+
+    std::atomic<uint64_t> m_capacity_rejects{0};
+
+    std::shared_ptr<ReplicationLog> m_replication;  // Основной сервер: изменения для резервного
+
+    std::atomic<bool> m_replica{false};
+
+    std::atomic<uint32_t> m_replica_grace_ms{0};
     
     std::atomic<bool> m_shutting_down;
     
-    uint16_t m_session_timeout_sec;
+    uint32_t m_cleanup_interval_ms;
 
-    uint16_t m_graceful_shutdown_rate;
+    std::atomic<uint32_t> m_drain_rate;     // Меняется перезагрузкой и во время выгрузки
     
     std::ofstream m_cdr_file;
+
+    std::mutex m_cdr_mutex;
     
-    std::vector<std::string> m_blacklist;
+    SnapshotSlot<SessionPolicy> m_policy;   // Таймаут и черный список
     
     std::shared_ptr<Logger> m_log;
 
     std::atomic<bool> m_cleanup_running;
     
     std::thread m_cleanup_thread;
+
+    std::string m_snapshot_file;
+
+    uint32_t m_snapshot_interval_sec;
+
+    mutable std::mutex m_snapshot_mutex;    // Одна запись снимка за раз; статистика и ожидание потока
+
+    std::condition_variable m_snapshot_cv;
+
+    bool m_snapshot_running = false;
+
+    std::thread m_snapshot_thread;
+
+    SessionSnapshotStats m_snapshot_stats;
+
+    mutable std::mutex m_drain_mutex;       // Запуск выгрузки, ее итог и время
+
+    std::condition_variable m_drain_cv;
+
+    std::atomic<DrainState> m_drain_state{DrainState::Idle};
+
+    std::atomic<uint64_t> m_drained{0};
+
+    std::atomic<uint64_t> m_drain_batches{0};
+
+    uint64_t m_drain_total = 0;
+
+    std::chrono::steady_clock::time_point m_drain_started;
+
+    std::chrono::steady_clock::time_point m_drain_finished;
+
+    std::thread m_drain_thread;
     
 };
@@ -0,0 +1,517 @@
+//SessionReplicator.cpp
+
+#include "SessionReplicator.h"
+#include "../Clock.h"
+#include "../ThreadPlacement.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+    // Кадр: kMagic, тип, 3 байта резерва, длина данных (uint32), данные
+    constexpr char kMagic[4] = {'P', 'G', 'W', 'R'};
+    constexpr size_t kFrameHeaderSize = 12;
+    constexpr size_t kMaxPayload = size_t(64) << 10;
+
+    enum FrameType : uint8_t {
+        SnapshotBegin = 1,      // uint64 число сессий
+        SnapshotRecords = 2,    // записи SessionSnapshot
+        SnapshotEnd = 3,        // uint64 номер следующего изменения
+        Deltas = 4,             // uint64 номер первого изменения, записи kDeltaSize
+        Heartbeat = 5           // uint64 номер следующего изменения
+    };
+
+    // Изменение: операция и упакованный IMSI
+    constexpr size_t kDeltaSize = 1 + sizeof(uint64_t);
+    constexpr size_t kMaxDeltasPerFrame = (kMaxPayload - sizeof(uint64_t)) / kDeltaSize;
+    constexpr size_t kSnapshotChunk = kMaxPayload / SessionSnapshot::kRecordSize * SessionSnapshot::kRecordSize;
+    // Заранее под снимок резервируется не больше записей; дальше буфер растет по мере приема
+    constexpr uint64_t kSnapshotReserveLimit = uint64_t(1) << 20;
+
+    void startFrame(std::vector<char>& frame, FrameType type) {
+        frame.assign(kFrameHeaderSize, 0);
+        std::memcpy(frame.data(), kMagic, sizeof(kMagic));
+        frame[sizeof(kMagic)] = char(type);
+    }
+
+    void appendU64(std::vector<char>& frame, uint64_t value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        frame.insert(frame.end(), bytes, bytes + sizeof(value));
+    }
+
+    uint64_t readU64(const char* data) {
+        uint64_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    bool sendAll(int fd, const char* data, size_t size) {
+        while (size > 0) {
+            const ssize_t sent = ::send(fd, data, size, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += sent;
+            size -= size_t(sent);
+        }
+        return true;
+    }
+
+    bool sendFrame(int fd, std::vector<char>& frame) {
+        const uint32_t length = uint32_t(frame.size() - kFrameHeaderSize);
+        std::memcpy(frame.data() + sizeof(kMagic) + 4, &length, sizeof(length));
+        return sendAll(fd, frame.data(), frame.size());
+    }
+
+    // false - соединение закрыто, таймаут чтения или ошибка
+    bool readAll(int fd, char* data, size_t size) {
+        while (size > 0) {
+            const ssize_t got = ::recv(fd, data, size, 0);
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) return false;
+            data += got;
+            size -= size_t(got);
+        }
+        return true;
+    }
+
+    timeval toTimeval(uint32_t ms) {
+        timeval tv{};
+        tv.tv_sec = ms / 1000;
+        tv.tv_usec = (ms % 1000) * 1000;
+        return tv;
+    }
+
+    sockaddr_in toAddress(const std::string& ip, uint16_t port) {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        if (inet_pton(AF_INET, ip.c_str(), &addr.sin_addr) != 1) {
+            throw std::invalid_argument("Invalid replication address: " + ip);
+        }
+        return addr;
+    }
+
+}
+
+ReplicationRole parseReplicationRole(const std::string& name) {
+    if (name == "off") return ReplicationRole::Off;
+    if (name == "primary") return ReplicationRole::Primary;
+    if (name == "standby") return ReplicationRole::Standby;
+    throw std::invalid_argument("Unknown replication role: " + name);
+}
+
+void to_json(nlohmann::json& j, const ReplicationStats& stats) {
+    j = nlohmann::json{
+        {"role", stats.role},
+        {"peer", stats.peer},
+        {"connected", stats.connected},
+        {"next_seq", stats.next_seq},
+        {"deltas", stats.deltas},
+        {"batches", stats.batches},
+        {"bytes", stats.bytes},
+        {"snapshots", stats.snapshots},
+        {"snapshot_sessions", stats.snapshot_sessions},
+        {"snapshot_ms", stats.snapshot_ms},
+        {"connects", stats.connects},
+        {"queue_depth", stats.queue_depth},
+        {"queue_capacity", stats.queue_capacity},
+        {"dropped", stats.dropped},
+        {"resyncs", stats.resyncs}
+    };
+}
+
+SessionReplicator::SessionReplicator(const ReplicationConfig& config, std::shared_ptr<SessionManager> manager)
+: m_config(config), m_manager(std::move(manager)) {
+    if (m_config.role == ReplicationRole::Off) {
+        throw std::invalid_argument("Replication role is off");
+    }
+    const sockaddr_in addr = toAddress(m_config.ip, m_config.port);
+    m_frame.reserve(kFrameHeaderSize + kMaxPayload);
+    m_port = m_config.port;
+    if (m_config.role == ReplicationRole::Standby) return;
+
+    m_listen_fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_listen_fd < 0) {
+        throw std::runtime_error("Failed to create replication socket: " + std::string(std::strerror(errno)));
+    }
+    int one = 1;
+    setsockopt(m_listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (::bind(m_listen_fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(m_listen_fd, 1) != 0) {
+        const std::string error = std::strerror(errno);
+        ::close(m_listen_fd);
+        throw std::runtime_error("Failed to listen for standby on " +
+                                 endpoint(m_config.ip, m_config.port) + ": " + error);
+    }
+    sockaddr_in bound{};
+    socklen_t length = sizeof(bound);
+    getsockname(m_listen_fd, reinterpret_cast<sockaddr*>(&bound), &length);
+    m_port = ntohs(bound.sin_port);
+
+    // Очередь подключается сразу: изменения до start отбрасываются, их покроет снимок
+    m_log = std::make_shared<ReplicationLog>(m_config.queue_size, m_config.refresh_ms);
+    m_manager->setReplicationLog(m_log);
+}
+
+SessionReplicator::~SessionReplicator() {
+    stop();
+    if (m_listen_fd >= 0) ::close(m_listen_fd);
+}
+
+std::string SessionReplicator::endpoint(const std::string& ip, uint16_t port) {
+    return ip + ":" + std::to_string(port);
+}
+
+void SessionReplicator::start() {
+    if (m_running.exchange(true)) return;
+    if (m_config.role == ReplicationRole::Primary) {
+        spdlog::info("Replication: primary listening for standby on {}", endpoint(m_config.ip, m_port));
+        m_thread = std::thread(&SessionReplicator::runPrimary, this);
+    } else {
+        spdlog::info("Replication: standby of primary {}", endpoint(m_config.ip, m_port));
+        m_thread = std::thread(&SessionReplicator::runStandby, this);
+    }
+}
+
+void SessionReplicator::stop() {
+    if (!m_running.exchange(false)) return;
+    {
+        // Резервный ждет кадров в recv - разбудить
+        std::lock_guard<std::mutex> lock(m_peer_mutex);
+        if (m_config.role == ReplicationRole::Standby && m_peer_fd >= 0) ::shutdown(m_peer_fd, SHUT_RDWR);
+    }
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void SessionReplicator::closePeer(const char* reason) {
+    std::lock_guard<std::mutex> lock(m_peer_mutex);
+    if (m_peer_fd < 0) return;
+    if (reason) spdlog::warn("Replication: {} ({})", reason, m_peer);
+    ::close(m_peer_fd);
+    m_peer_fd = -1;
+    m_connected = false;
+}
+
+void SessionReplicator::runPrimary() {
+    threadPlacement::apply("replication");
+    auto last_frame = std::chrono::steady_clock::now();
+    int timeout_ms = 0;
+    while (m_running) {
+        // Ошибка одного соединения (нехватка памяти под снимок и т.п.) не останавливает поток:
+        // соединение закрывается, резервный подключится снова и получит новый снимок
+        try {
+            // Ожидание подключения служит и паузой между пакетами
+            pollfd listen_poll{m_listen_fd, POLLIN, 0};
+            if (::poll(&listen_poll, 1, timeout_ms) > 0 && (listen_poll.revents & POLLIN)) {
+                acceptStandby();
+                last_frame = std::chrono::steady_clock::now();
+            }
+            timeout_ms = int(m_config.batch_ms);
+
+            // Поток репликации единственный, кто меняет m_peer_fd основного
+            const int fd = m_peer_fd;
+            if (fd < 0) {
+                // Без резервного изменения не копятся: их покроет снимок при подключении
+                SessionDelta delta;
+                while (m_log->tryPop(delta)) {}
+                m_log->takeOverflow();
+                continue;
+            }
+            if (m_log->takeOverflow()) {
+                ++m_resyncs;
+                closePeer("change queue overflow, standby will catch up from a snapshot");
+                continue;
+            }
+            size_t sent = 0;
+            if (!sendDeltas(fd, sent)) {
+                closePeer("standby connection lost");
+                continue;
+            }
+            const auto now = std::chrono::steady_clock::now();
+            if (sent > 0) {
+                last_frame = now;
+            } else if (now - last_frame >= std::chrono::milliseconds(m_config.heartbeat_ms)) {
+                startFrame(m_frame, Heartbeat);
+                appendU64(m_frame, m_next_seq);
+                if (!sendCurrentFrame(fd)) closePeer("standby connection lost");
+                last_frame = now;
+            }
+        } catch (const std::exception& e) {
+            ++m_resyncs;
+            spdlog::error("Replication: {}", e.what());
+            closePeer("standby connection closed after an error");
+        }
+    }
+
+    // Остановка: изменения выгрузки сессий уходят резервному до закрытия соединения
+    if (m_peer_fd >= 0) {
+        size_t sent = 0;
+        sendDeltas(m_peer_fd, sent);
+        closePeer(nullptr);
+    }
+}
+
+void SessionReplicator::acceptStandby() {
+    sockaddr_in addr{};
+    socklen_t length = sizeof(addr);
+    const int fd = ::accept4(m_listen_fd, reinterpret_cast<sockaddr*>(&addr), &length, SOCK_CLOEXEC);
+    if (fd < 0) return;
+    // Новый резервный заменяет прежний: тот мог перезапуститься, не закрыв соединение
+    closePeer("replaced by a new standby connection");
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    // Зависший резервный не держит поток репликации дольше трех интервалов heartbeat
+    const timeval send_timeout = toTimeval(m_config.heartbeat_ms * 3);
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+    char ip[INET_ADDRSTRLEN] = {};
+    inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+    {
+        std::lock_guard<std::mutex> lock(m_peer_mutex);
+        m_peer_fd = fd;
+        m_peer = endpoint(ip, ntohs(addr.sin_port));
+    }
+    ++m_connects;
+    if (!sendSnapshot(fd)) {
+        closePeer("standby connection lost during snapshot");
+        return;
+    }
+    m_connected = true;
+    spdlog::info("Replication: standby {} connected, snapshot of {} session(s) sent in {:.1f} ms",
+                 m_peer, m_snapshot_sessions.load(), m_snapshot_ms.load());
+}
+
+bool SessionReplicator::sendCurrentFrame(int fd) {
+    if (!sendFrame(fd, m_frame)) return false;
+    m_bytes += m_frame.size();
+    return true;
+}
+
+bool SessionReplicator::sendSnapshot(int fd) {
+    const auto started = std::chrono::steady_clock::now();
+    // Изменения, уже стоящие в очереди, пойдут после снимка с номера m_next_seq
+    const SessionSnapshot snapshot = m_manager->takeSnapshot();
+    startFrame(m_frame, SnapshotBegin);
+    appendU64(m_frame, snapshot.size());
+    if (!sendCurrentFrame(fd)) return false;
+    for (size_t offset = 0; offset < snapshot.recordBytes(); offset += kSnapshotChunk) {
+        const size_t size = std::min(kSnapshotChunk, snapshot.recordBytes() - offset);
+        startFrame(m_frame, SnapshotRecords);
+        m_frame.insert(m_frame.end(), snapshot.records() + offset, snapshot.records() + offset + size);
+        if (!sendCurrentFrame(fd)) return false;
+    }
+    startFrame(m_frame, SnapshotEnd);
+    appendU64(m_frame, m_next_seq);
+    if (!sendCurrentFrame(fd)) return false;
+
+    ++m_snapshots;
+    m_snapshot_sessions = snapshot.size();
+    m_snapshot_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    return true;
+}
+
+bool SessionReplicator::sendDeltas(int fd, size_t& sent) {
+    sent = 0;
+    while (true) {
+        startFrame(m_frame, Deltas);
+        appendU64(m_frame, m_next_seq);
+        SessionDelta delta;
+        size_t count = 0;
+        while (count < kMaxDeltasPerFrame && m_log->tryPop(delta)) {
+            m_frame.push_back(char(delta.op));
+            appendU64(m_frame, delta.key);
+            ++count;
+        }
+        if (count == 0) return true;
+        if (!sendCurrentFrame(fd)) return false;
+        m_next_seq += count;
+        sent += count;
+        m_published_seq = m_next_seq;
+        m_delta_count += count;
+        ++m_batches;
+        if (count < kMaxDeltasPerFrame) return true;
+    }
+}
+
+void SessionReplicator::runStandby() {
+    threadPlacement::apply("replication");
+    const sockaddr_in addr = toAddress(m_config.ip, m_config.port);
+    while (m_running) {
+        const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0) {
+            // SO_SNDTIMEO ограничивает и connect; чтение ждет не дольше трех интервалов heartbeat
+            const timeval connect_timeout = toTimeval(m_config.reconnect_ms);
+            const timeval read_timeout = toTimeval(m_config.heartbeat_ms * 3);
+            setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &connect_timeout, sizeof(connect_timeout));
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &read_timeout, sizeof(read_timeout));
+            {
+                std::lock_guard<std::mutex> lock(m_peer_mutex);
+                m_peer_fd = fd;
+                m_peer = endpoint(m_config.ip, m_config.port);
+            }
+            if (m_running && ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0) {
+                ++m_connects;
+                // Ошибка применения или нехватка памяти - переподключение с новым снимком
+                try {
+                    receiveFrames(fd);
+                } catch (const std::exception& e) {
+                    ++m_resyncs;
+                    spdlog::error("Replication: {} (primary {})", e.what(), m_peer);
+                }
+            }
+            closePeer(nullptr);
+        }
+        if (m_manager->isReplica()) {
+            // Основной недоступен: резервный обслуживает сессии сам
+            m_manager->setReplicaMode(false);
+            spdlog::warn("Replication: link to primary {} lost, standby now expires sessions on its own",
+                         endpoint(m_config.ip, m_config.port));
+        }
+        const auto retry_at = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_config.reconnect_ms);
+        while (m_running && std::chrono::steady_clock::now() < retry_at) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+}
+
+void SessionReplicator::receiveFrames(int fd) {
+    // Пока связь есть, свои сроки резервного длиннее: окно продлений и обнаружение разрыва
+    const uint32_t grace_ms = m_config.refresh_ms + m_config.heartbeat_ms * 3;
+    // Число сессий из кадра не больше своего предела: ошибочный основной не заставит
+    // выделить под снимок сколько угодно памяти
+    const uint64_t session_limit = m_manager->getStats().session_limit;
+    SessionSnapshot snapshot;
+    uint64_t snapshot_expected = 0;
+    bool in_snapshot = false;
+    auto snapshot_started = std::chrono::steady_clock::now();
+    char header[kFrameHeaderSize];
+    while (m_running) {
+        if (!readAll(fd, header, sizeof(header))) return;
+        uint32_t length = 0;
+        std::memcpy(&length, header + sizeof(kMagic) + 4, sizeof(length));
+        if (std::memcmp(header, kMagic, sizeof(kMagic)) != 0 || length > kMaxPayload) {
+            spdlog::error("Replication: malformed frame from primary {}", m_peer);
+            return;
+        }
+        m_frame.resize(length);
+        if (!readAll(fd, m_frame.data(), length)) return;
+        m_bytes += sizeof(header) + length;
+
+        const char* payload = m_frame.data();
+        const uint8_t type = uint8_t(header[sizeof(kMagic)]);
+        const bool has_seq = length >= sizeof(uint64_t);
+        switch (type) {
+            case SnapshotBegin:
+                if (!has_seq) return;
+                snapshot_expected = readU64(payload);
+                if (session_limit > 0 && snapshot_expected > session_limit) {
+                    spdlog::error("Replication: snapshot of {} session(s) from primary {} exceeds max_sessions {}",
+                                  snapshot_expected, m_peer, session_limit);
+                    return;
+                }
+                snapshot = SessionSnapshot(coarseClock::wallMs());
+                snapshot.reserve(size_t(std::min<uint64_t>(snapshot_expected, kSnapshotReserveLimit)));
+                in_snapshot = true;
+                snapshot_started = std::chrono::steady_clock::now();
+                break;
+            case SnapshotRecords:
+                if (!in_snapshot || length % SessionSnapshot::kRecordSize != 0 ||
+                    snapshot.size() + length / SessionSnapshot::kRecordSize > snapshot_expected) {
+                    return;
+                }
+                snapshot.addRecords(payload, length);
+                break;
+            case SnapshotEnd: {
+                if (!in_snapshot || !has_seq) return;
+                const size_t loaded = m_manager->applyReplicaSnapshot(snapshot);
+                m_manager->setReplicaMode(true, grace_ms);
+                m_next_seq = readU64(payload);
+                m_published_seq = m_next_seq;
+                in_snapshot = false;
+                ++m_snapshots;
+                m_snapshot_sessions = loaded;
+                m_snapshot_ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - snapshot_started).count();
+                m_connected = true;
+                spdlog::info("Replication: caught up with primary {} from a snapshot: {} session(s) in {:.1f} ms",
+                             m_peer, loaded, m_snapshot_ms.load());
+                snapshot = SessionSnapshot();
+                break;
+            }
+            case Deltas: {
+                if (!has_seq || (length - sizeof(uint64_t)) % kDeltaSize != 0) return;
+                const uint64_t first_seq = readU64(payload);
+                if (!m_connected || first_seq != m_next_seq) {
+                    ++m_resyncs;
+                    spdlog::warn("Replication: expected change {}, got {}; catching up from a new snapshot",
+                                 m_next_seq, first_seq);
+                    return;
+                }
+                const size_t count = (length - sizeof(uint64_t)) / kDeltaSize;
+                m_deltas.resize(count);
+                const char* record = payload + sizeof(uint64_t);
+                for (size_t i = 0; i < count; ++i, record += kDeltaSize) {
+                    const uint8_t op = uint8_t(record[0]);
+                    if (op < uint8_t(SessionDeltaOp::Create) || op > uint8_t(SessionDeltaOp::Remove)) return;
+                    m_deltas[i].op = SessionDeltaOp(op);
+                    m_deltas[i].key = readU64(record + 1);
+                }
+                m_manager->applyReplicaDeltas(m_deltas.data(), count);
+                m_next_seq += count;
+                m_published_seq = m_next_seq;
+                m_delta_count += count;
+                ++m_batches;
+                break;
+            }
+            case Heartbeat:
+                if (!has_seq) return;
+                if (m_connected && readU64(payload) != m_next_seq) {
+                    ++m_resyncs;
+                    spdlog::warn("Replication: primary is at change {}, standby at {}; catching up from a new snapshot",
+                                 readU64(payload), m_next_seq);
+                    return;
+                }
+                break;
+            default:
+                spdlog::error("Replication: unknown frame type {} from primary {}", type, m_peer);
+                return;
+        }
+    }
+}
+
+ReplicationStats SessionReplicator::getStats() const {
+    ReplicationStats stats;
+    stats.role = m_config.role == ReplicationRole::Primary ? "primary" : "standby";
+    {
+        std::lock_guard<std::mutex> lock(m_peer_mutex);
+        stats.peer = m_peer;
+    }
+    stats.connected = m_connected;
+    stats.next_seq = m_published_seq;
+    stats.deltas = m_delta_count;
+    stats.batches = m_batches;
+    stats.bytes = m_bytes;
+    stats.snapshots = m_snapshots;
+    stats.snapshot_sessions = m_snapshot_sessions;
+    stats.snapshot_ms = m_snapshot_ms;
+    stats.connects = m_connects;
+    stats.resyncs = m_resyncs;
+    if (m_log) {
+        stats.queue_depth = m_log->depth();
+        stats.queue_capacity = m_log->capacity();
+        stats.dropped = m_log->dropped();
+    }
+    return stats;
+}
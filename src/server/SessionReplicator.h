@@ -0,0 +1,155 @@
+//SessionReplicator.h
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "ReplicationLog.h"
+#include "SessionManager.h"
+
+// Роль сервера в паре основной/резервный
+enum class ReplicationRole {
+    Off,
+    Primary,    // Слушает ip:port и передает изменения таблицы сессий
+    Standby     // Подключается к основному ip:port и применяет их к своей таблице
+};
+
+ReplicationRole parseReplicationRole(const std::string& name);
+
+struct ReplicationConfig {
+    ReplicationRole role = ReplicationRole::Off;
+    std::string ip = "127.0.0.1";
+    uint16_t port = 9100;                   // 0 - любой свободный (основной, тесты)
+    size_t queue_size = 65536;              // Изменений в очереди основного до сброса на снимок
+    uint32_t batch_ms = 5;                  // Пауза потока передачи при пустой очереди
+    uint32_t refresh_ms = 1000;             // Окно передачи продлений одной сессии
+    uint32_t heartbeat_ms = 1000;           // Пустой кадр при отсутствии изменений
+    uint32_t reconnect_ms = 1000;           // Пауза перед повторным подключением резервного
+};
+
+struct ReplicationStats {
+    std::string role;
+    std::string peer;                       // Адрес резервного (у основного) или основного
+    bool connected = false;
+    uint64_t next_seq = 0;                  // Номер следующего изменения в потоке
+    uint64_t deltas = 0;                    // Переданных (основной) или примененных (резервный)
+    uint64_t batches = 0;
+    uint64_t bytes = 0;
+    uint64_t snapshots = 0;                 // Догонок по снимку
+    uint64_t snapshot_sessions = 0;         // Сессий в последнем снимке
+    double snapshot_ms = 0.0;
+    uint64_t connects = 0;
+    uint64_t queue_depth = 0;
+    uint64_t queue_capacity = 0;
+    uint64_t dropped = 0;                   // Не уместились в очередь (основной)
+    uint64_t resyncs = 0;                   // Соединение сброшено: переполнение или разрыв номеров
+};
+
+void to_json(nlohmann::json& j, const ReplicationStats& stats);
+
+// Репликация сессий основной -> резервный по TCP. Поток кадров: при подключении
+// снимок таблицы (SnapshotBegin, SnapshotRecords, SnapshotEnd с номером следующего изменения),
+// затем пакеты изменений с номерами (Deltas) и Heartbeat при простое.
+// Изменения, попавшие в очередь до снимка, повторяются после него: создание, продление
+// и удаление идемпотентны, а порядок по каждому ключу сохранен, так что итог совпадает.
+// Пропуск номера или переполнение очереди основного сбрасывают соединение,
+// и резервный догоняет по новому снимку. Потеря связи снимает с резервного режим
+// реплики: дальше он сам закрывает сессии по таймауту с CDR.
+class SessionReplicator {
+
+public:
+
+    SessionReplicator(const ReplicationConfig& config, std::shared_ptr<SessionManager> manager);
+
+    ~SessionReplicator();
+
+    SessionReplicator(const SessionReplicator&) = delete;
+
+    SessionReplicator& operator=(const SessionReplicator&) = delete;
+
+    void start();
+
+    // Основной отправляет накопленные изменения (выгрузку при остановке) и закрывает соединение
+    void stop();
+
+    ReplicationStats getStats() const;
+
+    // Порт, на котором слушает основной (после привязки к port 0)
+    uint16_t port() const { return m_port; }
+
+private:
+
+    // Основной: прием резервного, снимок, пакеты изменений
+    void runPrimary();
+
+    // Резервный: подключение, чтение кадров, переподключение
+    void runStandby();
+
+    void acceptStandby();
+
+    // Отправить m_frame с учетом в m_bytes
+    bool sendCurrentFrame(int fd);
+
+    bool sendSnapshot(int fd);
+
+    // Отправить изменения из очереди; false - соединение разорвано
+    bool sendDeltas(int fd, size_t& sent);
+
+    void closePeer(const char* reason);
+
+    // Кадры от основного до разрыва связи или остановки
+    void receiveFrames(int fd);
+
+    static std::string endpoint(const std::string& ip, uint16_t port);
+
+    ReplicationConfig m_config;
+
+    std::shared_ptr<SessionManager> m_manager;
+
+    std::shared_ptr<ReplicationLog> m_log;  // Основной: очередь изменений
+
+    int m_listen_fd = -1;
+
+    uint16_t m_port = 0;
+
+    mutable std::mutex m_peer_mutex;        // Сокет и адрес собеседника
+
+    int m_peer_fd = -1;
+
+    std::string m_peer;
+
+    std::atomic<bool> m_running{false};
+
+    std::thread m_thread;
+
+    std::vector<char> m_frame;              // Буфер кадра потока репликации
+
+    std::vector<SessionDelta> m_deltas;     // Резервный: разобранный пакет
+
+    uint64_t m_next_seq = 0;                // Основной - следующий номер, резервный - ожидаемый
+
+    std::atomic<uint64_t> m_published_seq{0};
+
+    std::atomic<bool> m_connected{false};
+
+    std::atomic<uint64_t> m_delta_count{0};
+
+    std::atomic<uint64_t> m_batches{0};
+
+    std::atomic<uint64_t> m_bytes{0};
+
+    std::atomic<uint64_t> m_snapshots{0};
+
+    std::atomic<uint64_t> m_snapshot_sessions{0};
+
+    std::atomic<double> m_snapshot_ms{0.0};
+
+    std::atomic<uint64_t> m_connects{0};
+
+    std::atomic<uint64_t> m_resyncs{0};
+};
@@ -0,0 +1,148 @@
+//SessionSnapshot.cpp
+
+#include "SessionSnapshot.h"
+#include "SessionTable.h"
+
+#include <cerrno>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+    std::string systemError(const std::string& what, const std::string& path) {
+        return what + " " + path + ": " + std::strerror(errno);
+    }
+
+    void writeAll(int fd, const char* data, size_t size, const std::string& path) {
+        while (size > 0) {
+            const ssize_t written = ::write(fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(systemError("Failed to write session snapshot", path));
+            }
+            data += written;
+            size -= size_t(written);
+        }
+    }
+
+}
+
+void to_json(nlohmann::json& j, const SessionSnapshotStats& stats) {
+    j = nlohmann::json{
+        {"writes", stats.writes},
+        {"write_failures", stats.write_failures},
+        {"last_sessions", stats.last_sessions},
+        {"last_bytes", stats.last_bytes},
+        {"last_write_ms", stats.last_write_ms},
+        {"loaded_sessions", stats.loaded_sessions},
+        {"expired_on_load", stats.expired_on_load},
+        {"load_ms", stats.load_ms},
+        {"file", stats.file}
+    };
+}
+
+SessionSnapshot::SessionSnapshot(uint64_t wall_ms) : m_wall_ms(wall_ms) {}
+
+uint64_t SessionSnapshot::checksum(const char* data, size_t size, uint64_t seed) {
+    uint64_t hash = seed ^ 0x9E3779B97F4A7C15ull;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 0xBF58476D1CE4E5B9ull;
+        hash ^= hash >> 29;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, data + i, size - i);
+    hash = (hash ^ tail ^ uint64_t(size)) * 0x94D049BB133111EBull;
+    return SessionTable::hash(hash);
+}
+
+size_t SessionSnapshot::save(const std::string& path) const {
+    char header[kHeaderSize];
+    const uint64_t count = size();
+    std::memcpy(header, kMagic, sizeof(kMagic));
+    std::memcpy(header + sizeof(kMagic), &m_wall_ms, sizeof(m_wall_ms));
+    std::memcpy(header + sizeof(kMagic) + sizeof(uint64_t), &count, sizeof(count));
+    const uint64_t sum = checksum(m_records.data(), m_records.size(),
+                                  checksum(header, sizeof(header)));
+
+    const std::string temp_path = path + ".tmp";
+    const int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error(systemError("Failed to create session snapshot", temp_path));
+    }
+    try {
+        writeAll(fd, header, sizeof(header), temp_path);
+        writeAll(fd, m_records.data(), m_records.size(), temp_path);
+        writeAll(fd, reinterpret_cast<const char*>(&sum), sizeof(sum), temp_path);
+        if (::fsync(fd) != 0) {
+            throw std::runtime_error(systemError("Failed to sync session snapshot", temp_path));
+        }
+    } catch (...) {
+        ::close(fd);
+        ::unlink(temp_path.c_str());
+        throw;
+    }
+    ::close(fd);
+    if (::rename(temp_path.c_str(), path.c_str()) != 0) {
+        ::unlink(temp_path.c_str());
+        throw std::runtime_error(systemError("Failed to replace session snapshot", path));
+    }
+    return sizeof(header) + m_records.size() + sizeof(sum);
+}
+
+SessionSnapshot SessionSnapshot::load(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error(systemError("Failed to open session snapshot", path));
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error(systemError("Failed to stat session snapshot", path));
+    }
+    const size_t file_size = size_t(st.st_size);
+    char header[kHeaderSize];
+    if (file_size < kHeaderSize + sizeof(uint64_t) ||
+        ::pread(fd, header, sizeof(header), 0) != ssize_t(sizeof(header)) ||
+        std::memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Not a session snapshot: " + path);
+    }
+    uint64_t wall_ms = 0;
+    uint64_t count = 0;
+    std::memcpy(&wall_ms, header + sizeof(kMagic), sizeof(wall_ms));
+    std::memcpy(&count, header + sizeof(kMagic) + sizeof(uint64_t), sizeof(count));
+    if (count > (file_size - kHeaderSize) / kRecordSize ||
+        file_size != kHeaderSize + count * kRecordSize + sizeof(uint64_t)) {
+        ::close(fd);
+        throw std::runtime_error("Corrupted session snapshot (size mismatch): " + path);
+    }
+
+    // Записи читаются одним буфером, без разбора по одной
+    SessionSnapshot snapshot(wall_ms);
+    snapshot.m_records.resize(size_t(count) * kRecordSize);
+    uint64_t stored_sum = 0;
+    size_t offset = 0;
+    while (offset < snapshot.m_records.size()) {
+        const ssize_t got = ::pread(fd, snapshot.m_records.data() + offset,
+                                    snapshot.m_records.size() - offset, off_t(kHeaderSize + offset));
+        if (got <= 0) {
+            if (got < 0 && errno == EINTR) continue;
+            ::close(fd);
+            throw std::runtime_error(systemError("Failed to read session snapshot", path));
+        }
+        offset += size_t(got);
+    }
+    const bool sum_read = ::pread(fd, &stored_sum, sizeof(stored_sum),
+                                  off_t(kHeaderSize + snapshot.m_records.size())) == ssize_t(sizeof(stored_sum));
+    ::close(fd);
+    if (!sum_read || stored_sum != checksum(snapshot.m_records.data(), snapshot.m_records.size(),
+                                            checksum(header, sizeof(header)))) {
+        throw std::runtime_error("Corrupted session snapshot (checksum mismatch): " + path);
+    }
+    return snapshot;
+}
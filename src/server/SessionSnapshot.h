@@ -0,0 +1,92 @@
+//SessionSnapshot.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+// Сохранение и загрузка снимков таблицы сессий
+struct SessionSnapshotStats {
+    uint64_t writes = 0;
+    uint64_t write_failures = 0;
+    uint64_t last_sessions = 0;         // Сессий в последнем снимке
+    uint64_t last_bytes = 0;
+    double last_write_ms = 0.0;
+    uint64_t loaded_sessions = 0;       // Восстановлено при запуске
+    uint64_t expired_on_load = 0;       // Истекли, пока сервер был остановлен
+    double load_ms = 0.0;
+    std::string file;
+};
+
+void to_json(nlohmann::json& j, const SessionSnapshotStats& stats);
+
+// Бинарный снимок таблицы сессий: заголовок (kMagic, время снимка, число записей),
+// записи по kRecordSize байт (упакованный IMSI, сколько мс назад была активность)
+// и контрольная сумма всего предшествующего. Возраст вместо метки времени делает
+// снимок независимым от монотонных часов процесса, который его записал.
+class SessionSnapshot {
+
+public:
+
+    static constexpr char kMagic[8] = {'P', 'G', 'W', 'S', 'E', 'S', 'S', '1'};
+
+    static constexpr size_t kHeaderSize = sizeof(kMagic) + 2 * sizeof(uint64_t);
+
+    static constexpr size_t kRecordSize = sizeof(uint64_t) + sizeof(uint32_t);
+
+    // wall_ms - время снимка (system_clock, мс от эпохи)
+    explicit SessionSnapshot(uint64_t wall_ms = 0);
+
+    void reserve(size_t records) { m_records.reserve(records * kRecordSize); }
+
+    void add(uint64_t key, uint32_t age_ms) {
+        const size_t offset = m_records.size();
+        m_records.resize(offset + kRecordSize);
+        std::memcpy(&m_records[offset], &key, sizeof(key));
+        std::memcpy(&m_records[offset + sizeof(key)], &age_ms, sizeof(age_ms));
+    }
+
+    // Записи целиком (передача снимка резервному серверу)
+    const char* records() const { return m_records.data(); }
+
+    size_t recordBytes() const { return m_records.size(); }
+
+    // Дописать готовые записи; bytes кратно kRecordSize
+    void addRecords(const char* data, size_t bytes) { m_records.insert(m_records.end(), data, data + bytes); }
+
+    size_t size() const { return m_records.size() / kRecordSize; }
+
+    uint64_t wallMs() const { return m_wall_ms; }
+
+    uint64_t key(size_t index) const {
+        uint64_t key;
+        std::memcpy(&key, &m_records[index * kRecordSize], sizeof(key));
+        return key;
+    }
+
+    uint32_t ageMs(size_t index) const {
+        uint32_t age_ms;
+        std::memcpy(&age_ms, &m_records[index * kRecordSize + sizeof(uint64_t)], sizeof(age_ms));
+        return age_ms;
+    }
+
+    // Запись во временный файл, fsync и переименование: прежний снимок цел до конца записи.
+    // Возвращает размер файла; std::runtime_error при ошибке
+    size_t save(const std::string& path) const;
+
+    // std::runtime_error - файла нет, формат или контрольная сумма не совпадают
+    static SessionSnapshot load(const std::string& path);
+
+    // Пословная контрольная сумма (8 байт за шаг)
+    static uint64_t checksum(const char* data, size_t size, uint64_t seed = 0);
+
+private:
+
+    uint64_t m_wall_ms;
+
+    std::vector<char> m_records;
+};
@@ -0,0 +1,162 @@
+//SessionTable.cpp
+
+#include "SessionTable.h"
+
+#include <memory>
+#include <new>
+#include <sys/mman.h>
+
+namespace {
+
+    constexpr size_t kMinCapacity = 16;
+
+    constexpr size_t kCacheLine = 64;
+
+}
+
+uint64_t imsiKey::pack(std::string_view digits) {
+    if (digits.empty() || digits.size() > kMaxDigits) return 0;
+    uint64_t key = 1;
+    for (char c : digits) {
+        if (c < '0' || c > '9') return 0;
+        key = (key << 4) | uint64_t(c - '0');
+    }
+    return key;
+}
+
+size_t imsiKey::unpack(uint64_t key, char* digits) {
+    size_t length = 0;
+    for (uint64_t rest = key; rest > 1; rest >>= 4) ++length;
+    for (size_t i = length; i > 0; --i, key >>= 4) {
+        digits[i - 1] = char('0' + (key & 0xF));
+    }
+    return length;
+}
+
+SessionTable::SessionTable(size_t expected, bool huge_pages) : m_huge_pages(huge_pages) {
+    const size_t capacity = capacityFor(expected);
+    m_entries = allocate(capacity, m_huge_pages);
+    m_mask = capacity - 1;
+}
+
+SessionTable::Entries SessionTable::allocate(size_t capacity, bool huge_pages) {
+    const size_t bytes = capacity * sizeof(SessionEntry);
+    const size_t alignment = huge_pages && bytes >= kHugePageSize ? kHugePageSize : kCacheLine;
+    // aligned_alloc требует размер, кратный выравниванию
+    const size_t allocated = (bytes + alignment - 1) / alignment * alignment;
+    void* memory = std::aligned_alloc(alignment, allocated);
+    if (!memory) throw std::bad_alloc();
+    if (alignment == kHugePageSize) {
+        // Подсказка: без поддержки THP ядро оставляет обычные страницы
+        ::madvise(memory, allocated, MADV_HUGEPAGE);
+    }
+    // Все страницы затрагиваются сразу - не на горячем пути при первой вставке
+    auto* entries = static_cast<SessionEntry*>(memory);
+    std::uninitialized_default_construct_n(entries, capacity);
+    return Entries(entries);
+}
+
+size_t SessionTable::capacityFor(size_t expected) {
+    size_t capacity = kMinCapacity;
+    while (capacity / 4 * 3 < expected) capacity <<= 1;
+    return capacity;
+}
+
+uint64_t SessionTable::hash(uint64_t key) {
+    // Финализатор splitmix64: соседние IMSI расходятся по всей таблице
+    key ^= key >> 30;
+    key *= 0xBF58476D1CE4E5B9ull;
+    key ^= key >> 27;
+    key *= 0x94D049BB133111EBull;
+    key ^= key >> 31;
+    return key;
+}
+
+SessionEntry* SessionTable::find(uint64_t key) {
+    for (size_t i = home(key);; i = (i + 1) & m_mask) {
+        if (m_entries[i].key == key) return &m_entries[i];
+        if (m_entries[i].key == 0) return nullptr;
+    }
+}
+
+const SessionEntry* SessionTable::find(uint64_t key) const {
+    return const_cast<SessionTable*>(this)->find(key);
+}
+
+SessionEntry& SessionTable::insert(uint64_t key, bool& inserted) {
+    if (SessionEntry* entry = find(key)) {
+        inserted = false;
+        return *entry;
+    }
+    if (m_size + 1 > capacity() / 4 * 3) grow();
+
+    size_t i = home(key);
+    while (m_entries[i].key != 0) i = (i + 1) & m_mask;
+    m_entries[i] = SessionEntry(key, 0, 0);
+    ++m_size;
+    inserted = true;
+    return m_entries[i];
+}
+
+bool SessionTable::erase(uint64_t key) {
+    SessionEntry* entry = find(key);
+    if (!entry) return false;
+    eraseAt(static_cast<size_t>(entry - m_entries.get()));
+    return true;
+}
+
+size_t SessionTable::next(size_t from) const {
+    while (from <= m_mask && m_entries[from].key == 0) ++from;
+    return from;
+}
+
+void SessionTable::eraseAt(size_t index) {
+    // Сдвиг назад: запись переносится в дыру, если дыра лежит между ее домашней позицией и ею
+    size_t hole = index;
+    for (size_t i = (hole + 1) & m_mask; m_entries[i].key != 0; i = (i + 1) & m_mask) {
+        const size_t home_index = home(m_entries[i].key);
+        const bool stays = (hole < i) ? (home_index > hole && home_index <= i)
+                                      : (home_index > hole || home_index <= i);
+        if (!stays) {
+            m_entries[hole] = m_entries[i];
+            hole = i;
+        }
+    }
+    m_entries[hole] = SessionEntry{};
+    --m_size;
+}
+
+size_t SessionTable::clockVictim() {
+    if (m_size == 0) return capacity();
+    // Не больше двух оборотов: за первый сняты все биты обращения. Каждый снятый бит
+    // поставлен продлением, поэтому в среднем проход стоит O(1) на вытеснение; вытеснение
+    // идет только у заполненного шарда, где пустых позиций не больше занятых (заполнение от 3/8)
+    for (size_t step = 0; step < 2 * capacity(); ++step) {
+        const size_t index = m_clock_hand;
+        SessionEntry& entry = m_entries[index];
+        const uint32_t touched_ms = entry.touched_ms.load(std::memory_order_relaxed);
+        if (entry.key != 0 && !(touched_ms & SessionEntry::kReferenced)) {
+            // Стрелка остается на жертве: после eraseAt сюда сдвигается следующая запись,
+            // и она проверяется в свою очередь, а не пропускает оборот
+            return index;
+        }
+        if (entry.key != 0) {
+            entry.touched_ms.store(touched_ms & ~SessionEntry::kReferenced, std::memory_order_relaxed);
+        }
+        m_clock_hand = (m_clock_hand + 1) & m_mask;
+    }
+    return capacity();
+}
+
+void SessionTable::grow() {
+    const size_t old_capacity = capacity();
+    Entries old_entries = std::move(m_entries);
+    m_entries = allocate(old_capacity * 2, m_huge_pages);
+    m_mask = old_capacity * 2 - 1;
+    for (size_t j = 0; j < old_capacity; ++j) {
+        if (old_entries[j].key == 0) continue;
+        size_t i = home(old_entries[j].key);
+        while (m_entries[i].key != 0) i = (i + 1) & m_mask;
+        m_entries[i] = old_entries[j];
+    }
+}
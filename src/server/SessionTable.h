@@ -0,0 +1,151 @@
+//SessionTable.h
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string_view>
+
+// IMSI (до 15 цифр) в одном uint64_t: старший полубайт-маркер 1, затем по полубайту на цифру.
+// Маркер сохраняет ведущие нули и длину; 0 - не IMSI (пустая запись таблицы)
+namespace imsiKey {
+
+    constexpr size_t kMaxDigits = 15;
+
+    // 0 - пусто, длиннее 15 цифр или есть не-цифры
+    uint64_t pack(std::string_view digits);
+
+    // Цифры в буфер (не меньше kMaxDigits), возвращает их количество
+    size_t unpack(uint64_t key, char* digits);
+
+};
+
+// Запись таблицы сессий: 16 байт, четыре записи в кэш-линии.
+// touched_ms атомарен: продление идет под разделяемой блокировкой шарда.
+// Младший бит touched_ms - бит обращения CLOCK (kReferenced): его ставит продление,
+// снимает стрелка clockVictim; метка активности от этого точна до 1 мс
+struct SessionEntry {
+    static constexpr uint32_t kReferenced = 1;
+
+    uint64_t key = 0;                       // Упакованный IMSI; 0 - запись свободна
+    std::atomic<uint32_t> touched_ms{0};    // Последняя активность, мс от запуска менеджера (по модулю 2^32)
+    uint32_t wheel_ms = 0;                  // Срок, на который запись стоит в колесе таймеров шарда
+
+    SessionEntry() = default;
+
+    SessionEntry(uint64_t key, uint32_t touched_ms, uint32_t wheel_ms)
+    : key(key), touched_ms(touched_ms), wheel_ms(wheel_ms) {}
+
+    // Копирование только при перестройке таблицы (под исключительной блокировкой)
+    SessionEntry(const SessionEntry& other)
+    : key(other.key), touched_ms(other.touched_ms.load(std::memory_order_relaxed)), wheel_ms(other.wheel_ms) {}
+
+    SessionEntry& operator=(const SessionEntry& other) {
+        key = other.key;
+        touched_ms.store(other.touched_ms.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        wheel_ms = other.wheel_ms;
+        return *this;
+    }
+};
+
+static_assert(sizeof(SessionEntry) == 16, "SessionEntry must stay 16 bytes");
+
+// Хэш-таблица с открытой адресацией и линейным пробированием.
+// Удаление сдвигает следующие записи назад, поэтому "надгробий" нет.
+// Не потокобезопасна: защищается блокировкой шарда SessionManager.
+class SessionTable {
+
+public:
+
+    // Емкость подбирается под expected записей без роста (степень двойки).
+    // huge_pages - таблицы от kHugePageSize выравниваются по нему и просят у ядра
+    // прозрачные huge pages: случайный доступ к большой таблице меньше промахивается мимо TLB
+    explicit SessionTable(size_t expected = 0, bool huge_pages = false);
+
+    SessionEntry* find(uint64_t key);
+
+    const SessionEntry* find(uint64_t key) const;
+
+    // Найти или добавить запись; inserted - запись новая (touched_ms, wheel_ms заполняет вызывающий)
+    SessionEntry& insert(uint64_t key, bool& inserted);
+
+    bool erase(uint64_t key);
+
+    // Занятая позиция, начиная с from; capacity() - занятых больше нет
+    size_t next(size_t from) const;
+
+    const SessionEntry& at(size_t index) const { return m_entries[index]; }
+
+    // Удалить запись по позиции; на ее место может сдвинуться следующая
+    void eraseAt(size_t index);
+
+    // Кандидат на вытеснение (CLOCK со вторым шансом): стрелка снимает бит обращения
+    // с продленных записей и останавливается на первой без него. capacity() - таблица пуста
+    size_t clockVictim();
+
+    // Сколько байт добавит следующая вставка (удвоение таблицы), 0 - место есть
+    size_t growthBytes() const { return m_size + 1 > capacity() / 4 * 3 ? memoryBytes() : 0; }
+
+    // Удалить записи, для которых pred(entry) истинно; перед удалением вызывается on_erase(entry)
+    template <typename Pred, typename OnErase>
+    size_t eraseIf(Pred pred, OnErase on_erase) {
+        size_t erased = 0;
+        size_t index = next(0);
+        while (index < capacity()) {
+            if (pred(m_entries[index])) {
+                on_erase(m_entries[index]);
+                eraseAt(index);
+                ++erased;
+                // На освободившееся место могла сдвинуться непроверенная запись
+                index = next(index);
+            } else {
+                index = next(index + 1);
+            }
+        }
+        return erased;
+    }
+
+    size_t size() const { return m_size; }
+
+    size_t capacity() const { return m_mask + 1; }
+
+    size_t memoryBytes() const { return capacity() * sizeof(SessionEntry); }
+
+    bool hugePages() const { return m_huge_pages; }
+
+    // Позиция ключа в таблице; старшие биты хэша - младшие выбирают шард
+    static uint64_t hash(uint64_t key);
+
+    static constexpr size_t kHugePageSize = size_t(2) << 20;
+
+private:
+
+    // Максимальное заполнение 3/4, дальше таблица удваивается
+    static size_t capacityFor(size_t expected);
+
+    size_t home(uint64_t key) const { return (hash(key) >> 32) & m_mask; }
+
+    void grow();
+
+    struct FreeEntries {
+        void operator()(SessionEntry* entries) const { std::free(entries); }
+    };
+
+    using Entries = std::unique_ptr<SessionEntry[], FreeEntries>;
+
+    // Записи выровнены по кэш-линии (четыре на линию), пустые
+    static Entries allocate(size_t capacity, bool huge_pages);
+
+    Entries m_entries;
+
+    size_t m_mask = 0;
+
+    size_t m_size = 0;
+
+    size_t m_clock_hand = 0;                // Позиция стрелки clockVictim
+
+    bool m_huge_pages = false;
+};
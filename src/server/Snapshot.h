@@ -0,0 +1,109 @@
+//Snapshot.h
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Неизменяемый снимок настроек, который заменяется целиком (перезагрузка конфигурации).
+// Читатель берет указатель одной атомарной загрузкой - без блокировок и общих счетчиков ссылок.
+// Каждый поток держит shared_ptr на последний прочитанный снимок и обновляет его, только
+// когда указатель в слоте сменился (раз на перезагрузку). Прежний снимок ждет в списке
+// замененных, пока его держит хоть один поток; освобождает его поток перезагрузки
+// (publish, reclaim), а не поток запросов - вместе с большим черным списком.
+template <typename T>
+class SnapshotSlot {
+
+public:
+
+    explicit SnapshotSlot(std::shared_ptr<const T> initial)
+    : m_owner(std::move(initial)) {
+        m_current.store(m_owner.get(), std::memory_order_release);
+    }
+
+    SnapshotSlot(const SnapshotSlot&) = delete;
+
+    SnapshotSlot& operator=(const SnapshotSlot&) = delete;
+
+    // Указатель действителен, пока этот поток снова не возьмет снимок типа T:
+    // на запрос снимок читается один раз
+    const T* get() const {
+        const T* current = m_current.load(std::memory_order_acquire);
+        ThreadCache& cache = threadCache();
+        // Кэш потока держит свой снимок: его адрес не может достаться другому объекту
+        if (cache.snapshot != current) refresh(cache);
+        return cache.snapshot;
+    }
+
+    const T* operator->() const { return get(); }
+
+    // Опубликовать новый снимок; вызывается вне горячего пути
+    void publish(std::shared_ptr<const T> next) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_current.store(next.get(), std::memory_order_release);
+            m_retired.push_back(std::move(m_owner));
+            m_owner = std::move(next);
+        }
+        reclaim();
+    }
+
+    // Освободить замененные снимки, которые больше не держит ни один поток.
+    // Возвращает, сколько еще ждут. Вызывается потоками перезагрузки и очистки
+    size_t reclaim() {
+        std::vector<std::shared_ptr<const T>> released;
+        size_t waiting = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            // Новые ссылки на замененный снимок не появляются: потоки берут только m_owner
+            for (size_t i = 0; i < m_retired.size();) {
+                if (m_retired[i].use_count() == 1) {
+                    released.push_back(std::move(m_retired[i]));
+                    m_retired[i] = std::move(m_retired.back());
+                    m_retired.pop_back();
+                } else {
+                    ++i;
+                }
+            }
+            waiting = m_retired.size();
+        }
+        // Освобождение (черный список на миллионы записей) - вне блокировки слота
+        released.clear();
+        return waiting;
+    }
+
+    size_t retired() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_retired.size();
+    }
+
+private:
+
+    struct ThreadCache {
+        const T* snapshot = nullptr;
+        std::shared_ptr<const T> hold;
+    };
+
+    static ThreadCache& threadCache() {
+        thread_local ThreadCache cache;
+        return cache;
+    }
+
+    // Прежний снимок кэша остается в m_retired: поток запросов его не освобождает
+    void refresh(ThreadCache& cache) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        cache.hold = m_owner;
+        cache.snapshot = m_owner.get();
+    }
+
+    std::atomic<const T*> m_current{nullptr};
+
+    mutable std::mutex m_mutex;
+
+    std::shared_ptr<const T> m_owner;
+
+    std::vector<std::shared_ptr<const T>> m_retired;
+};
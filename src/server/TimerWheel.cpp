@@ -0,0 +1,27 @@
+//TimerWheel.cpp
+
+#include "TimerWheel.h"
+
+TimerWheel::TimerWheel(uint32_t tick_ms, uint32_t now_ms)
+: m_tick_ms(tick_ms ? tick_ms : 1), m_now_ms(now_ms) {}
+
+void TimerWheel::schedule(uint64_t key, uint32_t deadline_ms) {
+    // Срок округляется вверх до тика; наступивший срок - текущий тик,
+    // а из обработчика текущей ячейки - следующий (ячейка уже разобрана)
+    const int32_t delta_ms = int32_t(deadline_ms - m_now_ms);
+    uint64_t ticks = delta_ms > 0 ? (uint64_t(delta_ms) + m_tick_ms - 1) / m_tick_ms : 0;
+    if (ticks == 0 && m_firing) ticks = 1;
+    place(key, m_tick + ticks);
+}
+
+void TimerWheel::place(uint64_t key, uint64_t expires_tick) {
+    // Дальше верхнего уровня - в последнюю ячейку, при переносе срок пересчитается
+    constexpr uint64_t kMaxTicks = (uint64_t(1) << (kLevelBits * kLevels)) - 1;
+    if (expires_tick - m_tick > kMaxTicks) expires_tick = m_tick + kMaxTicks;
+
+    const uint64_t ticks = expires_tick - m_tick;
+    size_t level = 0;
+    while (level + 1 < kLevels && ticks >= (uint64_t(1) << (kLevelBits * (level + 1)))) ++level;
+    m_levels[level][(expires_tick >> (kLevelBits * level)) & (kSlots - 1)].push_back(key);
+    ++m_records;
+}
@@ -0,0 +1,96 @@
+//TimerWheel.h
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Иерархическое колесо таймеров: kLevels уровней по kSlots ячеек,
+// ячейка уровня l покрывает kSlots^l тиков. Запись хранит только ключ:
+// срок знает владелец (SessionEntry::wheel_ms) и сообщает его при переносе с верхнего уровня.
+// Продвижение на тик стоит O(1) плюс записи сработавшей ячейки.
+// Не потокобезопасно: защищается блокировкой шарда SessionManager.
+class TimerWheel {
+
+public:
+
+    static constexpr size_t kLevelBits = 6;
+    static constexpr size_t kSlots = size_t(1) << kLevelBits;
+    static constexpr size_t kLevels = 4;
+
+    // now_ms - текущее время владельца (мс по модулю 2^32)
+    explicit TimerWheel(uint32_t tick_ms = 10, uint32_t now_ms = 0);
+
+    // Поставить ключ на срок deadline_ms; уже наступивший срок - ближайший тик
+    void schedule(uint64_t key, uint32_t deadline_ms);
+
+    // Продвинуть колесо до now_ms. Для ключей сработавших ячеек вызывается
+    // on_due(key, tick_ms) со временем тика; on_due может снова вызвать schedule.
+    // При переносе с верхнего уровня deadline(key, deadline_ms) сообщает срок; false - ключ снят
+    template <typename OnDue, typename Deadline>
+    size_t advance(uint32_t now_ms, OnDue on_due, Deadline deadline) {
+        size_t fired = 0;
+        while (int32_t(now_ms - m_now_ms) >= 0) {
+            const size_t index = m_tick & (kSlots - 1);
+            // Начало оборота нижнего уровня: раскладываем ячейку следующего уровня
+            for (size_t level = 1; level < kLevels && (m_tick >> (kLevelBits * (level - 1))) % kSlots == 0; ++level) {
+                cascade(level, (m_tick >> (kLevelBits * level)) & (kSlots - 1), deadline);
+            }
+            std::vector<uint64_t> due;
+            due.swap(m_levels[0][index]);
+            m_records -= due.size();
+            m_firing = true;
+            for (uint64_t key : due) {
+                on_due(key, m_now_ms);
+            }
+            m_firing = false;
+            fired += due.size();
+            // Буфер ячейки возвращается, чтобы не выделять память на следующем обороте
+            due.clear();
+            if (m_levels[0][index].empty()) m_levels[0][index].swap(due);
+
+            ++m_tick;
+            m_now_ms += m_tick_ms;
+        }
+        return fired;
+    }
+
+    // Записей в колесе (включая устаревшие)
+    size_t size() const { return m_records; }
+
+    uint32_t tickMs() const { return m_tick_ms; }
+
+private:
+
+    // Ячейка и уровень по числу тиков до срока
+    void place(uint64_t key, uint64_t expires_tick);
+
+    template <typename Deadline>
+    void cascade(size_t level, size_t index, Deadline& deadline) {
+        std::vector<uint64_t> keys;
+        keys.swap(m_levels[level][index]);
+        m_records -= keys.size();
+        for (uint64_t key : keys) {
+            uint32_t deadline_ms = 0;
+            if (deadline(key, deadline_ms)) schedule(key, deadline_ms);
+        }
+        // Ключи ушли на нижние уровни: буфер остается ячейке до следующего оборота
+        keys.clear();
+        if (m_levels[level][index].empty()) m_levels[level][index].swap(keys);
+    }
+
+    uint32_t m_tick_ms;
+
+    uint32_t m_now_ms;                  // Время тика m_tick
+
+    uint64_t m_tick = 0;                // Следующий необработанный тик
+
+    size_t m_records = 0;
+
+    bool m_firing = false;              // Идет обработка текущей ячейки: срок не раньше следующего тика
+
+    std::array<std::array<std::vector<uint64_t>, kSlots>, kLevels> m_levels;
+};
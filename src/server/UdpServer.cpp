@@ -5,8 +5,31 @@
 UdpServer::UdpServer(const uint16_t& port,
     std::shared_ptr<ISessionManager> session_manager,
     std::shared_ptr<Logger> log) 
-: m_port(port), m_session_manager(session_manager), m_log(log),
- m_sockfd(-1), m_running(false) {}
+: UdpServer(UdpServerConfig{port}, session_manager, log) {}
+
+UdpServer::UdpServer(const UdpServerConfig& config,
+    std::shared_ptr<ISessionManager> session_manager,
+    std::shared_ptr<Logger> log)
+: m_config(config), m_session_manager(session_manager), m_log(log),
+ m_running(false) {
+    if (m_config.batch_size == 0) m_config.batch_size = 1;
+    if (m_config.workers == 0) m_config.workers = 1;
+    if (m_config.overload_target_us > 0) {
+        m_overload = std::make_unique<OverloadController>(
+            OverloadConfig{m_config.overload_target_us, m_config.overload_interval_ms});
+    }
+    if (m_config.response_cache_size > 0) {
+        m_response_cache = std::make_unique<ResponseCache>(
+            ResponseCacheConfig{m_config.response_cache_size, m_config.response_cache_window_ms});
+    }
+}
+
+UdpEngine parseUdpEngine(const std::string& name) {
+    if (name == "blocking") return UdpEngine::Blocking;
+    if (name == "epoll") return UdpEngine::Epoll;
+    if (name == "io_uring") return UdpEngine::IoUring;
+    throw std::invalid_argument("Unknown UDP engine: " + name);
+}
 
 UdpServer::~UdpServer() {
     stop();
@@ -18,11 +41,47 @@ void UdpServer::start() {
     
     m_running = true;
     try {
-        createSocket();
-        bindSocket(getSockfd());
-        m_udp_server_thread = std::thread([this]() {
-            receiveAndProcess(getSockfd());
-        });
+        if (m_config.processing_workers > 0) {
+            ProcessingPoolConfig pool_config;
+            pool_config.min_workers = m_config.processing_workers;
+            pool_config.max_workers = std::max(m_config.processing_workers,
+                                               m_config.processing_max_workers);
+            pool_config.queue_capacity = m_config.processing_queue_size;
+            m_pool = std::make_unique<ProcessingPool>(pool_config,
+                [this](const char* data, size_t len, const sockaddr_in& client_addr,
+                       int64_t arrival_ns, char* response, size_t capacity) {
+                    return processRequest(data, len, client_addr, arrival_ns, response, capacity);
+                }, m_log);
+            m_pool->start();
+        }
+        m_rx_counters.clear();
+        for (uint16_t i = 0; i < m_config.workers; ++i) {
+            bindSocket(createSocket());
+        }
+        if (m_config.engine != UdpEngine::Blocking) {
+            m_stop_eventfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (m_stop_eventfd < 0) {
+                throw std::system_error(errno, std::generic_category(), "Failed to create eventfd");
+            }
+        }
+        for (size_t i = 0; i < m_sockfds.size(); ++i) {
+            const int sockfd = m_sockfds[i];
+            const bool drive_cleanup = (i == 0 && m_config.cleanup_interval_ms > 0);
+            m_worker_threads.emplace_back([this, sockfd, drive_cleanup, i]() {
+                threadPlacement::apply("udp", i);
+                if (m_config.engine == UdpEngine::Epoll) {
+                    runEventLoop(sockfd, drive_cleanup);
+                } else if (m_config.engine == UdpEngine::IoUring) {
+                    runIoUringLoop(sockfd);
+                } else if (m_config.batch_size > 1) {
+                    receiveAndProcessBatched(sockfd);
+                } else {
+                    receiveAndProcess(sockfd);
+                }
+            });
+        }
+        m_log->sendToLog("UDP server started on " + getEndpoint() +
+                         " with " + std::to_string(m_config.workers) + " worker(s)");
     } catch (const std::exception& e) {
         if (m_running) {
             m_log->sendToLog("[FATAL] " + std::string(e.what()));
@@ -34,35 +93,154 @@ void UdpServer::stop() {
     if (!m_running) return;
     
     m_running = false;
-    int wakeup_sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (wakeup_sock >= 0) {
-        sockaddr_in server_addr{};
-        server_addr.sin_family = AF_INET;
-        server_addr.sin_port = htons(m_port);
-        inet_pton(AF_INET, "127.0.0.1", &server_addr.sin_addr);
-        
-        sendto(wakeup_sock, "", 0, 0, 
-              (sockaddr*)&server_addr, sizeof(server_addr));
-        close(wakeup_sock);
+    if (m_stop_eventfd >= 0) {
+        // Событийные циклы просыпаются по eventfd
+        const uint64_t one = 1;
+        ssize_t written = write(m_stop_eventfd, &one, sizeof(one));
+        (void)written;
+    }
+    if (m_config.engine != UdpEngine::Epoll) {
+        // shutdown() будит поток, заблокированный в recvfrom/recvmmsg, на каждом сокете
+        for (int sockfd : m_sockfds) {
+            shutdown(sockfd, SHUT_RD);
+        }
     }
     
-    if (m_udp_server_thread.joinable()) {
-        m_udp_server_thread.join();
+    for (auto& thread : m_worker_threads) {
+        if (thread.joinable()) thread.join();
+    }
+    m_worker_threads.clear();
+
+    // Прием остановлен: дорабатываем очередь, пока сокеты открыты
+    if (m_pool) {
+        m_pool->stop();
     }
     
-    closeSocket(m_sockfd);
-    m_sockfd = -1;
+    for (int sockfd : m_sockfds) {
+        closeSocket(sockfd);
+    }
+    m_sockfds.clear();
+    closeSocket(m_stop_eventfd);
+    m_stop_eventfd = -1;
 }
 
 int UdpServer::getSockfd() const {
-    return m_sockfd;
+    return m_sockfds.empty() ? -1 : m_sockfds.front();
+}
+
+std::vector<int> UdpServer::getSockfds() const {
+    return m_sockfds;
+}
+
+std::string UdpServer::getEndpoint() const {
+    return m_config.ip + ":" + std::to_string(m_config.port);
+}
+
+BatchStats UdpServer::getBatchStats() const {
+    BatchStats stats;
+    stats.batches = m_batches.load(std::memory_order_relaxed);
+    stats.datagrams = m_batch_datagrams.load(std::memory_order_relaxed);
+    stats.full_batches = m_full_batches.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < stats.fill.size(); ++i) {
+        stats.fill[i] = m_batch_fill[i].load(std::memory_order_relaxed);
+    }
+    stats.malformed_gtp = m_malformed_gtp.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void UdpServer::setRateLimiter(std::shared_ptr<RateLimiter> rate_limiter) {
+    m_rate_limiter = std::move(rate_limiter);
+}
+
+QueueStats UdpServer::getQueueStats() const {
+    return m_pool ? m_pool->getStats() : QueueStats{};
+}
+
+OverloadStats UdpServer::getOverloadStats() const {
+    return m_overload ? m_overload->getStats() : OverloadStats{};
+}
+
+ResponseCacheStats UdpServer::getResponseCacheStats() const {
+    return m_response_cache ? m_response_cache->getStats() : ResponseCacheStats{};
+}
+
+KernelRxStats UdpServer::getKernelRxStats() const {
+    KernelRxStats stats;
+    for (const auto& counters : m_rx_counters) {
+        counters->addTo(stats);
+    }
+    stats.rcvbuf_bytes = m_rcvbuf_bytes;
+    return stats;
+}
+
+KernelRxCounters* UdpServer::rxCounters(int sockfd) {
+    for (size_t i = 0; i < m_sockfds.size() && i < m_rx_counters.size(); ++i) {
+        if (m_sockfds[i] == sockfd) return m_rx_counters[i].get();
+    }
+    return nullptr;
+}
+
+void to_json(nlohmann::json& j, const BatchStats& stats) {
+    j = nlohmann::json{
+        {"batches", stats.batches},
+        {"datagrams", stats.datagrams},
+        {"full_batches", stats.full_batches},
+        {"avg_fill", stats.batches ? double(stats.datagrams) / stats.batches : 0.0},
+        {"fill_histogram", stats.fill},
+        {"malformed_gtp", stats.malformed_gtp}
+    };
+}
+
+void UdpServer::setReceiveBuffer(int sockfd) {
+    const int requested = static_cast<int>(m_config.rcvbuf_bytes);
+    // SO_RCVBUFFORCE обходит rmem_max, но требует CAP_NET_ADMIN
+    if (setsockopt(sockfd, SOL_SOCKET, SO_RCVBUFFORCE, &requested, sizeof(requested)) < 0 &&
+        setsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &requested, sizeof(requested)) < 0) {
+        m_log->sendToLog("Failed to set SO_RCVBUF on UDP socket");
+        throw std::system_error(errno, std::generic_category(), "Failed to set SO_RCVBUF");
+    }
+
+    int actual = 0;
+    socklen_t len = sizeof(actual);
+    getsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &actual, &len);
+    m_rcvbuf_bytes = static_cast<uint64_t>(actual);
+    // Ядро удваивает значение под служебные данные; меньше запрошенного - уперлись в rmem_max
+    if (actual < requested) {
+        m_log->sendToLog(LogLevel::Warning, "SO_RCVBUF limited to " + std::to_string(actual) +
+                         " bytes (requested " + std::to_string(requested) + "), raise net.core.rmem_max");
+    }
+}
+
+void UdpServer::enableBusyPoll(int sockfd) {
+    const int busy_poll = static_cast<int>(m_config.busy_poll_us);
+    if (setsockopt(sockfd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll, sizeof(busy_poll)) < 0) {
+        m_log->sendToLog(LogLevel::Warning, "Failed to set SO_BUSY_POLL on UDP socket: " +
+                         std::string(std::strerror(errno)));
+        return;
+    }
+#ifdef SO_PREFER_BUSY_POLL
+    int enable = 1;
+    if (setsockopt(sockfd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &enable, sizeof(enable)) < 0) {
+        m_log->sendToLog(LogLevel::Warning, "Failed to set SO_PREFER_BUSY_POLL on UDP socket: " +
+                         std::string(std::strerror(errno)));
+    }
+#endif
+    if (m_config.busy_poll_budget > 0) {
+#ifdef SO_BUSY_POLL_BUDGET
+        const int budget = m_config.busy_poll_budget;
+        if (setsockopt(sockfd, SOL_SOCKET, SO_BUSY_POLL_BUDGET, &budget, sizeof(budget)) < 0) {
+            m_log->sendToLog(LogLevel::Warning, "Failed to set SO_BUSY_POLL_BUDGET on UDP socket: " +
+                             std::string(std::strerror(errno)));
+        }
+#else
+        m_log->sendToLog(LogLevel::Warning, "SO_BUSY_POLL_BUDGET is not supported by this build");
+#endif
+    }
 }
 
 int UdpServer::createSocket() {
-    if (m_sockfd >= 0) closeSocket(m_sockfd);
-    m_sockfd = socket(AF_INET, SOCK_DGRAM, 0);
-    std::cout << "UdpServer::m_sockfd: " << std::to_string(m_sockfd) << std::endl;
-    if (m_sockfd < 0) {
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sockfd < 0) {
         m_log->sendToLog("Failed to create UDP socket");
         throw std::system_error(
             errno, 
@@ -70,55 +248,108 @@ int UdpServer::createSocket() {
             "Failed to create socket"
         );
     }
+    m_sockfds.push_back(sockfd);
+
+    // Событийный цикл работает только с неблокирующими сокетами
+    if (m_config.engine == UdpEngine::Epoll &&
+        fcntl(sockfd, F_SETFL, fcntl(sockfd, F_GETFL, 0) | O_NONBLOCK) < 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to set O_NONBLOCK");
+    }
+
+    // Несколько сокетов на одном порту: ядро распределяет клиентов между ними
+    if (m_config.workers > 1) {
+        int enable = 1;
+        if (setsockopt(sockfd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0) {
+            m_log->sendToLog("Failed to set SO_REUSEPORT on UDP socket");
+            throw std::system_error(
+                errno,
+                std::generic_category(),
+                "Failed to set SO_REUSEPORT"
+            );
+        }
+    }
+    // Время прихода в ядро для оценки задержки в очередях
+    if (receivesControl()) {
+        int enable = 1;
+        if (setsockopt(sockfd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) < 0) {
+            m_log->sendToLog("Failed to set SO_TIMESTAMPNS on UDP socket");
+            throw std::system_error(errno, std::generic_category(), "Failed to set SO_TIMESTAMPNS");
+        }
+    }
+    // Счетчик датаграмм, отброшенных ядром из-за полного буфера приема
+    if (m_config.kernel_stats) {
+        int enable = 1;
+        if (setsockopt(sockfd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable)) < 0) {
+            m_log->sendToLog("Failed to set SO_RXQ_OVFL on UDP socket");
+            throw std::system_error(errno, std::generic_category(), "Failed to set SO_RXQ_OVFL");
+        }
+        m_rx_counters.push_back(std::make_unique<KernelRxCounters>());
+    }
+    if (m_config.rcvbuf_bytes > 0) {
+        setReceiveBuffer(sockfd);
+    }
+    if (m_config.busy_poll_us > 0) {
+        enableBusyPoll(sockfd);
+    }
     m_log->sendToLog("Create UDP socket");
-    return m_sockfd;
+    return sockfd;
 }
 
 void UdpServer::bindSocket(const int& sockfd) {
     sockaddr_in server_addr{};
     server_addr.sin_family = AF_INET;
-    server_addr.sin_addr.s_addr = INADDR_ANY;
-    server_addr.sin_port = htons(m_port);
+    server_addr.sin_port = htons(m_config.port);
+    if (inet_pton(AF_INET, m_config.ip.c_str(), &server_addr.sin_addr) != 1) {
+        m_log->sendToLog("Invalid UDP listen address: " + m_config.ip);
+        throw std::invalid_argument("Invalid IP address: " + m_config.ip);
+    }
 
     if (bind(sockfd, (sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        closeSocket(sockfd);
-        m_log->sendToLog("Failed to bind UDP socket");
+        m_log->sendToLog("Failed to bind UDP socket to " + getEndpoint());
         throw std::system_error(
             errno,
             std::generic_category(),
             "Failed to bind socket"
         );
     }
-    m_log->sendToLog("Bind UDP socket");
+    m_log->sendToLog("Bind UDP socket to " + getEndpoint());
 }
 
 void UdpServer::receiveAndProcess(const int& sockfd) {
     char buffer[1024];
     sockaddr_in client_addr;
     socklen_t len = sizeof(client_addr);
+    alignas(cmsghdr) char control[kControlSize];
+    KernelRxCounters* rx = rxCounters(sockfd);
+    iovec iov{buffer, sizeof(buffer)};
+    msghdr msg{};
+    msg.msg_name = &client_addr;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
 
     while (m_running) {
-        // std::unique_lock<std::mutex> lock(m_queue_mutex);
-        if (!m_running) break;
         try {
-            // Принимаем сообщение
-            ssize_t status_receive = recvfrom(
-                sockfd, buffer, sizeof(buffer), 0,
-                (sockaddr*)&client_addr, &len
-            );
+            // Принимаем сообщение (с временем прихода и счетчиком потерь, если они включены)
+            msg.msg_namelen = sizeof(client_addr);
+            msg.msg_control = receivesControl() ? control : nullptr;
+            msg.msg_controllen = receivesControl() ? sizeof(control) : 0;
+            ssize_t status_receive = recvmsg(sockfd, &msg, 0);
+            len = msg.msg_namelen;
             if (status_receive < 0) {
                 m_log->sendToLog("Failed to receive data");
                 throw std::runtime_error("Failed to receive data");
             }
+            if (!m_running) break;
 
             // Обрабатываем IMSI
-            std::string imsi(buffer, status_receive);
-            m_log->sendToLog("IMSI from UE: " + imsi);
-            std::string response = m_session_manager->handleImsi(imsi);
+            char response[kMaxResponseSize];
+            const size_t response_len = dispatchRequest(sockfd, client_addr, buffer, status_receive,
+                                                        arrivalTime(msg, rx), response, sizeof(response));
+            if (response_len == 0) continue;
 
             // Отправляем ответ
             ssize_t status_sendto = sendto(
-                sockfd, response.c_str(), response.size(), 0,
+                sockfd, response, response_len, 0,
                 (sockaddr*)&client_addr, len
             );
             // spdlog::debug("UdpServer::status_sendto: {}", status_sendto);
@@ -126,7 +357,6 @@ void UdpServer::receiveAndProcess(const int& sockfd) {
                 m_log->sendToLog("Failed to send data");
                 throw std::runtime_error("Failed to send response");
             }
-            m_log->sendToLog("Send to UE: " + imsi + ", " + response);
         } catch (const std::exception& e) {
             std::cerr << "[ERROR] " << e.what() << std::endl;
             // Можно добавить логирование через spdlog
@@ -134,6 +364,529 @@ void UdpServer::receiveAndProcess(const int& sockfd) {
     }
 }
 
+// Буферы пакетного приема/отправки: выделяются один раз на поток
+struct UdpServer::BatchContext {
+    // Управляющие сообщения одной датаграммы (SCM_TIMESTAMPNS, SO_RXQ_OVFL)
+    struct Control {
+        alignas(cmsghdr) char data[kControlSize];
+    };
+
+    explicit BatchContext(size_t batch)
+    : rx_buffers(batch), responses(batch), controls(batch), client_addrs(batch),
+      rx_iov(batch), tx_iov(batch), rx_msgs(batch), tx_msgs(batch) {
+        for (size_t i = 0; i < batch; ++i) {
+            rx_iov[i] = {rx_buffers[i].data(), rx_buffers[i].size()};
+            rx_msgs[i] = {};
+            rx_msgs[i].msg_hdr.msg_iov = &rx_iov[i];
+            rx_msgs[i].msg_hdr.msg_iovlen = 1;
+            rx_msgs[i].msg_hdr.msg_name = &client_addrs[i];
+        }
+    }
+
+    std::vector<std::array<char, 1024>> rx_buffers;
+    std::vector<std::array<char, kMaxResponseSize>> responses;
+    std::vector<Control> controls;
+    std::vector<sockaddr_in> client_addrs;
+    std::vector<iovec> rx_iov, tx_iov;
+    std::vector<mmsghdr> rx_msgs, tx_msgs;
+    KernelRxCounters* rx = nullptr;         // Счетчики ядра сокета (если включены)
+};
+
+void UdpServer::receiveAndProcessBatched(const int& sockfd) {
+    BatchContext ctx(m_config.batch_size);
+    ctx.rx = rxCounters(sockfd);
+
+    while (m_running) {
+        // Блокируемся до первой датаграммы, остальные забираем без ожидания
+        int received = processBatch(sockfd, ctx, MSG_WAITFORONE);
+        if (received < 0 && errno != EINTR) {
+            m_log->sendToLog("Failed to receive data batch");
+            std::cerr << "[ERROR] recvmmsg: " << std::strerror(errno) << std::endl;
+        }
+    }
+}
+
+int UdpServer::processBatch(const int& sockfd, BatchContext& ctx, int flags) {
+    const size_t batch = ctx.rx_msgs.size();
+    for (size_t i = 0; i < batch; ++i) {
+        ctx.rx_msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        ctx.rx_msgs[i].msg_hdr.msg_control = receivesControl() ? ctx.controls[i].data : nullptr;
+        ctx.rx_msgs[i].msg_hdr.msg_controllen = receivesControl() ? sizeof(ctx.controls[i].data) : 0;
+    }
+
+    int received = recvmmsg(sockfd, ctx.rx_msgs.data(), batch, flags, nullptr);
+    if (received <= 0 || !m_running) return received;
+    recordBatch(received);
+
+    // Обрабатываем все датаграммы пакета и готовим ответы
+    size_t replies = 0;
+    for (int i = 0; i < received; ++i) {
+        const size_t len = ctx.rx_msgs[i].msg_len;
+        if (len == 0) continue;
+        try {
+            ctx.tx_iov[replies].iov_len = dispatchRequest(sockfd, ctx.client_addrs[i],
+                                                          ctx.rx_buffers[i].data(), len,
+                                                          arrivalTime(ctx.rx_msgs[i].msg_hdr, ctx.rx),
+                                                          ctx.responses[replies].data(),
+                                                          ctx.responses[replies].size());
+            if (ctx.tx_iov[replies].iov_len == 0) continue;
+        } catch (const std::exception& e) {
+            std::cerr << "[ERROR] " << e.what() << std::endl;
+            continue;
+        }
+        ctx.tx_iov[replies].iov_base = ctx.responses[replies].data();
+        ctx.tx_msgs[replies] = {};
+        ctx.tx_msgs[replies].msg_hdr.msg_iov = &ctx.tx_iov[replies];
+        ctx.tx_msgs[replies].msg_hdr.msg_iovlen = 1;
+        ctx.tx_msgs[replies].msg_hdr.msg_name = &ctx.client_addrs[i];
+        ctx.tx_msgs[replies].msg_hdr.msg_namelen = ctx.rx_msgs[i].msg_hdr.msg_namelen;
+        ++replies;
+    }
+
+    // Отправляем все ответы одним вызовом (досылаем, если ядро приняло часть)
+    size_t sent = 0;
+    while (sent < replies) {
+        int status_send = sendmmsg(sockfd, ctx.tx_msgs.data() + sent, replies - sent, 0);
+        if (status_send < 0) {
+            if (errno == EINTR) continue;
+            m_log->sendToLog("Failed to send data batch");
+            std::cerr << "[ERROR] sendmmsg: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        sent += status_send;
+    }
+    return received;
+}
+
+void UdpServer::runEventLoop(const int& sockfd, bool drive_cleanup) {
+    BatchContext ctx(m_config.batch_size);
+    ctx.rx = rxCounters(sockfd);
+
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        m_log->sendToLog("[FATAL] Failed to create epoll instance");
+        return;
+    }
+
+    // Таймер очистки просроченных сессий вместо отдельного потока SessionManager
+    int timer_fd = -1;
+    if (drive_cleanup) {
+        timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        const time_t sec = m_config.cleanup_interval_ms / 1000;
+        const long nsec = (m_config.cleanup_interval_ms % 1000) * 1000000L;
+        itimerspec interval{{sec, nsec}, {sec, nsec}};
+        if (timer_fd < 0 || timerfd_settime(timer_fd, 0, &interval, nullptr) < 0) {
+            m_log->sendToLog("Failed to arm session cleanup timer");
+            closeSocket(timer_fd);
+            timer_fd = -1;
+        }
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = sockfd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sockfd, &ev);
+    ev.data.fd = m_stop_eventfd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, m_stop_eventfd, &ev);
+    if (timer_fd >= 0) {
+        ev.data.fd = timer_fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev);
+    }
+
+    // Сколько пакетов подряд забирать с сокета, прежде чем проверить таймеры
+    constexpr int kBatchesPerWakeup = 16;
+    epoll_event events[4];
+
+    while (m_running) {
+        int ready = epoll_wait(epoll_fd, events, 4, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            m_log->sendToLog("epoll_wait failed: " + std::string(std::strerror(errno)));
+            break;
+        }
+        for (int i = 0; i < ready && m_running; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == sockfd) {
+                for (int n = 0; n < kBatchesPerWakeup && m_running; ++n) {
+                    int received = processBatch(sockfd, ctx, MSG_DONTWAIT);
+                    if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                        m_log->sendToLog("Failed to receive data batch");
+                        std::cerr << "[ERROR] recvmmsg: " << std::strerror(errno) << std::endl;
+                    }
+                    if (received < static_cast<int>(m_config.batch_size)) break;
+                }
+            } else if (fd == timer_fd) {
+                uint64_t expirations = 0;
+                if (read(timer_fd, &expirations, sizeof(expirations)) > 0) {
+                    try {
+                        m_session_manager->cleanupExpiredSessions();
+                    } catch (const std::exception& e) {
+                        std::cerr << "[ERROR] " << e.what() << std::endl;
+                    }
+                }
+            }
+            // m_stop_eventfd не вычитывается: остается готовым и будит все циклы
+        }
+    }
+
+    closeSocket(timer_fd);
+    closeSocket(epoll_fd);
+}
+
+#ifdef PGW_HAVE_IO_URING
+
+void UdpServer::runIoUringLoop(const int& sockfd) {
+    constexpr unsigned kRingEntries = 256;
+    constexpr unsigned kBufferSize = 2048;
+    constexpr uint16_t kBufferGroup = 1;
+
+    // Тип операции в старших 32 битах user_data, номер слота отправки - в младших
+    constexpr uint64_t kRecvTag = 1, kSendTag = 2, kStopTag = 3;
+
+    // Слот ответа живет до завершения sendmsg
+    struct TxSlot {
+        std::array<char, kMaxResponseSize> response;
+        sockaddr_in addr{};
+        iovec iov{};
+        msghdr msg{};
+    };
+
+    unsigned buffer_count = 64;
+    while (buffer_count < 4u * m_config.batch_size) buffer_count <<= 1;
+    std::vector<char> rx_pool(size_t(buffer_count) * kBufferSize);
+    std::vector<TxSlot> tx_slots(kRingEntries);
+    std::vector<uint32_t> free_slots;
+    for (uint32_t i = 0; i < kRingEntries; ++i) free_slots.push_back(kRingEntries - 1 - i);
+
+    msghdr recv_msg{};
+    recv_msg.msg_namelen = sizeof(sockaddr_in);
+    recv_msg.msg_controllen = receivesControl() ? kControlSize : 0;
+    KernelRxCounters* rx = rxCounters(sockfd);
+
+    IoUring ring;
+    std::string error;
+    if (!ring.init(kRingEntries, error) ||
+        !ring.registerBufferRing(kBufferGroup, rx_pool.data(), buffer_count, kBufferSize, error)) {
+        m_log->sendToLog("io_uring unavailable (" + error + "), using synchronous loop");
+        spdlog::warn("io_uring unavailable ({}), using synchronous loop", error);
+        receiveAndProcessBatched(sockfd);
+        return;
+    }
+
+    auto armRecv = [&]() {
+        io_uring_sqe* sqe = ring.getSqe();
+        if (!sqe) return false;
+        sqe->opcode = IORING_OP_RECVMSG;
+        sqe->fd = sockfd;
+        sqe->addr = reinterpret_cast<uint64_t>(&recv_msg);
+        sqe->len = 1;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = kBufferGroup;
+        sqe->user_data = kRecvTag << 32;
+        return true;
+    };
+
+    io_uring_sqe* stop_sqe = ring.getSqe();
+    stop_sqe->opcode = IORING_OP_POLL_ADD;
+    stop_sqe->fd = m_stop_eventfd;
+    stop_sqe->poll32_events = POLLIN;
+    stop_sqe->user_data = kStopTag << 32;
+    bool recv_armed = armRecv();
+
+    while (m_running) {
+        if (ring.submit(1) < 0 && errno != EINTR && errno != EBUSY) {
+            m_log->sendToLog("io_uring_enter failed: " + std::string(std::strerror(errno)));
+            break;
+        }
+
+        size_t datagrams = 0;
+        ring.reap([&](const io_uring_cqe& cqe) {
+            const uint64_t tag = cqe.user_data >> 32;
+            if (tag == kSendTag) {
+                free_slots.push_back(static_cast<uint32_t>(cqe.user_data));
+                if (cqe.res < 0) {
+                    std::cerr << "[ERROR] io_uring sendmsg: " << std::strerror(-cqe.res) << std::endl;
+                }
+                return;
+            }
+            if (tag != kRecvTag) return;
+
+            if (!(cqe.flags & IORING_CQE_F_MORE)) recv_armed = false;
+            if (cqe.res < 0) {
+                if (cqe.res != -ENOBUFS) {
+                    std::cerr << "[ERROR] io_uring recvmsg: " << std::strerror(-cqe.res) << std::endl;
+                }
+                return;
+            }
+            if (!(cqe.flags & IORING_CQE_F_BUFFER)) return;
+
+            // Буфер: io_uring_recvmsg_out, адрес отправителя, затем данные
+            const uint16_t bid = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+            char* buffer = rx_pool.data() + size_t(bid) * kBufferSize;
+            const auto* out = reinterpret_cast<const io_uring_recvmsg_out*>(buffer);
+            const char* name = buffer + sizeof(io_uring_recvmsg_out);
+            const char* payload = name + recv_msg.msg_namelen + recv_msg.msg_controllen;
+            const size_t available = static_cast<size_t>(cqe.res) - (payload - buffer);
+            const size_t len = std::min<size_t>(out->payloadlen, available);
+            ++datagrams;
+
+            if (len > 0 && m_running) {
+                try {
+                    sockaddr_in client_addr{};
+                    std::memcpy(&client_addr, name, std::min<size_t>(out->namelen, sizeof(client_addr)));
+                    // Управляющие сообщения лежат между адресом и данными
+                    msghdr control{};
+                    control.msg_control = const_cast<char*>(name) + recv_msg.msg_namelen;
+                    control.msg_controllen = out->controllen;
+                    char response[kMaxResponseSize];
+                    const size_t response_len = dispatchRequest(sockfd, client_addr, payload, len,
+                                                                arrivalTime(control, rx),
+                                                                response, sizeof(response));
+
+                    io_uring_sqe* sqe = (response_len == 0 || free_slots.empty())
+                                        ? nullptr : ring.getSqe();
+                    if (response_len == 0) {
+                        // Ответ не требуется (ушел в пул или некорректное бинарное сообщение)
+                    } else if (!sqe) {
+                        // Нет свободного слота или SQE - отвечаем синхронно
+                        sendto(sockfd, response, response_len, 0,
+                               (sockaddr*)&client_addr, sizeof(client_addr));
+                    } else {
+                        const uint32_t index = free_slots.back();
+                        free_slots.pop_back();
+                        TxSlot& slot = tx_slots[index];
+                        std::memcpy(slot.response.data(), response, response_len);
+                        slot.addr = client_addr;
+                        slot.iov = {slot.response.data(), response_len};
+                        slot.msg = {};
+                        slot.msg.msg_name = &slot.addr;
+                        slot.msg.msg_namelen = sizeof(slot.addr);
+                        slot.msg.msg_iov = &slot.iov;
+                        slot.msg.msg_iovlen = 1;
+                        sqe->opcode = IORING_OP_SENDMSG;
+                        sqe->fd = sockfd;
+                        sqe->addr = reinterpret_cast<uint64_t>(&slot.msg);
+                        sqe->len = 1;
+                        sqe->user_data = (kSendTag << 32) | index;
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "[ERROR] " << e.what() << std::endl;
+                }
+            }
+            ring.recycleBuffer(bid);
+        });
+        ring.publishBuffers();
+        if (datagrams > 0) recordBatch(datagrams);
+
+        // Multishot прием завершается, когда у ядра кончаются буферы - перевзводим
+        if (!recv_armed && m_running) recv_armed = armRecv();
+    }
+}
+
+#else
+
+void UdpServer::runIoUringLoop(const int& sockfd) {
+    m_log->sendToLog("io_uring support is not compiled in, using synchronous loop");
+    spdlog::warn("io_uring support is not compiled in, using synchronous loop");
+    receiveAndProcessBatched(sockfd);
+}
+
+#endif // PGW_HAVE_IO_URING
+
+size_t UdpServer::dispatchRequest(const int& sockfd, const sockaddr_in& client_addr,
+                                  const char* data, size_t len, int64_t arrival_ns,
+                                  char* response, size_t capacity) {
+    // Лимит источника проверяется до очереди и менеджера сессий
+    if (m_rate_limiter && !m_rate_limiter->allow(client_addr.sin_addr.s_addr)) {
+        if (m_rate_limiter->action() == RateLimitAction::Drop) return 0;
+        return rejectRequest(data, len, SessionResult::RateLimited, response, capacity);
+    }
+    // Повтор уже обработанного запроса - ответ из кэша без очереди и SessionManager
+    ResponseCache::Key key;
+    if (m_response_cache && requestKey(data, len, client_addr, key)) {
+        const size_t cached_len = m_response_cache->lookup(key, response, capacity);
+        if (cached_len > 0) return cached_len;
+    }
+    if (m_pool && len <= ProcessingPool::kMaxRequestSize) {
+        // Ответ отправит поток пула; при переполнении очереди запрос отбрасывается
+        m_pool->submit(sockfd, client_addr, data, len, arrival_ns);
+        return 0;
+    }
+    return processRequest(data, len, client_addr, arrival_ns, response, capacity);
+}
+
+int64_t UdpServer::arrivalTime(const msghdr& msg, KernelRxCounters* rx) {
+    if (msg.msg_controllen == 0) return 0;
+    int64_t arrival_ns = 0;
+    for (const cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg;
+         cmsg = CMSG_NXTHDR(const_cast<msghdr*>(&msg), const_cast<cmsghdr*>(cmsg))) {
+        if (cmsg->cmsg_level != SOL_SOCKET) continue;
+        if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            timespec ts;
+            std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            arrival_ns = int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+        } else if (cmsg->cmsg_type == SO_RXQ_OVFL && rx) {
+            uint32_t drops = 0;
+            std::memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+            rx->recordDrops(drops);
+        }
+    }
+    if (rx && arrival_ns > 0) {
+        timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        rx->recordDelay(int64_t(now.tv_sec) * 1000000000 + now.tv_nsec - arrival_ns);
+    }
+    return arrival_ns;
+}
+
+SessionResult UdpServer::admitImsi(std::string_view imsi, int64_t arrival_ns) {
+    if (m_overload && arrival_ns > 0) {
+        timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        if (m_overload->observe(arrival_ns, int64_t(now.tv_sec) * 1000000000 + now.tv_nsec)) {
+            // Перегрузка: существующие сессии продлеваем, новые не создаем
+            if (m_session_manager->refreshSession(imsi)) {
+                m_overload->recordRefresh();
+                return SessionResult::Exists;
+            }
+            m_overload->recordShed();
+            return SessionResult::Overloaded;
+        }
+    }
+    return m_session_manager->handleImsi(imsi);
+}
+
+size_t UdpServer::processRequest(const char* data, size_t len, const sockaddr_in& client_addr,
+                                 int64_t arrival_ns, char* response, size_t capacity) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data);
+    const size_t response_len = gtp::isGtpMessage(bytes, len)
+        ? processGtpRequest(bytes, len, arrival_ns, reinterpret_cast<uint8_t*>(response), capacity)
+        : processTextRequest(data, len, arrival_ns, response, capacity);
+
+    ResponseCache::Key key;
+    if (m_response_cache && response_len > 0 && requestKey(data, len, client_addr, key)) {
+        m_response_cache->store(key, response, response_len);
+    }
+    return response_len;
+}
+
+size_t UdpServer::processTextRequest(const char* data, size_t len, int64_t arrival_ns,
+                                     char* response, size_t capacity) {
+    const std::string_view request(data, len);
+    std::string_view imsi;
+    uint32_t sequence = 0;
+    const bool has_sequence = textProtocol::splitSequence(request, imsi, sequence);
+    const std::string_view reply = toResponse(admitImsi(imsi, arrival_ns));
+
+    // Построчный лог запросов формируется только при уровне DEBUG
+    if (m_log->isEnabled(LogLevel::Debug)) {
+        m_log->sendToLog(LogLevel::Debug, "IMSI from UE: " + std::string(request));
+        m_log->sendToLog(LogLevel::Debug, "Send to UE: " + std::string(request) + ", " + std::string(reply));
+    }
+    return writeTextReply(reply, has_sequence, sequence, response, capacity);
+}
+
+size_t UdpServer::writeTextReply(std::string_view reply, bool has_sequence, uint32_t sequence,
+                                 char* response, size_t capacity) {
+    size_t reply_len = std::min(reply.size(), capacity);
+    std::memcpy(response, reply.data(), reply_len);
+    if (has_sequence && reply_len < capacity) {
+        response[reply_len++] = textProtocol::kSequenceSeparator;
+        const auto result = std::to_chars(response + reply_len, response + capacity, sequence);
+        reply_len = result.ec == std::errc() ? result.ptr - response : reply_len - 1;
+    }
+    return reply_len;
+}
+
+bool UdpServer::requestKey(const char* data, size_t len, const sockaddr_in& client_addr,
+                           ResponseCache::Key& key) {
+    key.addr = client_addr.sin_addr.s_addr;
+    key.port = client_addr.sin_port;
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data);
+    if (gtp::isGtpMessage(bytes, len)) {
+        // Номер последовательности есть в каждом заголовке бинарного протокола
+        key.protocol = 1;
+        key.sequence = (uint32_t(bytes[8]) << 16) | (uint32_t(bytes[9]) << 8) | uint32_t(bytes[10]);
+        return true;
+    }
+    std::string_view imsi;
+    key.protocol = 0;
+    return textProtocol::splitSequence(std::string_view(data, len), imsi, key.sequence);
+}
+
+size_t UdpServer::processGtpRequest(const uint8_t* data, size_t len, int64_t arrival_ns,
+                                    uint8_t* response, size_t capacity) {
+    const gtp::MessageView message(data, len);
+    if (!message.valid() || message.type() != gtp::MessageType::CreateSessionRequest) {
+        // Поток мусора не должен стоить строки лога на каждую датаграмму
+        m_malformed_gtp.fetch_add(1, std::memory_order_relaxed);
+        if (m_log->isEnabled(LogLevel::Debug)) {
+            m_log->sendToLog(LogLevel::Debug, "Dropped malformed GTP message");
+        }
+        return 0;
+    }
+
+    gtp::Cause cause = gtp::Cause::RequestRejected;
+    char digits[gtp::kMaxImsiDigits];
+    size_t digit_count = 0;
+    gtp::IeView imsi_ie{};
+    if (message.findIe(gtp::IeType::Imsi, imsi_ie)) {
+        digit_count = gtp::decodeImsi(imsi_ie, digits, sizeof(digits));
+    }
+    if (digit_count > 0) {
+        cause = toGtpCause(admitImsi(std::string_view(digits, digit_count), arrival_ns));
+    }
+
+    if (m_log->isEnabled(LogLevel::Debug)) {
+        m_log->sendToLog(LogLevel::Debug, "GTP Create Session Request seq " +
+                         std::to_string(message.sequence()) + " IMSI: " +
+                         std::string(digits, digit_count) + ", cause " +
+                         std::to_string(static_cast<int>(cause)));
+    }
+    return gtp::encodeCreateSessionResponse(response, capacity, message.sequence(), cause);
+}
+
+size_t UdpServer::rejectRequest(const char* data, size_t len, SessionResult result,
+                                char* response, size_t capacity) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data);
+    if (gtp::isGtpMessage(bytes, len)) {
+        // Ответ бинарному клиенту должен нести номер последовательности запроса
+        const gtp::MessageView message(bytes, len);
+        if (!message.valid()) return 0;
+        return gtp::encodeCreateSessionResponse(reinterpret_cast<uint8_t*>(response), capacity,
+                                                message.sequence(), toGtpCause(result));
+    }
+    std::string_view imsi;
+    uint32_t sequence = 0;
+    const bool has_sequence = textProtocol::splitSequence(std::string_view(data, len), imsi, sequence);
+    return writeTextReply(toResponse(result), has_sequence, sequence, response, capacity);
+}
+
+gtp::Cause toGtpCause(SessionResult result) {
+    switch (result) {
+        case SessionResult::Created:      return gtp::Cause::RequestAccepted;
+        case SessionResult::Exists:       return gtp::Cause::ContextExists;
+        case SessionResult::ShuttingDown:
+        case SessionResult::RateLimited:
+        case SessionResult::Overloaded:
+        case SessionResult::CapacityExceeded: return gtp::Cause::NoResourcesAvailable;
+        case SessionResult::Rejected:     break;
+    }
+    return gtp::Cause::RequestRejected;
+}
+
+void UdpServer::recordBatch(size_t received) {
+    const size_t batch = m_config.batch_size;
+    m_batches.fetch_add(1, std::memory_order_relaxed);
+    m_batch_datagrams.fetch_add(received, std::memory_order_relaxed);
+    if (received >= batch) m_full_batches.fetch_add(1, std::memory_order_relaxed);
+    if (received == 0) return;
+    const size_t bucket = std::min((received * BatchStats::kBuckets - 1) / batch,
+                                   BatchStats::kBuckets - 1);
+    m_batch_fill[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
 // Закрытие сокета (безопасное)
 void UdpServer::closeSocket(const int& sockfd) noexcept {
     if (sockfd >= 0) close(sockfd);
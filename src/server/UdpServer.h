@@ -4,18 +4,88 @@
 #define UDPSERVER_H
 
 #include <arpa/inet.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <system_error>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
 #include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
 #include <unistd.h>
+#include <nlohmann/json.hpp>
 #include "SessionManager.h"
+#include "IoUring.h"
+#include "ProcessingPool.h"
+#include "RateLimiter.h"
+#include "OverloadController.h"
+#include "ResponseCache.h"
+#include "KernelRxStats.h"
+#include "../TextProtocol.h"
+#include "../GtpMessage.h"
+#include "../ThreadPlacement.h"
+
+// Способ приема датаграмм
+enum class UdpEngine {
+    Blocking,   // Блокирующий recvfrom/recvmmsg в потоке на сокет
+    Epoll,      // Неблокирующие сокеты + epoll, timerfd и eventfd
+    IoUring     // Multishot recvmsg в io_uring с пакетной отправкой ответов
+};
+
+UdpEngine parseUdpEngine(const std::string& name);
+
+// Настройки UDP сервера
+struct UdpServerConfig {
+    uint16_t port = 9000;         // Порт сервера
+    uint16_t batch_size = 1;      // Датаграмм на один вызов recvmmsg/sendmmsg (1 - по одной)
+    std::string ip = "0.0.0.0";   // Адрес для bind
+    uint16_t workers = 1;         // Кол-во сокетов SO_REUSEPORT, каждый со своим потоком
+    UdpEngine engine = UdpEngine::Blocking;
+    uint32_t cleanup_interval_ms = 0; // Период очистки сессий из событийного цикла (0 - не очищать)
+    uint16_t processing_workers = 0;  // Потоки обработки (0 - обработка в потоке приема)
+    uint16_t processing_max_workers = 0; // Предел роста пула обработки (0 - равен processing_workers)
+    uint32_t processing_queue_size = 4096; // Емкость очереди между приемом и обработкой
+    uint32_t overload_target_us = 0;  // Цель задержки до обработки (0 - контроль перегрузки выключен)
+    uint32_t overload_interval_ms = 100; // Сколько задержка держится выше цели до отказов
+    uint32_t response_cache_size = 0; // Записей кэша ответов на повторы (0 - кэш выключен)
+    uint32_t response_cache_window_ms = 2000; // Окно, в котором повтор получает ответ из кэша
+    uint32_t busy_poll_us = 0;        // SO_BUSY_POLL: опрос очереди драйвера при приеме (0 - выключен)
+    uint16_t busy_poll_budget = 0;    // SO_BUSY_POLL_BUDGET: пакетов за один опрос (0 - по умолчанию ядра)
+    bool kernel_stats = false;        // Потери (SO_RXQ_OVFL) и задержка в ядре (SO_TIMESTAMPNS)
+    uint32_t rcvbuf_bytes = 0;        // SO_RCVBUF сокетов (0 - по умолчанию ядра)
+};
+
+// Статистика заполнения пакетов recvmmsg
+struct BatchStats {
+    static constexpr size_t kBuckets = 10;
+
+    uint64_t batches = 0;                       // Кол-во вызовов recvmmsg
+    uint64_t datagrams = 0;                     // Принято датаграмм
+    uint64_t full_batches = 0;                  // Пакеты, заполненные полностью
+    std::array<uint64_t, kBuckets> fill{};      // Гистограмма заполнения по 10%
+    uint64_t malformed_gtp = 0;                 // Отброшено некорректных сообщений GTP
+};
+
+void to_json(nlohmann::json& j, const BatchStats& stats);
+
+// Cause бинарного протокола для результата обработки
+gtp::Cause toGtpCause(SessionResult result);
 
 class UdpServer {
 
 public:
 
-    UdpServer(const uint16_t& port, 
+    UdpServer(const uint16_t& port,
+              std::shared_ptr<ISessionManager> session_manager,
+              std::shared_ptr<Logger> log);
+
+    UdpServer(const UdpServerConfig& config,
               std::shared_ptr<ISessionManager> session_manager,
               std::shared_ptr<Logger> log);
 
@@ -26,35 +96,151 @@ public:
 
     void stop();
 
-    int getSockfd() const; 
+    int getSockfd() const;
+
+    // Сокеты всех рабочих потоков
+    std::vector<int> getSockfds() const;
+
+    // Адрес прослушивания в виде "ip:port"
+    std::string getEndpoint() const;
+
+    // Снимок статистики пакетного приема
+    BatchStats getBatchStats() const;
+
+    // Ограничение запросов по адресу источника (до start(); может быть общим для серверов)
+    void setRateLimiter(std::shared_ptr<RateLimiter> rate_limiter);
+
+    // Датчики очереди обработки (нули, если пул не используется)
+    QueueStats getQueueStats() const;
+
+    // Состояние контроля перегрузки (нули, если выключен)
+    OverloadStats getOverloadStats() const;
+
+    // Счетчики кэша ответов (нули, если выключен)
+    ResponseCacheStats getResponseCacheStats() const;
+
+    // Потери и задержки в ядре по всем сокетам (нули, если kernel_stats выключен)
+    KernelRxStats getKernelRxStats() const;
 
 private:
-    // Создание UDP сокета
+    // Создание UDP сокета рабочего потока
     int createSocket();
 
+    // Включение busy-poll на сокете; без CAP_NET_ADMIN ядро может отказать - не фатально
+    void enableBusyPoll(int sockfd);
+
     // Привязка сокета к порту
     void bindSocket(const int& sockfd);
 
     // Прием и обработка сообщений
     void receiveAndProcess(const int& sockfd);
 
+    struct BatchContext;
+
+    // Пакетный прием и обработка сообщений (recvmmsg/sendmmsg)
+    void receiveAndProcessBatched(const int& sockfd);
+
+    // Один пакет: recvmmsg -> обработка -> sendmmsg, возвращает число принятых датаграмм
+    int processBatch(const int& sockfd, BatchContext& ctx, int flags);
+
+    // Событийный цикл рабочего потока: сокет, таймер очистки и eventfd остановки
+    void runEventLoop(const int& sockfd, bool drive_cleanup);
+
+    // Цикл на io_uring; при недоступности io_uring - синхронный цикл
+    void runIoUringLoop(const int& sockfd);
+
+    // Максимальный размер ответа UE
+    static constexpr size_t kMaxResponseSize = 256;
+
+    // Обработка одного запроса от UE: ответ пишется в буфер вызывающего, возвращается длина
+    // Формат определяется по первому байту: версия GTPv2 или текстовый IMSI
+    // arrival_ns - время прихода датаграммы в ядро (SO_TIMESTAMPNS), 0 - неизвестно
+    size_t processRequest(const char* data, size_t len, const sockaddr_in& client_addr,
+                          int64_t arrival_ns, char* response, size_t capacity);
+
+    // Текстовый запрос "IMSI" или "IMSI#seq"
+    size_t processTextRequest(const char* data, size_t len, int64_t arrival_ns,
+                              char* response, size_t capacity);
+
+    // Ключ кэша ответов; false - в запросе нет номера последовательности
+    static bool requestKey(const char* data, size_t len, const sockaddr_in& client_addr,
+                           ResponseCache::Key& key);
+
+    // Текстовый ответ с номером последовательности запроса (если он был)
+    static size_t writeTextReply(std::string_view reply, bool has_sequence, uint32_t sequence,
+                                 char* response, size_t capacity);
+
+    // Передача запроса в пул обработки или обработка на месте; 0 - отвечать не нужно
+    size_t dispatchRequest(const int& sockfd, const sockaddr_in& client_addr,
+                           const char* data, size_t len, int64_t arrival_ns,
+                           char* response, size_t capacity);
+
+    // Создание/продление сессии; при перегрузке новые сессии не создаются
+    SessionResult admitImsi(std::string_view imsi, int64_t arrival_ns);
+
+    // Место под управляющие сообщения одной датаграммы (SCM_TIMESTAMPNS и SO_RXQ_OVFL)
+    static constexpr size_t kControlSize = CMSG_SPACE(sizeof(timespec)) + CMSG_SPACE(sizeof(uint32_t));
+
+    // Нужны ли управляющие сообщения при приеме
+    bool receivesControl() const { return m_overload || m_config.kernel_stats; }
+
+    // Счетчики ядра для сокета рабочего потока (nullptr, если выключены)
+    KernelRxCounters* rxCounters(int sockfd);
+
+    // Время прихода из управляющих сообщений recvmsg (SCM_TIMESTAMPNS), 0 - нет.
+    // Заодно учитывает потери и задержку в счетчиках сокета
+    static int64_t arrivalTime(const msghdr& msg, KernelRxCounters* rx);
+
+    // Размер буфера приема; без CAP_NET_ADMIN ограничен net.core.rmem_max
+    void setReceiveBuffer(int sockfd);
+
+    // Ответ-отказ без обращения к менеджеру сессий, в формате запроса
+    size_t rejectRequest(const char* data, size_t len, SessionResult result,
+                         char* response, size_t capacity);
+
+    // Create Session Request бинарного протокола; 0 - сообщение отброшено без ответа
+    size_t processGtpRequest(const uint8_t* data, size_t len, int64_t arrival_ns,
+                             uint8_t* response, size_t capacity);
+
+    // Учет заполнения очередного пакета
+    void recordBatch(size_t received);
+
     // Безопасное закрытие сокета
     void closeSocket(const int& sockfd) noexcept;
 
-    std::thread m_udp_server_thread;                   // Поток UDP сервера
+    std::vector<std::thread> m_worker_threads;         // Потоки UDP сервера (по одному на сокет)
 
-    uint16_t m_port;                                   // Порт сервера
+    UdpServerConfig m_config;                          // Настройки сервера
 
     std::shared_ptr<ISessionManager> m_session_manager;// Менеджер сессий
 
     std::shared_ptr<Logger> m_log;                     // Логгер
 
-    int m_sockfd;
+    std::vector<int> m_sockfds;                        // Сокеты рабочих потоков
+
+    int m_stop_eventfd = -1;                           // Сигнал остановки для событийных циклов
+
+    std::unique_ptr<ProcessingPool> m_pool;            // Пул обработки (если включен)
 
-    std::mutex m_queue_mutex;
+    std::shared_ptr<RateLimiter> m_rate_limiter;       // Лимит по источнику (если включен)
+
+    std::unique_ptr<OverloadController> m_overload;    // Контроль перегрузки (если включен)
+
+    std::unique_ptr<ResponseCache> m_response_cache;   // Ответы на повторы (если включен)
+
+    std::vector<std::unique_ptr<KernelRxCounters>> m_rx_counters; // Счетчики ядра по сокетам
+
+    uint64_t m_rcvbuf_bytes = 0;                       // Фактический SO_RCVBUF
 
     std::atomic<bool> m_running;
 
+    // Счетчики пакетного приема
+    std::atomic<uint64_t> m_batches{0};
+    std::atomic<uint64_t> m_batch_datagrams{0};
+    std::atomic<uint64_t> m_full_batches{0};
+    std::array<std::atomic<uint64_t>, BatchStats::kBuckets> m_batch_fill{};
+    std::atomic<uint64_t> m_malformed_gtp{0};
+
 };
 
 #endif // UDPSERVER_H
\ No newline at end of file
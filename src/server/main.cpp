@@ -2,7 +2,19 @@
 
 #include "Core.h"
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Подготовка бинарного черного списка: pgw_server --compile-blacklist <text> <binary>
+    if (argc == 4 && std::string(argv[1]) == "--compile-blacklist") {
+        try {
+            const size_t count = Blacklist::compile(argv[2], argv[3]);
+            spdlog::info("Blacklist compiled: {} IMSI -> {}", count, argv[3]);
+            return 0;
+        } catch (const std::exception& e) {
+            spdlog::critical("Blacklist compile failed: {}", e.what());
+            return 1;
+        }
+    }
+
     spdlog::set_level(spdlog::level::debug);
 
     try {
@@ -11,8 +23,11 @@ int main() {
         core->start();
 
         while (core->isRunning()) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            core->stopIfRequested();
+            core->reloadIfRequested();
         }
+        core->waitForShutdown();
 
         spdlog::info("Server stopped gracefully");
         return 0;
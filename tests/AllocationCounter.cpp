@@ -0,0 +1,92 @@
+//AllocationCounter.cpp
+
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+    thread_local bool g_count_thread = false;
+    thread_local size_t g_thread_allocations = 0;
+
+    std::atomic<bool> g_count_process{false};
+    std::atomic<uint64_t> g_process_allocations{0};
+    std::atomic<uint64_t> g_process_bytes{0};
+
+    void count(std::size_t size) {
+        if (g_count_thread) ++g_thread_allocations;
+        if (g_count_process.load(std::memory_order_relaxed)) {
+            g_process_allocations.fetch_add(1, std::memory_order_relaxed);
+            g_process_bytes.fetch_add(size, std::memory_order_relaxed);
+        }
+    }
+
+    void* allocate(std::size_t size) {
+        count(size);
+        if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+        throw std::bad_alloc();
+    }
+
+    void* allocate(std::size_t size, std::align_val_t alignment) {
+        count(size);
+        // aligned_alloc требует размер, кратный выравниванию
+        const std::size_t align = static_cast<std::size_t>(alignment);
+        const std::size_t rounded = ((size ? size : 1) + align - 1) / align * align;
+        if (void* ptr = std::aligned_alloc(align, rounded)) return ptr;
+        throw std::bad_alloc();
+    }
+
+}
+
+namespace allocationCounter {
+
+    void startThread() {
+        g_thread_allocations = 0;
+        g_count_thread = true;
+    }
+
+    size_t stopThread() {
+        g_count_thread = false;
+        return g_thread_allocations;
+    }
+
+    void enableProcess() {
+        g_count_process.store(true, std::memory_order_relaxed);
+    }
+
+    uint64_t processAllocations() {
+        return g_process_allocations.load(std::memory_order_relaxed);
+    }
+
+    uint64_t processBytes() {
+        return g_process_bytes.load(std::memory_order_relaxed);
+    }
+
+}
+
+// nothrow-варианты стандартной библиотеки вызывают эти же функции
+void* operator new(std::size_t size) { return allocate(size); }
+
+void* operator new[](std::size_t size) { return allocate(size); }
+
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocate(size, alignment); }
+
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocate(size, alignment); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
@@ -0,0 +1,27 @@
+//AllocationCounter.h
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Подсчет выделений памяти для тестов и бенчмарков горячего пути.
+// AllocationCounter.cpp заменяет глобальные operator new/delete (обычные, массивы,
+// с размером и с выравниванием); файл подключается к цели только там, где нужен подсчет.
+// Замена живет в отдельной единице трансляции: компилятор не видит free() за delete
+// в месте вызова и не путает пары new/delete
+namespace allocationCounter {
+
+    // Выделения текущего потока: start сбрасывает счетчик и включает подсчет,
+    // stop выключает и возвращает число выделений с момента start
+    void startThread();
+
+    size_t stopThread();
+
+    // Выделения всех потоков процесса (включая служебные); подсчет включается явно
+    void enableProcess();
+
+    uint64_t processAllocations();
+
+    uint64_t processBytes();
+
+};
@@ -0,0 +1,77 @@
+//ClockTest.cpp
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include "../src/Clock.h"
+
+namespace {
+
+    uint64_t systemWallMs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+}
+
+TEST(ClockTest, ReadsClocksDirectlyWithoutTicker) {
+    ASSERT_FALSE(coarseClock::isTicking());
+    const uint64_t before = coarseClock::monotonicMs();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_GE(coarseClock::monotonicMs() - before, 5u);
+
+    const uint64_t wall = coarseClock::wallMs();
+    EXPECT_LE(wall > systemWallMs() ? wall - systemWallMs() : systemWallMs() - wall, 5u);
+}
+
+TEST(ClockTest, TickerPublishesTimeAndStopsWithLastUser) {
+    coarseClock::start(std::chrono::milliseconds(1));
+    coarseClock::start(std::chrono::milliseconds(1));
+    ASSERT_TRUE(coarseClock::isTicking());
+
+    const uint64_t before = coarseClock::monotonicMs();
+    uint64_t previous = before;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+    while (std::chrono::steady_clock::now() < deadline) {
+        const uint64_t now = coarseClock::monotonicMs();
+        ASSERT_GE(now, previous);
+        previous = now;
+    }
+    // Тикер продвигает время: за 50 мс хотя бы на 20 мс даже на загруженной машине
+    EXPECT_GE(previous - before, 20u);
+    const uint64_t wall = coarseClock::wallMs();
+    EXPECT_LE(systemWallMs() - wall, 100u);
+
+    coarseClock::stop();
+    EXPECT_TRUE(coarseClock::isTicking());
+    coarseClock::stop();
+    EXPECT_FALSE(coarseClock::isTicking());
+    // Без тикера время не идет назад
+    EXPECT_GE(coarseClock::monotonicMs(), previous);
+    coarseClock::stop();
+    EXPECT_FALSE(coarseClock::isTicking());
+}
+
+TEST(ClockTest, FormatsLocalTimestampIntoThreadBuffer) {
+    // На границе секунды метка может смениться между чтением и сверкой - повтор
+    bool matched = false;
+    for (int attempt = 0; attempt < 3 && !matched; ++attempt) {
+        const std::string_view text = coarseClock::timestamp();
+        ASSERT_EQ(text.size(), coarseClock::kTimestampLength);
+        const std::time_t now_time = std::time_t(coarseClock::wallMs() / 1000);
+        std::tm local_time{};
+        localtime_r(&now_time, &local_time);
+        char expected[coarseClock::kTimestampLength + 1];
+        std::strftime(expected, sizeof(expected), "%Y-%m-%d %H:%M:%S", &local_time);
+        matched = text == std::string_view(expected);
+    }
+    EXPECT_TRUE(matched);
+
+    // Буфер свой у каждого потока
+    const char* own = coarseClock::timestamp().data();
+    EXPECT_EQ(coarseClock::timestamp().data(), own);
+    const char* other = nullptr;
+    std::thread([&]() { other = coarseClock::timestamp().data(); }).join();
+    EXPECT_NE(other, own);
+}
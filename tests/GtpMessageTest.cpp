@@ -0,0 +1,73 @@
+//GtpMessageTest.cpp
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include "../src/GtpMessage.h"
+
+TEST(GtpMessageTest, RequestRoundTrip) {
+    uint8_t buffer[64];
+    const size_t length = gtp::encodeCreateSessionRequest(buffer, sizeof(buffer), "001010123456789", 0x123456);
+    ASSERT_EQ(length, gtp::kHeaderSize + gtp::kIeHeaderSize + gtp::kImsiBcdSize);
+    EXPECT_TRUE(gtp::isGtpMessage(buffer, length));
+
+    gtp::MessageView message(buffer, length);
+    ASSERT_TRUE(message.valid());
+    EXPECT_EQ(message.type(), gtp::MessageType::CreateSessionRequest);
+    EXPECT_EQ(message.sequence(), 0x123456u);
+
+    gtp::IeView ie{};
+    ASSERT_TRUE(message.findIe(gtp::IeType::Imsi, ie));
+    char digits[gtp::kMaxImsiDigits];
+    const size_t count = gtp::decodeImsi(ie, digits, sizeof(digits));
+    EXPECT_EQ(std::string(digits, count), "001010123456789");
+}
+
+TEST(GtpMessageTest, EncodesShortImsiWithFiller) {
+    uint8_t buffer[64];
+    const size_t length = gtp::encodeCreateSessionRequest(buffer, sizeof(buffer), "12345", 1);
+    ASSERT_GT(length, 0u);
+    const uint8_t* bcd = buffer + gtp::kHeaderSize + gtp::kIeHeaderSize;
+    EXPECT_EQ(bcd[0], 0x21);
+    EXPECT_EQ(bcd[1], 0x43);
+    EXPECT_EQ(bcd[2], 0xF5);
+    EXPECT_EQ(bcd[3], 0xFF);
+
+    gtp::MessageView message(buffer, length);
+    gtp::IeView ie{};
+    ASSERT_TRUE(message.findIe(gtp::IeType::Imsi, ie));
+    char digits[gtp::kMaxImsiDigits];
+    EXPECT_EQ(std::string(digits, gtp::decodeImsi(ie, digits, sizeof(digits))), "12345");
+}
+
+TEST(GtpMessageTest, RejectsInvalidInput) {
+    uint8_t buffer[64];
+    EXPECT_EQ(gtp::encodeCreateSessionRequest(buffer, sizeof(buffer), "12a45", 1), 0u);
+    EXPECT_EQ(gtp::encodeCreateSessionRequest(buffer, sizeof(buffer), "1234567890123456", 1), 0u);
+    EXPECT_EQ(gtp::encodeCreateSessionRequest(buffer, 10, "12345", 1), 0u);
+
+    // Заявленная длина больше датаграммы
+    const size_t length = gtp::encodeCreateSessionRequest(buffer, sizeof(buffer), "12345", 1);
+    EXPECT_FALSE(gtp::MessageView(buffer, length - 1).valid());
+
+    // IE выходит за границу сообщения
+    buffer[gtp::kHeaderSize + 2] = 0x20;
+    EXPECT_FALSE(gtp::MessageView(buffer, length).valid());
+}
+
+TEST(GtpMessageTest, DistinguishesTextImsi) {
+    const char* imsi = "001010123456789";
+    EXPECT_FALSE(gtp::isGtpMessage(reinterpret_cast<const uint8_t*>(imsi), std::strlen(imsi)));
+}
+
+TEST(GtpMessageTest, ResponseCarriesCause) {
+    uint8_t buffer[64];
+    const size_t length = gtp::encodeCreateSessionResponse(buffer, sizeof(buffer), 77, gtp::Cause::ContextExists);
+    gtp::MessageView message(buffer, length);
+    ASSERT_TRUE(message.valid());
+    EXPECT_EQ(message.type(), gtp::MessageType::CreateSessionResponse);
+    EXPECT_EQ(message.sequence(), 77u);
+
+    gtp::IeView ie{};
+    ASSERT_TRUE(message.findIe(gtp::IeType::Cause, ie));
+    EXPECT_EQ(gtp::causeToText(static_cast<gtp::Cause>(ie.value[0])), "exists");
+}
@@ -129,4 +129,34 @@ TEST(LoggerTest, HandlesLargeMessages) {
     EXPECT_GE(content.size(), big_msg.size());
     
     std::remove(path.c_str());
-}
\ No newline at end of file
+}
+
+TEST(LoggerTest, FiltersMessagesBelowLevel) {
+    const std::string path = "test_level.log";
+    Logger logger(path);
+    logger.setLevel(LogLevel::Info);
+    EXPECT_FALSE(logger.isEnabled(LogLevel::Debug));
+    EXPECT_TRUE(logger.isEnabled(LogLevel::Error));
+
+    logger.start();
+    logger.sendToLog(LogLevel::Debug, "Debug message");
+    logger.sendToLog(LogLevel::Warning, "Warning message");
+    logger.flush();
+    logger.stop();
+
+    std::ifstream log_file(path);
+    std::string content((std::istreambuf_iterator<char>(log_file)),
+                       std::istreambuf_iterator<char>());
+    EXPECT_EQ(content.find("Debug message"), std::string::npos);
+    EXPECT_NE(content.find("Warning message"), std::string::npos);
+
+    std::remove(path.c_str());
+}
+
+TEST(LoggerTest, ParsesLevelNames) {
+    EXPECT_EQ(Logger::parseLevel("DEBUG"), LogLevel::Debug);
+    EXPECT_EQ(Logger::parseLevel("INFO"), LogLevel::Info);
+    EXPECT_EQ(Logger::parseLevel("WARN"), LogLevel::Warning);
+    EXPECT_EQ(Logger::parseLevel("ERROR"), LogLevel::Error);
+    EXPECT_THROW(Logger::parseLevel("LOUD"), std::invalid_argument);
+}
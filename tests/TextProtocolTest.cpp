@@ -0,0 +1,27 @@
+//TextProtocolTest.cpp
+
+#include <gtest/gtest.h>
+#include "../src/TextProtocol.h"
+
+TEST(TextProtocolTest, SplitsSequence) {
+    std::string_view body;
+    uint32_t sequence = 0;
+    EXPECT_TRUE(textProtocol::splitSequence("001010123456789#42", body, sequence));
+    EXPECT_EQ(body, "001010123456789");
+    EXPECT_EQ(sequence, 42u);
+
+    EXPECT_TRUE(textProtocol::splitSequence("rejected (overload)#7", body, sequence));
+    EXPECT_EQ(body, "rejected (overload)");
+    EXPECT_EQ(sequence, 7u);
+}
+
+TEST(TextProtocolTest, KeepsMessageWithoutValidSequence) {
+    std::string_view body;
+    uint32_t sequence = 0;
+    EXPECT_FALSE(textProtocol::splitSequence("001010123456789", body, sequence));
+    EXPECT_EQ(body, "001010123456789");
+    EXPECT_FALSE(textProtocol::splitSequence("001010123456789#", body, sequence));
+    EXPECT_FALSE(textProtocol::splitSequence("001010123456789#4x", body, sequence));
+    EXPECT_FALSE(textProtocol::splitSequence("001010123456789#99999999999", body, sequence));
+    EXPECT_EQ(body, "001010123456789#99999999999");
+}
@@ -0,0 +1,95 @@
+//ThreadPlacementTest.cpp
+
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include <sched.h>
+#include <thread>
+#include "../src/ThreadPlacement.h"
+
+namespace {
+
+    // Ядра, доступные процессу (в контейнере может быть не все)
+    std::vector<int> allowedCpus() {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        sched_getaffinity(0, sizeof(set), &set);
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    struct Placement {
+        std::string name;
+        std::vector<int> cpus;
+    };
+
+    // Применить роль в отдельном потоке и вернуть его имя и маску ядер
+    Placement placeThread(const std::string& role, int index) {
+        Placement result;
+        std::thread([&]() {
+            if (index < 0) {
+                threadPlacement::apply(role);
+            } else {
+                threadPlacement::apply(role, index);
+            }
+            char name[16] = {};
+            pthread_getname_np(pthread_self(), name, sizeof(name));
+            result.name = name;
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) result.cpus.push_back(cpu);
+            }
+        }).join();
+        return result;
+    }
+
+}
+
+TEST(ThreadPlacementTest, ParsesCpuList) {
+    EXPECT_EQ(threadPlacement::parseCpuList("0-3, 8,10-11"),
+              (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_TRUE(threadPlacement::parseCpuList("").empty());
+    EXPECT_THROW(threadPlacement::parseCpuList("3-1"), std::invalid_argument);
+    EXPECT_THROW(threadPlacement::parseCpuList("a"), std::invalid_argument);
+    EXPECT_THROW(threadPlacement::parseCpuList("-1"), std::invalid_argument);
+}
+
+TEST(ThreadPlacementTest, NamesAndPinsThreads) {
+    const std::vector<int> cpus = allowedCpus();
+    ASSERT_FALSE(cpus.empty());
+
+    threadPlacement::configure(nlohmann::json::parse(R"({
+        "udp": {"name": "pgw-udp", "cpus": [)" + std::to_string(cpus.front()) + R"(]},
+        "http": {"name": "a-very-long-thread-name"},
+        "busy_poll_us": 50
+    })"));
+
+    const Placement udp = placeThread("udp", 1);
+    EXPECT_EQ(udp.name, "pgw-udp-1");
+    EXPECT_EQ(udp.cpus, std::vector<int>{cpus.front()});
+
+    // Имя обрезается до 15 символов, без ядер маска не меняется
+    const Placement http = placeThread("http", -1);
+    EXPECT_EQ(http.name, "a-very-long-thr");
+    EXPECT_EQ(http.cpus, cpus);
+
+    // Роль без настроек получает имя по умолчанию
+    EXPECT_EQ(placeThread("cleanup", -1).name, "pgw-cleanup");
+
+    threadPlacement::clear();
+}
+
+TEST(ThreadPlacementTest, PinEachSpreadsThreadsOverCpus) {
+    const std::vector<int> cpus = allowedCpus();
+    if (cpus.size() < 2) GTEST_SKIP() << "Needs at least two CPUs";
+
+    threadPlacement::setRole("processing", ThreadRole{{cpus[0], cpus[1]}, "proc", true});
+    EXPECT_EQ(placeThread("processing", 0).cpus, std::vector<int>{cpus[0]});
+    EXPECT_EQ(placeThread("processing", 1).cpus, std::vector<int>{cpus[1]});
+    EXPECT_EQ(placeThread("processing", 2).cpus, std::vector<int>{cpus[0]});
+    threadPlacement::clear();
+}
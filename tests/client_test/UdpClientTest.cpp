@@ -0,0 +1,75 @@
+//UdpClientTest.cpp
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../src/client/UdpClient.h"
+
+namespace {
+
+    const uint16_t FAKE_SERVER_PORT = 54330;
+
+    // Сервер, который теряет первые lost запросов, затем отвечает reply#seq
+    void runLossyServer(int sock, int lost, int answered, std::vector<std::string>& received) {
+        char buffer[256];
+        sockaddr_in client_addr{};
+        socklen_t len = sizeof(client_addr);
+        for (int i = 0; i < lost + answered; ++i) {
+            ssize_t n = recvfrom(sock, buffer, sizeof(buffer), 0, (sockaddr*)&client_addr, &len);
+            if (n <= 0) return;
+            received.emplace_back(buffer, n);
+            if (i < lost) continue;
+            const std::string request(buffer, n);
+            const std::string reply = "created" + request.substr(request.find('#'));
+            // Сначала опоздавший ответ на чужой номер - клиент должен его пропустить
+            sendto(sock, "exists#999", 10, 0, (sockaddr*)&client_addr, len);
+            sendto(sock, reply.data(), reply.size(), 0, (sockaddr*)&client_addr, len);
+        }
+    }
+
+    int bindFakeServer() {
+        int sock = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(FAKE_SERVER_PORT);
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        bind(sock, (sockaddr*)&addr, sizeof(addr));
+        return sock;
+    }
+
+}
+
+TEST(UdpClientTest, RetransmitsWithSameSequence) {
+    auto logger = std::make_shared<Logger>("test_client.log");
+    int server_sock = bindFakeServer();
+    std::vector<std::string> received;
+    std::thread server(runLossyServer, server_sock, 2, 1, std::ref(received));
+
+    UdpClient client("127.0.0.1", FAKE_SERVER_PORT, logger);
+    client.setRetryPolicy(2, 100);
+    EXPECT_EQ(client.sendRequest("001010000000990"), "created");
+    server.join();
+    close(server_sock);
+
+    ASSERT_EQ(received.size(), 3u);
+    EXPECT_EQ(received[0], "001010000000990#1");
+    EXPECT_EQ(received[1], received[0]);
+    EXPECT_EQ(received[2], received[0]);
+}
+
+TEST(UdpClientTest, GivesUpAfterRetries) {
+    auto logger = std::make_shared<Logger>("test_client.log");
+    int server_sock = bindFakeServer();
+    std::vector<std::string> received;
+    std::thread server(runLossyServer, server_sock, 2, 0, std::ref(received));
+
+    UdpClient client("127.0.0.1", FAKE_SERVER_PORT, logger);
+    client.setRetryPolicy(1, 50);
+    EXPECT_EQ(client.sendRequest("001010000000991"), "error");
+    server.join();
+    close(server_sock);
+    EXPECT_EQ(received.size(), 2u);
+}
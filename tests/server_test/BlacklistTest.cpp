@@ -0,0 +1,178 @@
+//BlacklistTest.cpp
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include "../src/server/Blacklist.h"
+#include "../src/server/SessionTable.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    std::string tempPath(const std::string& name) {
+        return (fs::temp_directory_path() / (name + std::to_string(::getpid()))).string();
+    }
+
+    std::string imsiFor(uint64_t n) {
+        std::string imsi = std::to_string(n);
+        return std::string(15 - imsi.size(), '0') + imsi;
+    }
+
+}
+
+TEST(BlacklistTest, LoadsTextFileAndConfigList) {
+    const std::string path = tempPath("blacklist_text_");
+    {
+        std::ofstream file(path);
+        file << "# operator blacklist\n"
+             << "001010000000005\n"
+             << "  001010000000003  # trailing comment\r\n"
+             << "\n"
+             << "001010000000005\n"
+             << "not-an-imsi\n"
+             << "1234567890123456\n";
+    }
+
+    Blacklist blacklist({"001010000000001"}, path);
+    EXPECT_TRUE(blacklist.contains(std::string_view("001010000000001")));
+    EXPECT_TRUE(blacklist.contains(std::string_view("001010000000003")));
+    EXPECT_TRUE(blacklist.contains(std::string_view("001010000000005")));
+    EXPECT_FALSE(blacklist.contains(std::string_view("001010000000004")));
+    EXPECT_FALSE(blacklist.contains(std::string_view("01010000000005")));
+
+    const BlacklistStats stats = blacklist.getStats();
+    EXPECT_EQ(stats.entries, 3u);
+    EXPECT_EQ(stats.file_entries, 3u);
+    EXPECT_EQ(stats.invalid_entries, 2u);
+    EXPECT_FALSE(stats.mapped);
+    EXPECT_GT(stats.bloom_bytes, 0u);
+
+    EXPECT_THROW(Blacklist({}, path + ".missing"), std::runtime_error);
+    fs::remove(path);
+}
+
+TEST(BlacklistTest, MapsCompiledBinaryFile) {
+    const std::string text_path = tempPath("blacklist_src_");
+    const std::string binary_path = tempPath("blacklist_bin_");
+    constexpr uint64_t kEntries = 200000;
+    {
+        // Нечетные номера в обратном порядке: компиляция сортирует
+        std::ofstream file(text_path);
+        for (uint64_t i = kEntries; i > 0; --i) file << imsiFor(2 * i + 1) << '\n';
+    }
+    ASSERT_EQ(Blacklist::compile(text_path, binary_path), kEntries);
+    EXPECT_EQ(fs::file_size(binary_path), 16 + kEntries * sizeof(uint64_t));
+
+    Blacklist blacklist({"001010000000001"}, binary_path);
+    const BlacklistStats stats = blacklist.getStats();
+    EXPECT_TRUE(stats.mapped);
+    EXPECT_EQ(stats.file_entries, kEntries);
+    EXPECT_EQ(stats.entries, kEntries + 1);
+    EXPECT_EQ(stats.mapped_bytes, 16 + kEntries * sizeof(uint64_t));
+    // В памяти процесса остается фильтр Блума: ~10 бит на ключ
+    EXPECT_LT(stats.memory_bytes, kEntries * 2);
+
+    EXPECT_TRUE(blacklist.contains(std::string_view("001010000000001")));
+    for (uint64_t i = 1; i <= kEntries; ++i) {
+        ASSERT_TRUE(blacklist.contains(std::string_view(imsiFor(2 * i + 1)))) << i;
+        ASSERT_FALSE(blacklist.contains(std::string_view(imsiFor(2 * i)))) << i;
+    }
+    EXPECT_FALSE(blacklist.contains(uint64_t(0)));
+
+    // Бинарный образ повторно не компилируется, испорченный не загружается
+    EXPECT_THROW(Blacklist::compile(binary_path, text_path + ".out"), std::runtime_error);
+    fs::resize_file(binary_path, fs::file_size(binary_path) - 4);
+    EXPECT_THROW(Blacklist({}, binary_path), std::runtime_error);
+
+    fs::remove(text_path);
+    fs::remove(binary_path);
+}
+
+TEST(BlacklistTest, RecompileKeepsMappedImageOfRunningServer) {
+    const std::string text_path = tempPath("blacklist_recompile_src_");
+    const std::string binary_path = tempPath("blacklist_recompile_bin_");
+    constexpr uint64_t kEntries = 100000;
+    {
+        std::ofstream file(text_path);
+        for (uint64_t i = 1; i <= kEntries; ++i) file << imsiFor(2 * i + 1) << '\n';
+    }
+    ASSERT_EQ(Blacklist::compile(text_path, binary_path), kEntries);
+    Blacklist running({}, binary_path);
+    ASSERT_TRUE(running.getStats().mapped);
+
+    // Новый список короче прежнего: перезапись на месте усекла бы отображенный файл
+    {
+        std::ofstream file(text_path);
+        file << imsiFor(4) << '\n';
+    }
+    ASSERT_EQ(Blacklist::compile(text_path, binary_path), 1u);
+    EXPECT_FALSE(fs::exists(binary_path + ".tmp"));
+    for (uint64_t i = 1; i <= kEntries; ++i) {
+        ASSERT_TRUE(running.contains(std::string_view(imsiFor(2 * i + 1)))) << i;
+    }
+    EXPECT_FALSE(running.contains(std::string_view(imsiFor(4))));
+
+    // Перезагрузка видит новый образ
+    Blacklist reloaded({}, binary_path);
+    EXPECT_TRUE(reloaded.contains(std::string_view(imsiFor(4))));
+    EXPECT_FALSE(reloaded.contains(std::string_view(imsiFor(3))));
+    EXPECT_EQ(reloaded.getStats().file_entries, 1u);
+
+    fs::remove(text_path);
+    fs::remove(binary_path);
+}
+
+TEST(BlacklistTest, BloomFilterRejectsMostNegatives) {
+    std::vector<std::string> imsis;
+    for (uint64_t i = 0; i < 100000; ++i) imsis.push_back(imsiFor(i * 7919 + 11));
+    Blacklist blacklist(imsis);
+
+    for (const std::string& imsi : imsis) {
+        ASSERT_TRUE(blacklist.mayContain(imsiKey::pack(imsi))) << imsi;
+    }
+    // Ключи не из списка: фильтр отсекает ~99%, остальное отсекает двоичный поиск
+    std::mt19937_64 rng(17);
+    size_t passed = 0;
+    size_t found = 0;
+    constexpr size_t kProbes = 100000;
+    for (size_t i = 0; i < kProbes; ++i) {
+        const uint64_t n = 1000000000 + rng() % 1000000000;
+        const uint64_t key = imsiKey::pack(imsiFor(n));
+        passed += blacklist.mayContain(key);
+        found += blacklist.contains(key);
+    }
+    EXPECT_LT(passed, kProbes / 50);
+    EXPECT_EQ(found, 0u);
+}
+
+TEST(BlacklistTest, AppliesPrefixAndRangeRules) {
+    const std::string path = tempPath("blacklist_rules_");
+    {
+        std::ofstream file(path);
+        file << "00199*          # test PLMN\n"
+             << "250010000000000-250010000099999\n"
+             << "250019-250011\n";
+    }
+    Blacklist blacklist({"001010000000001", "31026*"}, path);
+    EXPECT_TRUE(blacklist.contains(std::string_view("001010000000001")));
+    EXPECT_TRUE(blacklist.contains(std::string_view("001990000000001")));
+    EXPECT_TRUE(blacklist.contains(std::string_view("3102612345")));
+    EXPECT_TRUE(blacklist.contains(std::string_view("250010000000000")));
+    EXPECT_TRUE(blacklist.contains(std::string_view("250010000099999")));
+    EXPECT_FALSE(blacklist.contains(std::string_view("250010000100000")));
+    EXPECT_FALSE(blacklist.contains(std::string_view("00198999999999")));
+
+    const BlacklistStats stats = blacklist.getStats();
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_EQ(stats.prefix_rules, 2u);
+    EXPECT_EQ(stats.range_rules, 1u);
+    EXPECT_EQ(stats.invalid_entries, 1u);
+    EXPECT_GT(stats.trie_nodes, 0u);
+
+    // Правила в бинарный образ не входят
+    EXPECT_THROW(Blacklist::compile(path, path + ".bin"), std::runtime_error);
+    fs::remove(path);
+    fs::remove(path + ".bin");
+}
@@ -0,0 +1,54 @@
+//DigitTrieTest.cpp
+
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include "../src/server/DigitTrie.h"
+
+namespace {
+
+    std::string padded(uint64_t n, size_t length) {
+        std::string digits = std::to_string(n);
+        return std::string(length - digits.size(), '0') + digits;
+    }
+
+}
+
+TEST(DigitTrieTest, PrefixMatchesAnyLengthFromItsDepth) {
+    DigitTrie trie;
+    EXPECT_FALSE(trie.matches("001010123456789"));
+    trie.addPrefix("00101");
+    EXPECT_TRUE(trie.matches("00101"));
+    EXPECT_TRUE(trie.matches("001010123456789"));
+    EXPECT_FALSE(trie.matches("0010"));
+    EXPECT_FALSE(trie.matches("001020123456789"));
+    EXPECT_EQ(trie.rules(), 1u);
+
+    EXPECT_THROW(trie.addPrefix(""), std::invalid_argument);
+    EXPECT_THROW(trie.addPrefix("00a"), std::invalid_argument);
+    EXPECT_THROW(trie.addRange("123", "1234"), std::invalid_argument);
+    EXPECT_THROW(trie.addRange("200", "100"), std::invalid_argument);
+}
+
+TEST(DigitTrieTest, RangesMatchExactlyTheirNumbersAndLength) {
+    std::mt19937_64 rng(18);
+    for (int round = 0; round < 200; ++round) {
+        const size_t length = 1 + rng() % 6;
+        uint64_t limit = 1;
+        for (size_t i = 0; i < length; ++i) limit *= 10;
+        uint64_t first = rng() % limit;
+        uint64_t last = rng() % limit;
+        if (first > last) std::swap(first, last);
+
+        DigitTrie trie;
+        trie.addRange(padded(first, length), padded(last, length));
+        // Диапазон из префиксов не больше 2*9 на разряд
+        ASSERT_LE(trie.nodes(), 1 + 2 * 10 * length * length);
+        for (uint64_t n = 0; n < limit; ++n) {
+            ASSERT_EQ(trie.matches(padded(n, length)), n >= first && n <= last)
+                << first << "-" << last << " probe " << n;
+        }
+        // IMSI другой длины с тем же началом в диапазон не попадают
+        EXPECT_FALSE(trie.matches(padded(first, length) + "0"));
+    }
+}
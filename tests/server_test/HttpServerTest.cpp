@@ -153,4 +153,61 @@ TEST(HttpServerCommandTest, HandlesStopCommand) {
     
     // Даем время на остановку
     std::this_thread::sleep_for(std::chrono::milliseconds(200));
-}
\ No newline at end of file
+}
+
+TEST(HttpServerRequestTest, ExposesRegisteredMetrics) {
+    auto logger = std::make_shared<Logger>("test_http.log");
+    auto session_mgr = std::make_shared<SessionManager>(60, 100, "test_cdr.csv", std::vector<std::string>{}, logger);
+
+    const uint16_t port = get_random_port();
+    HttpServer server(port, session_mgr, logger);
+    server.addMetricsSource("test", []() {
+        return nlohmann::json{{"counter", 42}};
+    });
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    httplib::Client client("localhost", port);
+    auto res = client.Get("/metrics");
+
+    ASSERT_TRUE(res);
+    EXPECT_EQ(res->status, 200);
+    auto body = nlohmann::json::parse(res->body);
+    EXPECT_EQ(body["test"]["counter"], 42);
+
+    server.stop();
+}
+
+TEST(HttpServerCommandTest, RunsRegisteredAdminCommands) {
+    auto logger = std::make_shared<Logger>("test_http.log");
+    auto session_mgr = std::make_shared<SessionManager>(60, 100, "test_cdr.csv", std::vector<std::string>{}, logger);
+
+    const uint16_t port = get_random_port();
+    HttpServer server(port, session_mgr, logger);
+    int reloads = 0;
+    server.addAdminCommand("reload", [&reloads]() {
+        return nlohmann::json{{"reloads", ++reloads}};
+    });
+    server.addAdminCommand("broken", []() -> nlohmann::json {
+        throw std::runtime_error("bad config");
+    });
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    httplib::Client client("localhost", port);
+    auto res = client.Post("/admin/reload");
+    ASSERT_TRUE(res);
+    EXPECT_EQ(res->status, 200);
+    EXPECT_EQ(nlohmann::json::parse(res->body)["reloads"], 1);
+
+    res = client.Post("/admin/broken");
+    ASSERT_TRUE(res);
+    EXPECT_EQ(res->status, 500);
+    EXPECT_EQ(nlohmann::json::parse(res->body)["error"], "bad config");
+
+    res = client.Post("/admin/unknown");
+    ASSERT_TRUE(res);
+    EXPECT_EQ(res->status, 404);
+
+    server.stop();
+}
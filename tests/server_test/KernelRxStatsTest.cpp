@@ -0,0 +1,43 @@
+//KernelRxStatsTest.cpp
+
+#include <gtest/gtest.h>
+#include "../src/server/KernelRxStats.h"
+
+TEST(KernelRxStatsTest, BucketsDelayByPowersOfTwo) {
+    EXPECT_EQ(KernelRxCounters::delayBucket(0), 0u);
+    EXPECT_EQ(KernelRxCounters::delayBucket(1), 1u);
+    EXPECT_EQ(KernelRxCounters::delayBucket(3), 2u);
+    EXPECT_EQ(KernelRxCounters::delayBucket(4), 3u);
+    EXPECT_EQ(KernelRxCounters::delayBucket(1000000000), KernelRxStats::kDelayBuckets - 1);
+
+    KernelRxCounters counters;
+    counters.recordDelay(500);          // 0 мкс
+    counters.recordDelay(3000);         // 3 мкс
+    counters.recordDelay(-1000);        // часы ушли назад
+    KernelRxStats stats;
+    counters.addTo(stats);
+    EXPECT_EQ(stats.datagrams, 3u);
+    EXPECT_EQ(stats.delay_histogram[0], 2u);
+    EXPECT_EQ(stats.delay_histogram[2], 1u);
+    EXPECT_EQ(stats.delay_max_us, 3u);
+    EXPECT_EQ(stats.delay_sum_us, 3u);
+}
+
+TEST(KernelRxStatsTest, CountsDropsFromCumulativeCounter) {
+    KernelRxCounters first, second;
+    first.recordDrops(5);
+    first.recordDrops(5);               // новых потерь нет
+    first.recordDrops(12);
+    second.recordDrops(0xFFFFFFFE);
+    second.recordDrops(3);              // счетчик ядра переполнился
+
+    KernelRxStats stats;
+    first.addTo(stats);
+    second.addTo(stats);
+    EXPECT_EQ(stats.sockets, 2u);
+    EXPECT_EQ(stats.drops, 12u + 0xFFFFFFFEull + 5u);
+
+    const nlohmann::json json = stats;
+    EXPECT_EQ(json["delay_histogram"].size(), KernelRxStats::kDelayBuckets);
+    EXPECT_EQ(json["delay_histogram"].back()["lt_us"], "inf");
+}
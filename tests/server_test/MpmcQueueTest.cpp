@@ -0,0 +1,63 @@
+//MpmcQueueTest.cpp
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "../src/server/MpmcQueue.h"
+
+TEST(MpmcQueueTest, RoundsCapacityAndKeepsOrder) {
+    MpmcQueue<int> queue(5);
+    EXPECT_EQ(queue.capacity(), 8u);
+
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_TRUE(queue.tryPush(i));
+    }
+    EXPECT_FALSE(queue.tryPush(8));
+    EXPECT_EQ(queue.sizeApprox(), 8u);
+
+    int value = -1;
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(queue.tryPop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.tryPop(value));
+    EXPECT_EQ(queue.sizeApprox(), 0u);
+}
+
+TEST(MpmcQueueTest, DeliversEachItemOnceUnderContention) {
+    constexpr int kProducers = 4;
+    constexpr int kConsumers = 4;
+    constexpr int kPerProducer = 50000;
+    MpmcQueue<int> queue(1024);
+
+    std::atomic<int> consumed{0};
+    std::atomic<long long> sum{0};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < kProducers; ++p) {
+        threads.emplace_back([&, p]() {
+            for (int i = 0; i < kPerProducer; ++i) {
+                const int value = p * kPerProducer + i;
+                while (!queue.tryPush(value)) std::this_thread::yield();
+            }
+        });
+    }
+    for (int c = 0; c < kConsumers; ++c) {
+        threads.emplace_back([&]() {
+            int value;
+            while (consumed.load() < kProducers * kPerProducer) {
+                if (queue.tryPop(value)) {
+                    sum += value;
+                    ++consumed;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    const long long total = static_cast<long long>(kProducers) * kPerProducer;
+    EXPECT_EQ(consumed.load(), total);
+    EXPECT_EQ(sum.load(), total * (total - 1) / 2);
+}
@@ -0,0 +1,46 @@
+//OverloadControllerTest.cpp
+
+#include <gtest/gtest.h>
+#include "../src/server/OverloadController.h"
+
+namespace {
+
+    constexpr int64_t kMs = 1000000;
+
+}
+
+TEST(OverloadControllerTest, IgnoresShortBursts) {
+    OverloadController controller(OverloadConfig{5000, 100});
+
+    // Задержка выше цели, но меньше интервала - это всплеск, а не перегрузка
+    int64_t now = 1000 * kMs;
+    for (int i = 0; i < 50; ++i, now += kMs) {
+        EXPECT_FALSE(controller.observe(now - 20 * kMs, now));
+    }
+    // Очередь разошлась - отсчет интервала начинается заново
+    EXPECT_FALSE(controller.observe(now - kMs, now));
+    now += 80 * kMs;
+    EXPECT_FALSE(controller.observe(now - 20 * kMs, now));
+    EXPECT_EQ(controller.getStats().episodes, 0u);
+}
+
+TEST(OverloadControllerTest, EntersAndLeavesOverload) {
+    OverloadController controller(OverloadConfig{5000, 100});
+
+    int64_t now = 1000 * kMs;
+    EXPECT_FALSE(controller.observe(now - 10 * kMs, now));
+    now += 50 * kMs;
+    EXPECT_FALSE(controller.observe(now - 10 * kMs, now));
+    now += 51 * kMs;
+    EXPECT_TRUE(controller.observe(now - 10 * kMs, now));
+    EXPECT_TRUE(controller.getStats().overloaded);
+
+    // Первая датаграмма с задержкой ниже цели снимает перегрузку
+    EXPECT_FALSE(controller.observe(now - kMs, now));
+
+    const OverloadStats stats = controller.getStats();
+    EXPECT_FALSE(stats.overloaded);
+    EXPECT_EQ(stats.episodes, 1u);
+    EXPECT_EQ(stats.last_sojourn_us, 1000u);
+    EXPECT_EQ(stats.max_sojourn_us, 10000u);
+}
@@ -0,0 +1,71 @@
+//ProcessingPoolTest.cpp
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "../src/server/ProcessingPool.h"
+
+namespace {
+
+    // Запрос без ответа (сокет не нужен)
+    size_t submitMany(ProcessingPool& pool, size_t count) {
+        sockaddr_in addr{};
+        size_t accepted = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (pool.submit(-1, addr, "x", 1)) ++accepted;
+        }
+        return accepted;
+    }
+
+}
+
+TEST(ProcessingPoolTest, ProcessesSubmittedRequests) {
+    auto logger = std::make_shared<Logger>("test_pool.log");
+    std::atomic<int> handled{0};
+    ProcessingPoolConfig config;
+    config.min_workers = 2;
+    config.max_workers = 2;
+    ProcessingPool pool(config, [&](const char*, size_t len, const sockaddr_in&, int64_t, char*, size_t) {
+        handled += static_cast<int>(len);
+        return size_t{0};
+    }, logger);
+    pool.start();
+
+    EXPECT_EQ(submitMany(pool, 1000), 1000u);
+    pool.stop();
+
+    // stop() дорабатывает очередь
+    EXPECT_EQ(handled.load(), 1000);
+    const QueueStats stats = pool.getStats();
+    EXPECT_EQ(stats.enqueued, 1000u);
+    EXPECT_EQ(stats.processed, 1000u);
+    EXPECT_EQ(stats.depth, 0u);
+}
+
+TEST(ProcessingPoolTest, GrowsWithQueueDepthAndDropsWhenFull) {
+    auto logger = std::make_shared<Logger>("test_pool.log");
+    ProcessingPoolConfig config;
+    config.min_workers = 1;
+    config.max_workers = 4;
+    config.queue_capacity = 256;
+    config.scale_interval_ms = 1;
+    ProcessingPool pool(config, [](const char*, size_t, const sockaddr_in&, int64_t, char*, size_t) {
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+        return size_t{0};
+    }, logger);
+    pool.start();
+
+    // Медленная обработка: очередь заполняется, лишнее отбрасывается
+    const size_t accepted = submitMany(pool, 1000);
+    EXPECT_LT(accepted, 1000u);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    const QueueStats stats = pool.getStats();
+    EXPECT_GT(stats.active_workers, 1u);
+    EXPECT_EQ(stats.max_workers, 4u);
+    EXPECT_EQ(stats.dropped, 1000u - accepted);
+    EXPECT_GE(stats.peak_depth, 200u);
+    pool.stop();
+    EXPECT_EQ(pool.getStats().processed, accepted);
+}
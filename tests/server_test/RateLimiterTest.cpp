@@ -0,0 +1,68 @@
+//RateLimiterTest.cpp
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include <arpa/inet.h>
+#include "../src/server/RateLimiter.h"
+
+namespace {
+
+    uint32_t address(const char* ip) {
+        in_addr addr{};
+        inet_pton(AF_INET, ip, &addr);
+        return addr.s_addr;
+    }
+
+}
+
+TEST(RateLimiterTest, LimitsBurstAndRefills) {
+    RateLimiterConfig config;
+    config.rate = 100;
+    config.burst = 5;
+    RateLimiter limiter(config);
+
+    const uint32_t source = address("10.0.0.1");
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(limiter.allow(source));
+    }
+    EXPECT_FALSE(limiter.allow(source));
+
+    // Другой адрес не затронут
+    EXPECT_TRUE(limiter.allow(address("10.0.0.2")));
+
+    // 100 rps: за 30 мс набирается не меньше двух токенов
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_TRUE(limiter.allow(source));
+    EXPECT_TRUE(limiter.allow(source));
+
+    const RateLimiterStats stats = limiter.getStats();
+    EXPECT_EQ(stats.limited, 1u);
+    EXPECT_EQ(stats.allowed, 8u);
+}
+
+TEST(RateLimiterTest, MemoryStaysFixedWithManySources) {
+    RateLimiterConfig config;
+    config.rate = 1;
+    config.burst = 1;
+    config.table_size = 1000;
+    RateLimiter limiter(config);
+
+    const RateLimiterStats before = limiter.getStats();
+    EXPECT_EQ(before.table_size, 1024u);
+
+    // Источников в сотни раз больше, чем записей: старые вытесняются
+    for (uint32_t i = 1; i <= 200000; ++i) {
+        limiter.allow(htonl(0x0A000000u + i));
+    }
+    const RateLimiterStats after = limiter.getStats();
+    EXPECT_EQ(after.memory_bytes, before.memory_bytes);
+    EXPECT_GT(after.evictions, 190000u);
+    EXPECT_EQ(after.allowed, 200000u);
+}
+
+TEST(RateLimiterTest, ParsesActionNames) {
+    EXPECT_EQ(parseRateLimitAction("reject"), RateLimitAction::Reject);
+    EXPECT_EQ(parseRateLimitAction("drop"), RateLimitAction::Drop);
+    EXPECT_THROW(parseRateLimitAction("ignore"), std::invalid_argument);
+}
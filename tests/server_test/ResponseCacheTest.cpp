@@ -0,0 +1,61 @@
+//ResponseCacheTest.cpp
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include "../src/server/ResponseCache.h"
+
+namespace {
+
+    ResponseCache::Key makeKey(uint32_t sequence, uint16_t port = 5000, uint8_t protocol = 0) {
+        return ResponseCache::Key{0x0100007F, port, protocol, sequence};
+    }
+
+}
+
+TEST(ResponseCacheTest, AnswersRepeatWithinWindow) {
+    ResponseCache cache(ResponseCacheConfig{64, 1000});
+    char response[64];
+    EXPECT_EQ(cache.lookup(makeKey(1), response, sizeof(response)), 0u);
+
+    cache.store(makeKey(1), "created#1", 9);
+    ASSERT_EQ(cache.lookup(makeKey(1), response, sizeof(response)), 9u);
+    EXPECT_EQ(std::string(response, 9), "created#1");
+
+    // Другой порт, протокол или номер - другой запрос
+    EXPECT_EQ(cache.lookup(makeKey(1, 5001), response, sizeof(response)), 0u);
+    EXPECT_EQ(cache.lookup(makeKey(1, 5000, 1), response, sizeof(response)), 0u);
+    EXPECT_EQ(cache.lookup(makeKey(2), response, sizeof(response)), 0u);
+
+    const ResponseCacheStats stats = cache.getStats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 4u);
+    EXPECT_EQ(stats.stores, 1u);
+    EXPECT_EQ(stats.memory_bytes, 64u * 64u);
+}
+
+TEST(ResponseCacheTest, ExpiresAfterWindow) {
+    ResponseCache cache(ResponseCacheConfig{64, 20});
+    cache.store(makeKey(3), "exists#3", 8);
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    char response[64];
+    EXPECT_EQ(cache.lookup(makeKey(3), response, sizeof(response)), 0u);
+}
+
+TEST(ResponseCacheTest, EvictsOldestWhenFull) {
+    ResponseCache cache(ResponseCacheConfig{4, 1000});
+    char response[64];
+    for (uint32_t i = 0; i < 100; ++i) {
+        cache.store(makeKey(i), "created", 7);
+    }
+    EXPECT_EQ(cache.getStats().size, 4u);
+    EXPECT_EQ(cache.getStats().evictions, 96u);
+    EXPECT_EQ(cache.lookup(makeKey(99), response, sizeof(response)), 7u);
+    EXPECT_EQ(cache.lookup(makeKey(0), response, sizeof(response)), 0u);
+
+    // Слишком длинный ответ не кэшируется
+    const std::string longer(ResponseCache::kMaxResponseSize + 1, 'x');
+    cache.store(makeKey(500), longer.data(), longer.size());
+    EXPECT_EQ(cache.lookup(makeKey(500), response, sizeof(response)), 0u);
+}
@@ -5,6 +5,7 @@
 #include <filesystem>
 #include "../src/server/SessionManager.h"
 #include "../src/Logger.h"
+#include "../AllocationCounter.h"
 
 namespace fs = std::filesystem;
 
@@ -164,4 +165,651 @@ TEST(SessionManagerConcurrencyTest, HandlesConcurrentAccess) {
     logger->stop();
     fs::remove(cdr_path);
     fs::remove(log_path);
-}
\ No newline at end of file
+}
+
+TEST(SessionManagerHotPathTest, ReturnsFixedResponseTokens) {
+    const auto cdr_path = create_temp_file("cdr_");
+    const auto log_path = create_temp_file("log_");
+    auto logger = std::make_shared<Logger>(log_path);
+    logger->start();
+
+    SessionManager manager(60, 0, cdr_path, {"001010000000001"}, logger);
+
+    EXPECT_EQ(manager.handleImsi(std::string_view("001010123456789")), SessionResult::Created);
+    EXPECT_EQ(manager.handleImsi(std::string_view("001010123456789")), SessionResult::Exists);
+    EXPECT_EQ(manager.handleImsi(std::string_view("001010000000001")), SessionResult::Rejected);
+    EXPECT_EQ(manager.handleImsi(std::string_view("1234567890123456")), SessionResult::Rejected);
+    EXPECT_EQ(manager.handleImsi(std::string_view("no digits")), SessionResult::Rejected);
+    EXPECT_TRUE(manager.isSessionActive(std::string_view("001010123456789")));
+
+    EXPECT_EQ(toResponse(SessionResult::Created), "created");
+    EXPECT_EQ(toResponse(SessionResult::Exists), "exists");
+    EXPECT_EQ(toResponse(SessionResult::Rejected), "rejected");
+
+    logger->stop();
+    fs::remove(cdr_path);
+    fs::remove(log_path);
+}
+
+TEST(SessionManagerHotPathTest, RefreshDoesNotAllocate) {
+    const auto cdr_path = create_temp_file("cdr_");
+    const auto log_path = create_temp_file("log_");
+    auto logger = std::make_shared<Logger>(log_path);
+    logger->start();
+
+    SessionManager manager(60, 0, cdr_path, {}, logger);
+    const std::string_view imsi = "001010123456789";
+    ASSERT_EQ(manager.handleImsi(imsi), SessionResult::Created);
+
+    SessionResult result = SessionResult::Rejected;
+    allocationCounter::startThread();
+    for (int i = 0; i < 1000; ++i) {
+        result = manager.handleImsi(imsi);
+    }
+    const size_t allocations = allocationCounter::stopThread();
+
+    EXPECT_EQ(result, SessionResult::Exists);
+    EXPECT_EQ(allocations, 0u);
+
+    logger->stop();
+    fs::remove(cdr_path);
+    fs::remove(log_path);
+}
+TEST(SessionManagerHotPathTest, ExpiryDoesNotAllocatePerSession) {
+    const auto cdr_path = create_temp_file("cdr_");
+    const auto log_path = create_temp_file("log_");
+    auto logger = std::make_shared<Logger>(log_path);
+    logger->start();
+
+    SessionManagerConfig config;
+    config.session_timeout_ms = 20;
+    config.timer_tick_ms = 1;
+    config.graceful_shutdown_rate = 0;
+    config.cdr_file = cdr_path;
+    config.shards = 4;
+    constexpr int kSessions = 2000;
+    config.max_sessions = kSessions * 2;
+    SessionManager manager(config, logger);
+
+    // Поколение сессий создается и истекает; первое прогревает буферы очистки и CDR
+    char imsi[16];
+    uint64_t next_imsi = 0;
+    size_t allocations = 0;
+    auto churn = [&](bool count) {
+        for (int i = 0; i < kSessions; ++i) {
+            std::snprintf(imsi, sizeof(imsi), "25099%010llu", static_cast<unsigned long long>(next_imsi++));
+            ASSERT_EQ(manager.handleImsi(std::string_view(imsi, 15)), SessionResult::Created);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(config.session_timeout_ms + 20));
+        if (count) allocationCounter::startThread();
+        manager.cleanupExpiredSessions();
+        if (count) allocations = allocationCounter::stopThread();
+        ASSERT_EQ(manager.getStats().sessions, 0u);
+    };
+    churn(false);
+    churn(true);
+
+    // Истечение и CDR - без выделений на сессию
+    EXPECT_LT(allocations, size_t(kSessions / 100));
+
+    logger->stop();
+    fs::remove(cdr_path);
+    fs::remove(log_path);
+}
+
+TEST(SessionManagerShardingTest, SpreadsSessionsAcrossShards) {
+    const auto cdr_path = create_temp_file("cdr_");
+    const auto log_path = create_temp_file("log_");
+    auto logger = std::make_shared<Logger>(log_path);
+    logger->start();
+
+    SessionManagerConfig config;
+    config.session_timeout_sec = 1;
+    config.graceful_shutdown_rate = 0;
+    config.cdr_file = cdr_path;
+    config.shards = 5;
+    SessionManager manager(config, logger);
+
+    // Потоки работают с пересекающимися наборами IMSI во всех шардах
+    constexpr int kThreads = 4;
+    constexpr int kImsis = 400;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&manager]() {
+            for (int i = 0; i < kImsis; ++i) {
+                manager.handleImsi(std::string_view(std::to_string(1000000 + i)));
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    SessionStats stats = manager.getStats();
+    EXPECT_EQ(stats.shards, 8u);
+    EXPECT_EQ(stats.sessions, static_cast<uint64_t>(kImsis));
+    EXPECT_LT(stats.max_shard_sessions, static_cast<uint64_t>(kImsis) / 4);
+    EXPECT_TRUE(manager.isSessionActive(std::string_view("1000123")));
+
+    // Очистка проходит все шарды
+    std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+    manager.cleanupExpiredSessions();
+    EXPECT_EQ(manager.getStats().sessions, 0u);
+
+    logger->stop();
+    fs::remove(cdr_path);
+    fs::remove(log_path);
+}
+
+TEST(SessionManagerReadPathTest, ChecksAndRefreshesRunAlongsideCleanup) {
+    const auto cdr_path = create_temp_file("cdr_");
+    const auto log_path = create_temp_file("log_");
+    auto logger = std::make_shared<Logger>(log_path);
+    logger->start();
+
+    SessionManagerConfig config;
+    config.session_timeout_ms = 300;
+    config.cleanup_interval_ms = 20;
+    config.graceful_shutdown_rate = 0;
+    config.cdr_file = cdr_path;
+    config.shards = 4;
+    SessionManager manager(config, logger);
+
+    constexpr int kImsis = 64;
+    std::vector<std::string> imsis;
+    for (int i = 0; i < kImsis; ++i) {
+        imsis.push_back(std::to_string(2500000 + i));
+        ASSERT_EQ(manager.handleImsi(std::string_view(imsis.back())), SessionResult::Created);
+    }
+
+    // Проверка активности ничего не пишет в консоль и не выделяет память
+    testing::internal::CaptureStdout();
+    allocationCounter::startThread();
+    const bool active = manager.isSessionActive(std::string_view(imsis[0]));
+    const size_t allocations = allocationCounter::stopThread();
+    EXPECT_TRUE(active);
+    EXPECT_EQ(allocations, 0u);
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "");
+
+    // Читатели продлевают и проверяют сессии, пока поток очистки снимает просроченные
+    manager.startCleanupTimer();
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> missing{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&, t]() {
+            while (running) {
+                for (const std::string& imsi : imsis) {
+                    if (t == 0 ? !manager.refreshSession(imsi) : !manager.isSessionActive(imsi)) ++missing;
+                }
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(900));
+    running = false;
+    for (auto& reader : readers) reader.join();
+    manager.stopCleanupTimer();
+
+    // Продлеваемые сессии пережили три таймаута
+    EXPECT_EQ(missing.load(), 0u);
+    EXPECT_EQ(manager.getStats().sessions, static_cast<uint64_t>(kImsis));
+
+    logger->stop();
+    fs::remove(cdr_path);
+    fs::remove(log_path);
+}
+
+TEST(SnapshotSlotTest, ReclaimsReplacedSnapshotOnReloadThread) {
+    struct Tracked {
+        int value;
+        std::atomic<int>* alive;
+        std::thread::id* freed_by;
+        Tracked(int v, std::atomic<int>* counter, std::thread::id* freed)
+        : value(v), alive(counter), freed_by(freed) { ++*alive; }
+        ~Tracked() {
+            *freed_by = std::this_thread::get_id();
+            --*alive;
+        }
+    };
+    std::atomic<int> alive{0};
+    std::thread::id freed_by;
+    SnapshotSlot<Tracked> slot(std::make_shared<const Tracked>(1, &alive, &freed_by));
+
+    // Поток запросов держит прочитанный снимок, пока не возьмет снимок снова
+    std::atomic<int> step{0};
+    int first = 0;
+    int second = 0;
+    std::thread reader([&]() {
+        first = slot->value;
+        step = 1;
+        while (step != 2) std::this_thread::yield();
+        second = slot->value;
+        step = 3;
+        while (step != 4) std::this_thread::yield();
+    });
+    while (step != 1) std::this_thread::yield();
+    slot.publish(std::make_shared<const Tracked>(2, &alive, &freed_by));
+    EXPECT_EQ(slot->value, 2);
+    EXPECT_EQ(alive.load(), 2);
+    EXPECT_EQ(slot.retired(), 1u);
+
+    // Читатель перешел на новый снимок, но прежний не освобождает
+    step = 2;
+    while (step != 3) std::this_thread::yield();
+    EXPECT_EQ(first, 1);
+    EXPECT_EQ(second, 2);
+    EXPECT_EQ(alive.load(), 2);
+
+    // Освобождает поток перезагрузки
+    EXPECT_EQ(slot.reclaim(), 0u);
+    EXPECT_EQ(alive.load(), 1);
+    EXPECT_EQ(freed_by, std::this_thread::get_id());
+    step = 4;
+    reader.join();
+}
+
+TEST(SessionManagerReloadTest, ReloadsDoNotSlowDownRequestThreads) {
+    const auto cdr_path = create_temp_file("cdr_");
+    const auto log_path = create_temp_file("log_");
+    auto logger = std::make_shared<Logger>(log_path);
+    logger->start();
+
+    SessionManagerConfig config;
+    config.session_timeout_sec = 60;
+    config.graceful_shutdown_rate = 0;
+    config.cdr_file = cdr_path;
+    config.blacklist = {"001010000000001"};
+    config.shards = 16;
+    SessionManager manager(config, logger);
+
+    // Продления существующих сессий несколькими потоками: каждый запрос читает снимок настроек
+    constexpr int kThreads = 4;
+    constexpr int kImsis = 1000;
+    for (int i = 0; i < kImsis; ++i) manager.handleImsi(std::string_view(std::to_string(3000000 + i)));
+    auto measure = [&](bool reload) {
+        std::atomic<bool> running{true};
+        std::atomic<uint64_t> handled{0};
+        std::vector<std::thread> workers;
+        for (int t = 0; t < kThreads; ++t) {
+            workers.emplace_back([&, t]() {
+                uint64_t n = uint64_t(t) * 7;
+                uint64_t local = 0;
+                while (running) {
+                    manager.handleImsi(std::string_view(std::to_string(3000000 + n++ % kImsis)));
+                    ++local;
+                }
+                handled += local;
+            });
+        }
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (reload) manager.reload(config);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        running = false;
+        for (auto& worker : workers) worker.join();
+        return handled.load();
+    };
+    measure(false);
+    const uint64_t without_reload = measure(false);
+    const uint64_t with_reload = measure(true);
+    RecordProperty("handled_without_reload", std::to_string(without_reload));
+    RecordProperty("handled_with_reload", std::to_string(with_reload));
+    // Перезагрузка не ставит потоки запросов в очередь на общую блокировку
+    EXPECT_GT(with_reload, without_reload / 2) << without_reload << " request(s) without reload";
+
+    logger->stop();
+    fs::remove(cdr_path);
+    fs::remove(log_path);
+}
+
+TEST(SessionManagerReloadTest, SwapsBlacklistAndTimeoutUnderLoad) {
+    const auto cdr_path = create_temp_file("cdr_");
+    const auto log_path = create_temp_file("log_");
+    const auto blacklist_path = create_temp_file("blacklist_");
+    auto logger = std::make_shared<Logger>(log_path);
+    logger->start();
+
+    SessionManagerConfig config;
+    config.session_timeout_sec = 60;
+    config.graceful_shutdown_rate = 0;
+    config.cdr_file = cdr_path;
+    config.blacklist = {"001010000000001"};
+    SessionManager manager(config, logger);
+    EXPECT_EQ(manager.getSessionTimeoutMs(), 60000u);
+
+    // Запросы идут все время перезагрузок
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> handled{0};
+    std::thread worker([&]() {
+        uint64_t n = 0;
+        while (running) {
+            manager.handleImsi(std::string_view(std::to_string(3000000 + n++ % 1000)));
+            ++handled;
+        }
+    });
+
+    {
+        std::ofstream file(blacklist_path);
+        file << "00102*\n";
+    }
+    config.session_timeout_ms = 1500;
+    config.blacklist = {};
+    config.blacklist_file = blacklist_path;
+    // Перезагрузки начинаются, когда запросы уже идут, и чередуются с ними
+    // (на одном ядре без уступки все 20 закончились бы до первого запроса)
+    while (handled.load() == 0) std::this_thread::yield();
+    const uint64_t handled_at_first_reload = handled.load();
+    for (int i = 0; i < 20; ++i) {
+        manager.reload(config);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_GT(handled.load(), handled_at_first_reload);
+
+    EXPECT_EQ(manager.getSessionTimeoutMs(), 1500u);
+    EXPECT_EQ(manager.handleImsi(std::string_view("001010000000001")), SessionResult::Created);
+    EXPECT_EQ(manager.handleImsi(std::string_view("001020000000001")), SessionResult::Rejected);
+    EXPECT_EQ(manager.getBlacklistStats().prefix_rules, 1u);
+
+    // Ошибка загрузки оставляет прежние настройки
+    config.blacklist_file = blacklist_path + ".missing";
+    config.session_timeout_ms = 100;
+    EXPECT_THROW(manager.reload(config), std::runtime_error);
+    EXPECT_EQ(manager.getSessionTimeoutMs(), 1500u);
+    EXPECT_EQ(manager.handleImsi(std::string_view("001020000000002")), SessionResult::Rejected);
+
+    running = false;
+    worker.join();
+
+    logger->stop();
+    fs::remove(cdr_path);
+    fs::remove(log_path);
+    fs::remove(blacklist_path);
+}
+
+TEST(SessionManagerDrainTest, DrainsAtTargetRateWhileServingChecks) {
+    const auto cdr_path = create_temp_file("drain_cdr_");
+    const auto log_path = create_temp_file("drain_log_");
+    auto logger = std::make_shared<Logger>(log_path);
+    logger->start();
+
+    SessionManagerConfig config;
+    config.session_timeout_sec = 60;
+    config.drain_rate = 2000;
+    config.cdr_file = cdr_path;
+    SessionManager manager(config, logger);
+    constexpr int kSessions = 1000;
+    for (int i = 0; i < kSessions; ++i) {
+        ASSERT_EQ(manager.handleImsi(std::string_view(std::to_string(5000000 + i))), SessionResult::Created);
+    }
+    EXPECT_EQ(manager.getDrainStats().state, "idle");
+
+    const auto started = std::chrono::steady_clock::now();
+    manager.startDrain();
+    manager.startDrain();
+    EXPECT_EQ(manager.handleImsi(std::string_view("001010123456789")), SessionResult::ShuttingDown);
+
+    // Проверки обслуживаются все время выгрузки: блокировка шарда держится на один пакет
+    double max_check_ms = 0.0;
+    bool seen_progress = false;
+    while (manager.getDrainStats().state != "done") {
+        const auto check_started = std::chrono::steady_clock::now();
+        manager.isSessionActive(std::string_view("5000999"));
+        max_check_ms = std::max(max_check_ms, std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - check_started).count());
+        const DrainStats stats = manager.getDrainStats();
+        if (stats.state == "draining" && stats.drained > 0 && stats.remaining > 0) {
+            EXPECT_EQ(stats.total, uint64_t(kSessions));
+            EXPECT_EQ(stats.drained + stats.remaining, uint64_t(kSessions));
+            seen_progress = true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    manager.waitDrain();
+    const double elapsed_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    const DrainStats stats = manager.getDrainStats();
+    EXPECT_TRUE(seen_progress);
+    EXPECT_EQ(stats.drained, uint64_t(kSessions));
+    EXPECT_EQ(stats.remaining, 0u);
+    EXPECT_EQ(stats.rate, 2000u);
+    // 1000 сессий при 2000/с - около 0.5 с
+    EXPECT_GT(elapsed_sec, 0.4);
+    EXPECT_LT(elapsed_sec, 1.0);
+    EXPECT_NEAR(stats.actual_rate, 2000.0, 400.0);
+    EXPECT_LT(max_check_ms, 50.0);
+    EXPECT_EQ(manager.getStats().sessions, 0u);
+
+    manager.gracefulShutdown();
+    std::ifstream cdr_file(cdr_path);
+    std::string line;
+    int removed = 0;
+    while (std::getline(cdr_file, line)) {
+        removed += line.find(", shutdown_remove") != std::string::npos;
+    }
+    EXPECT_EQ(removed, kSessions);
+
+    logger->stop();
+    fs::remove(cdr_path);
+    fs::remove(log_path);
+}
+
+TEST(SessionManagerDrainTest, ReloadChangesRateOfRunningDrain) {
+    const auto cdr_path = create_temp_file("drain_reload_cdr_");
+    const auto log_path = create_temp_file("drain_reload_log_");
+    auto logger = std::make_shared<Logger>(log_path);
+    logger->start();
+
+    // Пауза 100 мс на сессию - 10 сессий в секунду, 20000 сессий выгружались бы полчаса
+    SessionManagerConfig config;
+    config.session_timeout_sec = 60;
+    config.graceful_shutdown_rate = 100;
+    config.cdr_file = cdr_path;
+    SessionManager manager(config, logger);
+    constexpr int kSessions = 20000;
+    for (int i = 0; i < kSessions; ++i) {
+        manager.handleImsi(std::string_view(std::to_string(6000000 + i)));
+    }
+
+    manager.startDrain();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    DrainStats stats = manager.getDrainStats();
+    EXPECT_EQ(stats.rate, 10u);
+    EXPECT_LE(stats.drained, 6u);
+    EXPECT_GT(stats.eta_sec, 1000.0);
+
+    // Без ограничения - пакетами по kDrainBatch
+    config.graceful_shutdown_rate = 0;
+    manager.reload(config);
+    manager.waitDrain();
+    stats = manager.getDrainStats();
+    EXPECT_EQ(stats.state, "done");
+    EXPECT_EQ(stats.drained, uint64_t(kSessions));
+    EXPECT_LT(stats.batches, uint64_t(kSessions / 100));
+    EXPECT_LT(stats.elapsed_ms, 5000.0);
+
+    logger->stop();
+    fs::remove(cdr_path);
+    fs::remove(log_path);
+}
+
+TEST(SessionManagerCapacityTest, RejectsNewSessionsWhenFull) {
+    const auto cdr_path = create_temp_file("capacity_cdr_");
+    const auto log_path = create_temp_file("capacity_log_");
+    auto logger = std::make_shared<Logger>(log_path);
+    logger->start();
+
+    SessionManagerConfig config;
+    config.session_timeout_sec = 60;
+    config.graceful_shutdown_rate = 0;
+    config.cdr_file = cdr_path;
+    config.shards = 4;
+    config.max_sessions = 64;
+    SessionManager manager(config, logger);
+
+    int created = 0;
+    int rejected = 0;
+    for (int i = 0; i < 1000; ++i) {
+        const SessionResult result = manager.handleImsi(std::string_view(std::to_string(7000000 + i)));
+        created += result == SessionResult::Created;
+        rejected += result == SessionResult::CapacityExceeded;
+    }
+    // Предел делится между шардами поровну: по 16 сессий
+    EXPECT_EQ(created, 64);
+    EXPECT_EQ(created + rejected, 1000);
+    EXPECT_EQ(toResponse(SessionResult::CapacityExceeded), "rejected (capacity)");
+    // Существующие сессии продлеваются и при заполненной таблице
+    for (int i = 0; i < 1000; ++i) {
+        const std::string imsi = std::to_string(7000000 + i);
+        if (manager.isSessionActive(std::string_view(imsi))) {
+            EXPECT_EQ(manager.handleImsi(std::string_view(imsi)), SessionResult::Exists);
+        }
+    }
+
+    const SessionStats stats = manager.getStats();
+    EXPECT_EQ(stats.sessions, 64u);
+    EXPECT_EQ(stats.session_limit, 64u);
+    EXPECT_EQ(stats.capacity_policy, "reject");
+    EXPECT_EQ(stats.capacity_rejects, uint64_t(rejected));
+    EXPECT_EQ(stats.evictions, 0u);
+    EXPECT_EQ(stats.accounted_bytes, stats.memory_bytes + stats.timer_records * sizeof(uint64_t));
+    EXPECT_THROW(parseCapacityPolicy("lru"), std::invalid_argument);
+
+    logger->stop();
+    fs::remove(cdr_path);
+    fs::remove(log_path);
+}
+
+TEST(SessionManagerCapacityTest, EvictsLeastRecentlyRefreshed) {
+    const auto cdr_path = create_temp_file("evict_cdr_");
+    const auto log_path = create_temp_file("evict_log_");
+    auto logger = std::make_shared<Logger>(log_path);
+    logger->start();
+
+    SessionManagerConfig config;
+    config.session_timeout_sec = 60;
+    config.graceful_shutdown_rate = 0;
+    config.cdr_file = cdr_path;
+    config.shards = 1;
+    config.max_sessions = 256;
+    config.capacity_policy = parseCapacityPolicy("evict");
+    {
+        SessionManager manager(config, logger);
+        for (int i = 0; i < 256; ++i) {
+            ASSERT_EQ(manager.handleImsi(std::string_view(std::to_string(8000000 + i))), SessionResult::Created);
+        }
+        // Первая половина продлевается, вторая остается давней
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        for (int i = 0; i < 128; ++i) {
+            ASSERT_TRUE(manager.refreshSession(std::string_view(std::to_string(8000000 + i))));
+        }
+        for (int i = 0; i < 64; ++i) {
+            ASSERT_EQ(manager.handleImsi(std::string_view(std::to_string(9000000 + i))), SessionResult::Created);
+        }
+
+        const SessionStats stats = manager.getStats();
+        EXPECT_EQ(stats.sessions, 256u);
+        EXPECT_EQ(stats.evictions, 64u);
+        EXPECT_EQ(stats.capacity_rejects, 0u);
+        int refreshed_kept = 0;
+        for (int i = 0; i < 128; ++i) {
+            refreshed_kept += manager.isSessionActive(std::string_view(std::to_string(8000000 + i)));
+        }
+        // Вытесняются не продлевавшиеся сессии: продленные получают второй шанс и все на месте
+        EXPECT_EQ(refreshed_kept, 128);
+    }
+
+    std::ifstream cdr_file(cdr_path);
+    std::string line;
+    int evicted = 0;
+    while (std::getline(cdr_file, line)) {
+        evicted += line.find(", capacity_evict") != std::string::npos;
+    }
+    EXPECT_EQ(evicted, 64);
+
+    logger->stop();
+    fs::remove(cdr_path);
+    fs::remove(log_path);
+}
+
+TEST(SessionManagerCapacityTest, EvictionFloodKeepsTimerWheelBounded) {
+    const auto cdr_path = create_temp_file("evict_flood_cdr_");
+    const auto log_path = create_temp_file("evict_flood_log_");
+    auto logger = std::make_shared<Logger>(log_path);
+    logger->start();
+
+    SessionManagerConfig config;
+    config.session_timeout_sec = 60;
+    config.graceful_shutdown_rate = 0;
+    config.cdr_file = cdr_path;
+    config.shards = 1;
+    config.capacity_policy = parseCapacityPolicy("evict");
+    // Записи вытесненных сессий в колесе не ждут своего срока (60 с): иначе за поток
+    // новых сессий их набралось бы по одной на вытеснение
+    constexpr int kFlood = 50000;
+    constexpr uint64_t kStaleBound = 256 + 1;
+    {
+        config.max_sessions = 1024;
+        SessionManager manager(config, logger);
+        for (int i = 0; i < kFlood; ++i) {
+            ASSERT_EQ(manager.handleImsi(std::string_view(std::to_string(20000000 + i))), SessionResult::Created);
+        }
+        const SessionStats stats = manager.getStats();
+        EXPECT_EQ(stats.sessions, 1024u);
+        EXPECT_EQ(stats.evictions, uint64_t(kFlood - 1024));
+        EXPECT_LE(stats.timer_records, stats.sessions + stats.sessions / 4 + kStaleBound);
+        EXPECT_GT(stats.timer_compactions, 0u);
+        EXPECT_EQ(stats.accounted_bytes, stats.memory_bytes + stats.timer_records * sizeof(uint64_t));
+    }
+    {
+        // Бюджет памяти: устаревшие записи не растут за его пределы
+        config.max_sessions = 0;
+        config.memory_limit_bytes = 64 * 1024;
+        SessionManager manager(config, logger);
+        for (int i = 0; i < kFlood; ++i) {
+            ASSERT_EQ(manager.handleImsi(std::string_view(std::to_string(30000000 + i))), SessionResult::Created);
+        }
+        const SessionStats stats = manager.getStats();
+        EXPECT_GT(stats.evictions, 0u);
+        EXPECT_LE(stats.timer_records, stats.sessions + stats.sessions / 4 + kStaleBound);
+        EXPECT_LE(stats.accounted_bytes,
+                  config.memory_limit_bytes + (stats.sessions / 4 + kStaleBound) * sizeof(uint64_t));
+    }
+
+    logger->stop();
+    fs::remove(cdr_path);
+    fs::remove(log_path);
+}
+
+TEST(SessionManagerCapacityTest, EnforcesMemoryBudget) {
+    const auto cdr_path = create_temp_file("memory_cdr_");
+    const auto log_path = create_temp_file("memory_log_");
+    auto logger = std::make_shared<Logger>(log_path);
+    logger->start();
+
+    SessionManagerConfig config;
+    config.session_timeout_sec = 60;
+    config.graceful_shutdown_rate = 0;
+    config.cdr_file = cdr_path;
+    config.shards = 1;
+    config.memory_limit_bytes = 1024;
+    {
+        // Таблица 16 -> 32 записи (512 байт); следующее удвоение не умещается в 1 KiB
+        SessionManager manager(config, logger);
+        int created = 0;
+        for (int i = 0; i < 100; ++i) {
+            created += manager.handleImsi(std::string_view(std::to_string(1000000 + i))) == SessionResult::Created;
+        }
+        EXPECT_EQ(created, 24);
+        const SessionStats stats = manager.getStats();
+        EXPECT_EQ(stats.accounted_bytes, 32 * sizeof(SessionEntry) + 24 * sizeof(uint64_t));
+        EXPECT_LE(stats.accounted_bytes, config.memory_limit_bytes);
+        EXPECT_EQ(stats.capacity_rejects, 76u);
+    }
+
+    // Таблицы под max_sessions сами больше бюджета - ошибка настройки
+    config.max_sessions = 1000;
+    EXPECT_THROW(SessionManager(config, logger), std::invalid_argument);
+
+    logger->stop();
+    fs::remove(cdr_path);
+    fs::remove(log_path);
+}
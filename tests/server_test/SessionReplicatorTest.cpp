@@ -0,0 +1,242 @@
+//SessionReplicatorTest.cpp
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../src/server/SessionReplicator.h"
+#include "../src/Logger.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    std::string tempPath(const std::string& name) {
+        return (fs::temp_directory_path() / (name + std::to_string(::getpid()))).string();
+    }
+
+    bool waitFor(const std::function<bool()>& condition, int timeout_ms = 5000) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (condition()) return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return condition();
+    }
+
+    std::string imsiAt(int i) {
+        return std::to_string(250990000000000ull + uint64_t(i));
+    }
+
+    class SessionReplicatorTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            m_logger = std::make_shared<Logger>(tempPath("replication_log_"));
+            m_logger->start();
+        }
+
+        void TearDown() override {
+            m_logger->stop();
+            fs::remove(tempPath("replication_log_"));
+            fs::remove(tempPath("replication_cdr_primary_"));
+            fs::remove(tempPath("replication_cdr_standby_"));
+        }
+
+        std::shared_ptr<SessionManager> makeManager(const std::string& name, uint32_t timeout_ms = 60000,
+                                                    uint64_t max_sessions = 0) {
+            SessionManagerConfig config;
+            config.session_timeout_ms = timeout_ms;
+            config.max_sessions = max_sessions;
+            config.timer_tick_ms = 1;
+            config.graceful_shutdown_rate = 0;
+            config.cdr_file = tempPath("replication_cdr_" + name + "_");
+            return std::make_shared<SessionManager>(config, m_logger);
+        }
+
+        static ReplicationConfig replicationConfig(ReplicationRole role, uint16_t port = 0) {
+            ReplicationConfig config;
+            config.role = role;
+            config.port = port;
+            config.batch_ms = 1;
+            config.heartbeat_ms = 50;
+            config.reconnect_ms = 20;
+            return config;
+        }
+
+        std::shared_ptr<Logger> m_logger;
+    };
+
+}
+
+TEST_F(SessionReplicatorTest, ParsesRolesAndRejectsBadConfig) {
+    EXPECT_EQ(parseReplicationRole("off"), ReplicationRole::Off);
+    EXPECT_EQ(parseReplicationRole("primary"), ReplicationRole::Primary);
+    EXPECT_EQ(parseReplicationRole("standby"), ReplicationRole::Standby);
+    EXPECT_THROW(parseReplicationRole("master"), std::invalid_argument);
+
+    auto manager = makeManager("primary");
+    EXPECT_THROW(SessionReplicator(replicationConfig(ReplicationRole::Off), manager), std::invalid_argument);
+    ReplicationConfig bad_ip = replicationConfig(ReplicationRole::Standby, 9100);
+    bad_ip.ip = "not-an-ip";
+    EXPECT_THROW(SessionReplicator(bad_ip, manager), std::invalid_argument);
+}
+
+TEST_F(SessionReplicatorTest, StandbyCatchesUpFromSnapshotThenFollowsDeltas) {
+    auto primary_manager = makeManager("primary");
+    auto standby_manager = makeManager("standby");
+    SessionReplicator primary(replicationConfig(ReplicationRole::Primary), primary_manager);
+    ASSERT_NE(primary.port(), 0);
+    primary.start();
+
+    // Сессии до подключения резервного приходят снимком
+    constexpr int kBefore = 3000;
+    for (int i = 0; i < kBefore; ++i) {
+        ASSERT_EQ(primary_manager->handleImsi(std::string_view(imsiAt(i))), SessionResult::Created);
+    }
+    // Своя сессия резервного заменяется таблицей основного
+    standby_manager->handleImsi(std::string_view(imsiAt(-1)));
+
+    SessionReplicator standby(replicationConfig(ReplicationRole::Standby, primary.port()), standby_manager);
+    standby.start();
+    ASSERT_TRUE(waitFor([&]() { return standby.getStats().connected; }));
+    EXPECT_TRUE(standby_manager->isReplica());
+    EXPECT_EQ(standby.getStats().snapshot_sessions, uint64_t(kBefore));
+    EXPECT_EQ(standby_manager->getStats().sessions, uint64_t(kBefore));
+    EXPECT_FALSE(standby_manager->isSessionActive(imsiAt(-1)));
+
+    // Дальше - пакеты изменений: создание и удаление
+    for (int i = kBefore; i < kBefore + 500; ++i) primary_manager->handleImsi(std::string_view(imsiAt(i)));
+    // Удаление сессии - через интерфейс, как у обработчика запросов
+    ISessionManager& primary_sessions = *primary_manager;
+    for (int i = 0; i < 100; ++i) primary_sessions.removeSession(imsiAt(i));
+    const uint64_t expected = kBefore + 500 - 100;
+    ASSERT_TRUE(waitFor([&]() { return standby_manager->getStats().sessions == expected; }));
+    EXPECT_FALSE(standby_manager->isSessionActive(imsiAt(0)));
+    EXPECT_TRUE(standby_manager->isSessionActive(imsiAt(kBefore + 499)));
+
+    ASSERT_TRUE(waitFor([&]() { return standby.getStats().next_seq == primary.getStats().next_seq; }));
+    const ReplicationStats primary_stats = primary.getStats();
+    EXPECT_EQ(primary_stats.role, "primary");
+    EXPECT_EQ(primary_stats.snapshots, 1u);
+    EXPECT_EQ(primary_stats.resyncs, 0u);
+    EXPECT_GE(primary_stats.deltas, 600u);
+    // Изменения идут пакетами, а не по одному на кадр
+    EXPECT_LT(primary_stats.batches, primary_stats.deltas);
+    EXPECT_EQ(standby.getStats().deltas, primary_stats.deltas);
+
+    const nlohmann::json json = primary_stats;
+    EXPECT_EQ(json["role"], "primary");
+    EXPECT_TRUE(json.contains("queue_depth"));
+
+    standby.stop();
+    primary.stop();
+}
+
+TEST_F(SessionReplicatorTest, QueueOverflowForcesSnapshotResync) {
+    auto primary_manager = makeManager("primary");
+    auto standby_manager = makeManager("standby");
+    ReplicationConfig config = replicationConfig(ReplicationRole::Primary);
+    config.queue_size = 64;
+    SessionReplicator primary(config, primary_manager);
+    primary.start();
+    SessionReplicator standby(replicationConfig(ReplicationRole::Standby, primary.port()), standby_manager);
+    standby.start();
+    ASSERT_TRUE(waitFor([&]() { return standby.getStats().connected; }));
+
+    // Всплеск больше очереди: изменения теряются, соединение сбрасывается, резервный догоняет по снимку
+    constexpr int kBurst = 20000;
+    for (int i = 0; i < kBurst; ++i) primary_manager->handleImsi(std::string_view(imsiAt(i)));
+    ASSERT_TRUE(waitFor([&]() { return primary.getStats().dropped > 0; }));
+    ASSERT_TRUE(waitFor([&]() {
+        return standby.getStats().connected && standby_manager->getStats().sessions == uint64_t(kBurst);
+    }));
+    EXPECT_GE(primary.getStats().resyncs, 1u);
+    EXPECT_GE(standby.getStats().snapshots, 2u);
+
+    standby.stop();
+    primary.stop();
+}
+
+TEST_F(SessionReplicatorTest, RestartedStandbyResyncsAndLinkLossEndsReplicaMode) {
+    auto primary_manager = makeManager("primary");
+    auto standby_manager = makeManager("standby", 200);
+    auto primary = std::make_unique<SessionReplicator>(replicationConfig(ReplicationRole::Primary), primary_manager);
+    primary->start();
+    const uint16_t port = primary->port();
+    for (int i = 0; i < 100; ++i) primary_manager->handleImsi(std::string_view(imsiAt(i)));
+
+    {
+        SessionReplicator standby(replicationConfig(ReplicationRole::Standby, port), standby_manager);
+        standby.start();
+        ASSERT_TRUE(waitFor([&]() { return standby_manager->getStats().sessions == 100u; }));
+    }
+    // Перезапуск резервного: новый снимок с изменениями, пропущенными без связи
+    ISessionManager& primary_sessions = *primary_manager;
+    for (int i = 0; i < 50; ++i) primary_sessions.removeSession(imsiAt(i));
+    SessionReplicator standby(replicationConfig(ReplicationRole::Standby, port), standby_manager);
+    standby.start();
+    ASSERT_TRUE(waitFor([&]() {
+        return standby.getStats().connected && standby_manager->getStats().sessions == 50u;
+    }));
+    EXPECT_EQ(primary->getStats().connects, 2u);
+
+    // В режиме реплики сессии живут дольше своего таймаута, пока основной их не закроет
+    ASSERT_TRUE(standby_manager->isReplica());
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    standby_manager->cleanupExpiredSessions();
+    EXPECT_EQ(standby_manager->getStats().sessions, 50u);
+
+    // Основной пропал: резервный сам закрывает сессии по своему таймауту.
+    // Уже отложенные сроки наступают не позже, чем через окно продлений и три heartbeat
+    primary.reset();
+    ASSERT_TRUE(waitFor([&]() { return !standby_manager->isReplica(); }));
+    EXPECT_FALSE(standby.getStats().connected);
+    EXPECT_TRUE(waitFor([&]() {
+        standby_manager->cleanupExpiredSessions();
+        return standby_manager->getStats().sessions == 0;
+    }));
+    standby.stop();
+}
+
+TEST_F(SessionReplicatorTest, StandbyRejectsOversizedSnapshotAndReconnects) {
+    // Поддельный основной: объявляет снимок больше max_sessions резервного
+    const int listen_fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    ASSERT_GE(listen_fd, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(::bind(listen_fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(::listen(listen_fd, 4), 0);
+    socklen_t length = sizeof(addr);
+    ASSERT_EQ(::getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &length), 0);
+
+    auto standby_manager = makeManager("standby", 60000, 1000);
+    SessionReplicator standby(replicationConfig(ReplicationRole::Standby, ntohs(addr.sin_port)), standby_manager);
+    standby.start();
+
+    // Кадр SnapshotBegin: kMagic, тип 1, резерв, длина 8, число сессий
+    char frame[20] = {'P', 'G', 'W', 'R', 1, 0, 0, 0, 8, 0, 0, 0};
+    const uint64_t declared = uint64_t(1) << 60;
+    std::memcpy(frame + 12, &declared, sizeof(declared));
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        const int fd = ::accept(listen_fd, nullptr, nullptr);
+        ASSERT_GE(fd, 0);
+        ASSERT_EQ(::send(fd, frame, sizeof(frame), MSG_NOSIGNAL), ssize_t(sizeof(frame)));
+        // Резервный закрывает соединение, не дожидаясь записей снимка
+        char byte;
+        EXPECT_EQ(::recv(fd, &byte, 1, 0), 0);
+        ::close(fd);
+    }
+    // Поток резервного жив и переподключается
+    EXPECT_TRUE(waitFor([&]() { return standby.getStats().connects >= 2; }));
+    EXPECT_EQ(standby.getStats().snapshots, 0u);
+    EXPECT_EQ(standby_manager->getStats().sessions, 0u);
+    standby.stop();
+    ::close(listen_fd);
+}
@@ -0,0 +1,150 @@
+//SessionSnapshotTest.cpp
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include "../src/server/SessionManager.h"
+#include "../src/server/SessionSnapshot.h"
+#include "../src/Logger.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    std::string tempPath(const std::string& name) {
+        return (fs::temp_directory_path() / (name + std::to_string(::getpid()))).string();
+    }
+
+    size_t countLines(const std::string& path, const std::string& action) {
+        std::ifstream file(path);
+        size_t count = 0;
+        std::string line;
+        while (std::getline(file, line)) {
+            count += line.find(", " + action) != std::string::npos;
+        }
+        return count;
+    }
+
+}
+
+TEST(SessionSnapshotTest, RoundTripsAndDetectsCorruption) {
+    const std::string path = tempPath("snapshot_file_");
+    SessionSnapshot snapshot(1700000000123ull);
+    for (uint64_t i = 1; i <= 1000; ++i) snapshot.add(imsiKey::pack(std::to_string(1000000 + i)), uint32_t(i * 7));
+    const size_t bytes = snapshot.save(path);
+    EXPECT_EQ(bytes, SessionSnapshot::kHeaderSize + 1000 * SessionSnapshot::kRecordSize + 8);
+    EXPECT_EQ(fs::file_size(path), bytes);
+    EXPECT_FALSE(fs::exists(path + ".tmp"));
+
+    const SessionSnapshot loaded = SessionSnapshot::load(path);
+    ASSERT_EQ(loaded.size(), 1000u);
+    EXPECT_EQ(loaded.wallMs(), 1700000000123ull);
+    for (size_t i = 0; i < loaded.size(); ++i) {
+        ASSERT_EQ(loaded.key(i), snapshot.key(i));
+        ASSERT_EQ(loaded.ageMs(i), snapshot.ageMs(i));
+    }
+
+    // Один измененный байт записи - несовпадение контрольной суммы
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(SessionSnapshot::kHeaderSize + 100);
+        file.put('\x7f');
+    }
+    EXPECT_THROW(SessionSnapshot::load(path), std::runtime_error);
+    fs::resize_file(path, bytes - 3);
+    EXPECT_THROW(SessionSnapshot::load(path), std::runtime_error);
+    EXPECT_THROW(SessionSnapshot::load(path + ".missing"), std::runtime_error);
+    fs::remove(path);
+}
+
+TEST(SessionSnapshotTest, WarmRestartKeepsSessionsWithoutCdrChurn) {
+    const std::string cdr_path = tempPath("snapshot_cdr_");
+    const std::string log_path = tempPath("snapshot_log_");
+    const std::string snapshot_path = tempPath("snapshot_sessions_");
+    auto logger = std::make_shared<Logger>(log_path);
+    logger->start();
+
+    SessionManagerConfig config;
+    config.session_timeout_sec = 60;
+    config.graceful_shutdown_rate = 0;
+    config.cdr_file = cdr_path;
+    config.snapshot_file = snapshot_path;
+    constexpr int kSessions = 2000;
+    {
+        SessionManager manager(config, logger);
+        EXPECT_EQ(manager.getSnapshotStats().loaded_sessions, 0u);
+        for (int i = 0; i < kSessions; ++i) {
+            ASSERT_EQ(manager.handleImsi(std::string_view(std::to_string(4000000 + i))), SessionResult::Created);
+        }
+        // Остановка сохраняет сессии вместо поочередного удаления
+    }
+    EXPECT_EQ(countLines(cdr_path, "created"), size_t(kSessions));
+    EXPECT_EQ(countLines(cdr_path, "shutdown_remove"), 0u);
+
+    {
+        SessionManager manager(config, logger);
+        const SessionSnapshotStats stats = manager.getSnapshotStats();
+        EXPECT_EQ(stats.loaded_sessions, uint64_t(kSessions));
+        EXPECT_EQ(stats.expired_on_load, 0u);
+        EXPECT_EQ(manager.getStats().sessions, uint64_t(kSessions));
+        EXPECT_EQ(manager.getStats().timer_records, uint64_t(kSessions));
+        for (int i = 0; i < kSessions; ++i) {
+            ASSERT_EQ(manager.handleImsi(std::string_view(std::to_string(4000000 + i))), SessionResult::Exists);
+        }
+        EXPECT_EQ(manager.saveSnapshot(), size_t(kSessions));
+        EXPECT_EQ(manager.getSnapshotStats().writes, 1u);
+    }
+    EXPECT_EQ(countLines(cdr_path, "created"), size_t(kSessions));
+
+    logger->stop();
+    fs::remove(cdr_path);
+    fs::remove(log_path);
+    fs::remove(snapshot_path);
+}
+
+TEST(SessionSnapshotTest, SessionsExpiredWhileStoppedAreClosed) {
+    const std::string cdr_path = tempPath("snapshot_expired_cdr_");
+    const std::string log_path = tempPath("snapshot_expired_log_");
+    const std::string snapshot_path = tempPath("snapshot_expired_");
+    auto logger = std::make_shared<Logger>(log_path);
+    logger->start();
+
+    // Снимок записан 20 с назад: возраст 30 с + простой > таймаута 45 с, 10 с + простой - нет
+    const uint64_t wall_ms = uint64_t(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count()) - 20000;
+    SessionSnapshot snapshot(wall_ms);
+    snapshot.add(imsiKey::pack("001010000000001"), 30000);
+    snapshot.add(imsiKey::pack("001010000000002"), 10000);
+    snapshot.save(snapshot_path);
+
+    SessionManagerConfig config;
+    config.session_timeout_sec = 45;
+    config.graceful_shutdown_rate = 0;
+    config.cdr_file = cdr_path;
+    config.snapshot_file = snapshot_path;
+    config.snapshot_interval_sec = 0;
+    {
+        SessionManager manager(config, logger);
+        EXPECT_EQ(manager.getSnapshotStats().loaded_sessions, 1u);
+        EXPECT_EQ(manager.getSnapshotStats().expired_on_load, 1u);
+        EXPECT_FALSE(manager.isSessionActive(std::string_view("001010000000001")));
+        EXPECT_TRUE(manager.isSessionActive(std::string_view("001010000000002")));
+    }
+    EXPECT_EQ(countLines(cdr_path, "timeout_remove"), 1u);
+
+    // Испорченный снимок не мешает запуску
+    fs::resize_file(snapshot_path, 10);
+    config.snapshot_file = snapshot_path;
+    {
+        SessionManager manager(config, logger);
+        EXPECT_EQ(manager.getSnapshotStats().loaded_sessions, 0u);
+        EXPECT_EQ(manager.getStats().sessions, 0u);
+        // При остановке снимок перезаписывается корректным
+    }
+    EXPECT_NO_THROW(SessionSnapshot::load(snapshot_path));
+
+    logger->stop();
+    fs::remove(cdr_path);
+    fs::remove(log_path);
+    fs::remove(snapshot_path);
+}
@@ -0,0 +1,137 @@
+//SessionTableTest.cpp
+
+#include <gtest/gtest.h>
+#include <random>
+#include <unordered_map>
+#include "../src/server/SessionTable.h"
+
+TEST(SessionTableTest, PacksImsiWithLeadingZeros) {
+    char digits[imsiKey::kMaxDigits];
+    for (const std::string imsi : {"001010123456789", "1", "000", "999999999999999"}) {
+        const uint64_t key = imsiKey::pack(imsi);
+        ASSERT_NE(key, 0u) << imsi;
+        EXPECT_EQ(std::string(digits, imsiKey::unpack(key, digits)), imsi);
+    }
+    EXPECT_NE(imsiKey::pack("01"), imsiKey::pack("1"));
+    EXPECT_EQ(imsiKey::pack(""), 0u);
+    EXPECT_EQ(imsiKey::pack("1234567890123456"), 0u);
+    EXPECT_EQ(imsiKey::pack("12a"), 0u);
+}
+
+TEST(SessionTableTest, PresizesAndGrows) {
+    SessionTable table(1000);
+    EXPECT_EQ(table.capacity(), 2048u);
+    EXPECT_EQ(table.memoryBytes(), 2048u * 16);
+
+    bool inserted = false;
+    for (uint64_t i = 1; i <= 1536; ++i) table.insert(i, inserted);
+    EXPECT_EQ(table.capacity(), 2048u);
+    table.insert(1537, inserted);
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(table.capacity(), 4096u);
+    EXPECT_EQ(table.size(), 1537u);
+    for (uint64_t i = 1; i <= 1537; ++i) ASSERT_NE(table.find(i), nullptr) << i;
+
+    table.insert(7, inserted);
+    EXPECT_FALSE(inserted);
+}
+
+TEST(SessionTableTest, AlignsEntriesAndKeepsHugePagesOnGrow) {
+    // 256K записей по 16 байт - 4 MiB, таблица выравнивается по huge page
+    SessionTable table(SessionTable::kHugePageSize / sizeof(SessionEntry) / 2, true);
+    EXPECT_TRUE(table.hugePages());
+    EXPECT_GE(table.memoryBytes(), SessionTable::kHugePageSize);
+
+    bool inserted = false;
+    const SessionEntry& entry = table.insert(1, inserted);
+    ASSERT_TRUE(inserted);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(&entry) % sizeof(SessionEntry), 0u);
+
+    const size_t capacity = table.capacity();
+    for (uint64_t i = 2; i <= capacity; ++i) table.insert(i, inserted);
+    EXPECT_GT(table.capacity(), capacity);
+    EXPECT_TRUE(table.hugePages());
+    for (uint64_t i = 1; i <= capacity; ++i) ASSERT_NE(table.find(i), nullptr) << i;
+
+    SessionTable small(10);
+    EXPECT_FALSE(small.hugePages());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(&small.insert(1, inserted)) % sizeof(SessionEntry), 0u);
+}
+
+TEST(SessionTableTest, MatchesReferenceUnderRandomChurn) {
+    // Маленькая таблица и узкий диапазон ключей - длинные цепочки и частые сдвиги при удалении
+    SessionTable table;
+    std::unordered_map<uint64_t, uint32_t> reference;
+    std::mt19937_64 rng(42);
+    for (int step = 0; step < 200000; ++step) {
+        const uint64_t key = 1 + rng() % 512;
+        const unsigned op = rng() % 10;
+        if (op < 5) {
+            bool inserted = false;
+            table.insert(key, inserted).touched_ms = uint32_t(step);
+            EXPECT_EQ(inserted, reference.count(key) == 0);
+            reference[key] = uint32_t(step);
+        } else if (op < 8) {
+            EXPECT_EQ(table.erase(key), reference.erase(key) == 1);
+        } else if (op == 8) {
+            const SessionEntry* entry = table.find(key);
+            ASSERT_EQ(entry != nullptr, reference.count(key) == 1);
+            if (entry) {
+                EXPECT_EQ(entry->touched_ms.load(), reference[key]);
+            }
+        } else {
+            // Удаление по условию, как при очистке просроченных сессий
+            const uint32_t cutoff = uint32_t(step) - 300;
+            size_t callbacks = 0;
+            const size_t erased = table.eraseIf(
+                [&](const SessionEntry& entry) { return int32_t(entry.touched_ms - cutoff) < 0; },
+                [&](const SessionEntry&) { ++callbacks; });
+            size_t expected = 0;
+            for (auto it = reference.begin(); it != reference.end(); ) {
+                if (int32_t(it->second - cutoff) < 0) {
+                    it = reference.erase(it);
+                    ++expected;
+                } else {
+                    ++it;
+                }
+            }
+            EXPECT_EQ(erased, expected);
+            EXPECT_EQ(callbacks, expected);
+        }
+        ASSERT_EQ(table.size(), reference.size());
+    }
+    for (const auto& [key, touched] : reference) {
+        ASSERT_NE(table.find(key), nullptr);
+    }
+}
+
+TEST(SessionTableTest, ClockVictimGivesReferencedEntriesSecondChance) {
+    SessionTable table;
+    EXPECT_EQ(table.clockVictim(), table.capacity());
+
+    // Половина записей продлевалась (бит обращения), половина нет
+    constexpr uint32_t kEntries = 1000;
+    for (uint32_t i = 0; i < kEntries; ++i) {
+        bool inserted = false;
+        table.insert(imsiKey::pack(std::to_string(100000 + i)), inserted).touched_ms =
+            i % 2 ? (i << 1) | SessionEntry::kReferenced : i << 1;
+    }
+    // Первый оборот стрелки вытесняет только записи без бита, с продленных бит снимается
+    for (uint32_t i = 0; i < kEntries / 2; ++i) {
+        const size_t victim = table.clockVictim();
+        ASSERT_LT(victim, table.capacity());
+        ASSERT_EQ(table.at(victim).touched_ms.load() & SessionEntry::kReferenced, 0u);
+        ASSERT_EQ((table.at(victim).touched_ms.load() >> 1) % 2, 0u) << i;
+        table.eraseAt(victim);
+    }
+    EXPECT_EQ(table.size(), kEntries / 2);
+
+    // Продлены все: стрелка снимает биты за оборот и все равно находит запись
+    for (uint32_t i = 0; i < kEntries; ++i) {
+        if (SessionEntry* entry = table.find(imsiKey::pack(std::to_string(100000 + i)))) {
+            entry->touched_ms |= SessionEntry::kReferenced;
+        }
+    }
+    const size_t victim = table.clockVictim();
+    EXPECT_LT(victim, table.capacity());
+}
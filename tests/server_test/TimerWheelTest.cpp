@@ -0,0 +1,73 @@
+//TimerWheelTest.cpp
+
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include "../src/server/TimerWheel.h"
+
+TEST(TimerWheelTest, FiresEachKeyOnItsTickAcrossLevels) {
+    TimerWheel wheel(10, 0);
+    std::map<uint64_t, uint32_t> deadlines;
+    std::mt19937 rng(7);
+    // Сроки на всех уровнях: от одного тика до нескольких часов
+    for (uint64_t key = 1; key <= 2000; ++key) {
+        const uint32_t deadline = 1 + rng() % (key % 4 == 0 ? 20000000u : 50000u);
+        deadlines[key] = deadline;
+        wheel.schedule(key, deadline);
+    }
+    EXPECT_EQ(wheel.size(), deadlines.size());
+
+    std::map<uint64_t, uint32_t> fired;
+    auto deadline = [&](uint64_t key, uint32_t& deadline_ms) {
+        deadline_ms = deadlines.at(key);
+        return true;
+    };
+    // Продвигаем неравными шагами, как поток очистки
+    for (uint32_t now = 0; now <= 20000100u; now += 1 + rng() % 5000) {
+        wheel.advance(now, [&](uint64_t key, uint32_t tick_ms) {
+            EXPECT_TRUE(fired.emplace(key, tick_ms).second) << key;
+        }, deadline);
+    }
+    ASSERT_EQ(fired.size(), deadlines.size());
+    for (const auto& [key, tick_ms] : fired) {
+        // Не раньше срока и не позже чем через тик после него
+        EXPECT_GE(tick_ms, deadlines[key]) << key;
+        EXPECT_LE(tick_ms, deadlines[key] + 10) << key;
+    }
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimerWheelTest, SkipsKeysDroppedBeforeCascade) {
+    TimerWheel wheel(1, 1000);
+    wheel.schedule(1, 1000 + 5000);
+    wheel.schedule(2, 1000 + 5000);
+    wheel.schedule(3, 1000 + 3);
+
+    size_t fired = 0;
+    wheel.advance(1000 + 6000, [&](uint64_t key, uint32_t) { EXPECT_NE(key, 2u); ++fired; },
+                  [](uint64_t key, uint32_t& deadline_ms) {
+                      deadline_ms = 1000 + 5000;
+                      return key != 2;
+                  });
+    EXPECT_EQ(fired, 2u);
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimerWheelTest, RescheduleFromCallbackAndClockWrap) {
+    // Время владельца переходит через 2^32 мс
+    const uint32_t start = 0xFFFFFF00u;
+    TimerWheel wheel(10, start);
+    wheel.schedule(42, start + 100);
+
+    uint32_t fires = 0;
+    uint32_t last_tick = 0;
+    for (uint32_t step = 1; step <= 100; ++step) {
+        wheel.advance(start + step * 10, [&](uint64_t key, uint32_t tick_ms) {
+            ++fires;
+            last_tick = tick_ms;
+            if (fires < 3) wheel.schedule(key, tick_ms + 200);
+        }, [](uint64_t, uint32_t&) { return false; });
+    }
+    EXPECT_EQ(fires, 3u);
+    EXPECT_EQ(last_tick, start + 500);
+}
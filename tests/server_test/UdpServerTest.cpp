@@ -11,6 +11,8 @@
 #include "../src/server/UdpServer.h"
 #include "../src/server/SessionManager.h"
 #include "../src/Logger.h"
+#include "../src/GtpMessage.h"
+#include "../src/client/UdpClient.h"
 
 namespace {
     const uint16_t TEST_PORT = 54321;
@@ -158,4 +160,529 @@ TEST(UdpServerTest, HandlesBlacklistedImsi) {
     EXPECT_FALSE(session_mgr->isSessionActive("123456789000000"));
     
     server.stop();
-}
\ No newline at end of file
+}
+
+TEST(UdpServerTest, HandlesBatchedMessages) {
+    auto logger = std::make_shared<Logger>("test_udp.log");
+    auto session_mgr = std::make_shared<SessionManager>(60, 100, "test_cdr.csv", std::vector<std::string>{}, logger);
+
+    UdpServerConfig config;
+    config.port = TEST_PORT;
+    config.batch_size = 8;
+    UdpServer server(config, session_mgr, logger);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    constexpr int kMessages = 20;
+    for (int i = 0; i < kMessages; ++i) {
+        send_udp_message(TEST_IMSI.substr(0, 13) + std::to_string(10 + i), TEST_PORT);
+    }
+
+    for (int attempt = 0; attempt < 20; ++attempt) {
+        if (server.getBatchStats().datagrams >= kMessages) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    for (int i = 0; i < kMessages; ++i) {
+        const std::string imsi = TEST_IMSI.substr(0, 13) + std::to_string(10 + i);
+        EXPECT_TRUE(session_mgr->isSessionActive(imsi)) << "Session not created for IMSI: " << imsi;
+    }
+
+    const BatchStats stats = server.getBatchStats();
+    EXPECT_GE(stats.datagrams, static_cast<uint64_t>(kMessages));
+    EXPECT_GE(stats.batches, 1u);
+    EXPECT_LE(stats.batches, stats.datagrams);
+
+    uint64_t histogram_total = 0;
+    for (auto count : stats.fill) histogram_total += count;
+    EXPECT_EQ(histogram_total, stats.batches);
+
+    server.stop();
+}
+
+TEST(UdpServerTest, BatchedModeRepliesToEachClient) {
+    auto logger = std::make_shared<Logger>("test_udp.log");
+    auto session_mgr = std::make_shared<SessionManager>(60, 100, "test_cdr.csv", std::vector<std::string>{}, logger);
+
+    UdpServerConfig config;
+    config.port = TEST_PORT;
+    config.batch_size = 4;
+    UdpServer server(config, session_mgr, logger);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    timeval timeout{1, 0};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    sockaddr_in server_addr{};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(TEST_PORT);
+    inet_pton(AF_INET, "127.0.0.1", &server_addr.sin_addr);
+
+    const std::string imsi = "001010000000500";
+    char buffer[64];
+    sendto(sock, imsi.c_str(), imsi.size(), 0, (sockaddr*)&server_addr, sizeof(server_addr));
+    ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+    ASSERT_GT(n, 0);
+    EXPECT_EQ(std::string(buffer, n), "created");
+
+    sendto(sock, imsi.c_str(), imsi.size(), 0, (sockaddr*)&server_addr, sizeof(server_addr));
+    n = recv(sock, buffer, sizeof(buffer), 0);
+    ASSERT_GT(n, 0);
+    EXPECT_EQ(std::string(buffer, n), "exists");
+
+    close(sock);
+    server.stop();
+}
+
+
+TEST(UdpServerTest, RunsReusePortWorkers) {
+    auto logger = std::make_shared<Logger>("test_udp.log");
+    auto session_mgr = std::make_shared<SessionManager>(60, 100, "test_cdr.csv", std::vector<std::string>{}, logger);
+
+    UdpServerConfig config;
+    config.ip = "127.0.0.1";
+    config.port = TEST_PORT;
+    config.workers = 3;
+    UdpServer server(config, session_mgr, logger);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    const auto sockfds = server.getSockfds();
+    EXPECT_EQ(sockfds.size(), 3u);
+    for (int sockfd : sockfds) EXPECT_GE(sockfd, 0);
+    EXPECT_EQ(server.getEndpoint(), "127.0.0.1:" + std::to_string(TEST_PORT));
+
+    // Разные исходные порты распределяются ядром по разным сокетам
+    for (int i = 0; i < 6; ++i) {
+        send_udp_message("00101000000060" + std::to_string(i), TEST_PORT);
+    }
+    for (int i = 0; i < 6; ++i) {
+        const std::string imsi = "00101000000060" + std::to_string(i);
+        bool session_active = false;
+        for (int attempt = 0; attempt < 10 && !session_active; ++attempt) {
+            session_active = session_mgr->isSessionActive(imsi);
+            if (!session_active) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        EXPECT_TRUE(session_active) << "Session not created for IMSI: " << imsi;
+    }
+
+    server.stop();
+    EXPECT_TRUE(server.getSockfds().empty());
+}
+
+TEST(UdpServerTest, RejectsInvalidListenAddress) {
+    auto logger = std::make_shared<Logger>("test_udp.log");
+    auto session_mgr = std::make_shared<SessionManager>(60, 100, "test_cdr.csv", std::vector<std::string>{}, logger);
+
+    UdpServerConfig config;
+    config.ip = "not-an-ip";
+    config.port = TEST_PORT;
+    UdpServer server(config, session_mgr, logger);
+    EXPECT_NO_THROW(server.start());
+
+    // Поток не запущен, сокет закрывается при остановке
+    server.stop();
+    EXPECT_EQ(server.getSockfd(), -1);
+}
+
+
+TEST(UdpServerTest, EventLoopHandlesMessagesAndStops) {
+    auto logger = std::make_shared<Logger>("test_udp.log");
+    auto session_mgr = std::make_shared<SessionManager>(60, 100, "test_cdr.csv", std::vector<std::string>{}, logger);
+
+    UdpServerConfig config;
+    config.port = TEST_PORT;
+    config.workers = 2;
+    config.batch_size = 8;
+    config.engine = UdpEngine::Epoll;
+    UdpServer server(config, session_mgr, logger);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    for (int i = 0; i < 5; ++i) {
+        send_udp_message("00101000000070" + std::to_string(i), TEST_PORT);
+    }
+    for (int i = 0; i < 5; ++i) {
+        const std::string imsi = "00101000000070" + std::to_string(i);
+        bool session_active = false;
+        for (int attempt = 0; attempt < 10 && !session_active; ++attempt) {
+            session_active = session_mgr->isSessionActive(imsi);
+            if (!session_active) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        EXPECT_TRUE(session_active) << "Session not created for IMSI: " << imsi;
+    }
+
+    // Остановка через eventfd не должна ждать входящих датаграмм
+    const auto started = std::chrono::steady_clock::now();
+    server.stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - started, std::chrono::milliseconds(500));
+    EXPECT_EQ(server.getSockfd(), -1);
+}
+
+TEST(UdpServerTest, EventLoopTimerExpiresSessions) {
+    auto logger = std::make_shared<Logger>("test_udp.log");
+    auto session_mgr = std::make_shared<SessionManager>(1, 100, "test_cdr.csv", std::vector<std::string>{}, logger);
+
+    UdpServerConfig config;
+    config.port = TEST_PORT;
+    config.engine = UdpEngine::Epoll;
+    config.cleanup_interval_ms = 100;
+    UdpServer server(config, session_mgr, logger);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    send_udp_message(TEST_IMSI, TEST_PORT);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_TRUE(session_mgr->isSessionActive(TEST_IMSI));
+
+    // Без startCleanupTimer() сессию удаляет только timerfd событийного цикла
+    for (int i = 0; i < 30; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (!session_mgr->isSessionActive(TEST_IMSI)) break;
+    }
+    EXPECT_FALSE(session_mgr->isSessionActive(TEST_IMSI));
+
+    server.stop();
+}
+
+TEST(UdpServerTest, ParsesEngineNames) {
+    EXPECT_EQ(parseUdpEngine("blocking"), UdpEngine::Blocking);
+    EXPECT_EQ(parseUdpEngine("epoll"), UdpEngine::Epoll);
+    EXPECT_EQ(parseUdpEngine("io_uring"), UdpEngine::IoUring);
+    EXPECT_THROW(parseUdpEngine("unknown"), std::invalid_argument);
+}
+
+
+TEST(UdpServerTest, IoUringEngineRepliesAndStops) {
+    auto logger = std::make_shared<Logger>("test_udp.log");
+    auto session_mgr = std::make_shared<SessionManager>(60, 100, "test_cdr.csv", std::vector<std::string>{}, logger);
+
+    UdpServerConfig config;
+    config.port = TEST_PORT;
+    config.workers = 2;
+    config.batch_size = 16;
+    config.engine = UdpEngine::IoUring;
+    UdpServer server(config, session_mgr, logger);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // При недоступности io_uring сервер работает через синхронный цикл - ответы те же
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    timeval timeout{1, 0};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    sockaddr_in server_addr{};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(TEST_PORT);
+    inet_pton(AF_INET, "127.0.0.1", &server_addr.sin_addr);
+
+    char buffer[64];
+    for (int i = 0; i < 3; ++i) {
+        const std::string imsi = "00101000000080" + std::to_string(i);
+        sendto(sock, imsi.c_str(), imsi.size(), 0, (sockaddr*)&server_addr, sizeof(server_addr));
+        ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+        ASSERT_GT(n, 0);
+        EXPECT_EQ(std::string(buffer, n), "created");
+        EXPECT_TRUE(session_mgr->isSessionActive(imsi));
+    }
+    close(sock);
+
+    EXPECT_GE(server.getBatchStats().datagrams, 3u);
+
+    const auto started = std::chrono::steady_clock::now();
+    server.stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - started, std::chrono::milliseconds(500));
+    EXPECT_EQ(server.getSockfd(), -1);
+}
+
+TEST(UdpServerTest, HandlesBinaryAndTextRequests) {
+    auto logger = std::make_shared<Logger>("test_udp.log");
+    auto session_mgr = std::make_shared<SessionManager>(60, 100, "test_cdr.csv", std::vector<std::string>{"001010000000902"}, logger);
+
+    UdpServerConfig config;
+    config.port = TEST_PORT;
+    config.batch_size = 8;
+    UdpServer server(config, session_mgr, logger);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    UdpClient binary_client("127.0.0.1", TEST_PORT, logger, UdpProtocol::Binary);
+    EXPECT_EQ(binary_client.sendRequest("001010000000900"), "created");
+    EXPECT_EQ(binary_client.sendRequest("001010000000900"), "exists");
+    EXPECT_EQ(binary_client.sendRequest("001010000000902"), "rejected");
+    EXPECT_TRUE(session_mgr->isSessionActive("001010000000900"));
+
+    // Текстовый клиент работает с тем же портом
+    UdpClient text_client("127.0.0.1", TEST_PORT, logger);
+    EXPECT_EQ(text_client.sendRequest("001010000000900"), "exists");
+    EXPECT_EQ(text_client.sendRequest("001010000000901"), "created");
+
+    server.stop();
+}
+
+TEST(UdpServerTest, DropsMalformedBinaryRequest) {
+    auto logger = std::make_shared<Logger>("test_udp.log");
+    auto session_mgr = std::make_shared<SessionManager>(60, 100, "test_cdr.csv", std::vector<std::string>{}, logger);
+
+    UdpServer server(TEST_PORT, session_mgr, logger);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    timeval timeout{0, 300000};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    sockaddr_in server_addr{};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(TEST_PORT);
+    inet_pton(AF_INET, "127.0.0.1", &server_addr.sin_addr);
+
+    // Усеченное сообщение: ответа нет, сессия не создается
+    uint8_t request[64];
+    const size_t length = gtp::encodeCreateSessionRequest(request, sizeof(request), "001010000000910", 5);
+    sendto(sock, request, length - 3, 0, (sockaddr*)&server_addr, sizeof(server_addr));
+    char buffer[64];
+    EXPECT_LT(recv(sock, buffer, sizeof(buffer), 0), 0);
+    EXPECT_FALSE(session_mgr->isSessionActive("001010000000910"));
+
+    // Корректное сообщение: ответ с тем же номером последовательности
+    sendto(sock, request, length, 0, (sockaddr*)&server_addr, sizeof(server_addr));
+    ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+    ASSERT_GT(n, 0);
+    gtp::MessageView response(reinterpret_cast<const uint8_t*>(buffer), n);
+    ASSERT_TRUE(response.valid());
+    EXPECT_EQ(response.sequence(), 5u);
+    EXPECT_EQ(server.getBatchStats().malformed_gtp, 1u);
+    close(sock);
+
+    server.stop();
+}
+
+TEST(UdpServerTest, ProcessingPoolRepliesFromWorkers) {
+    auto logger = std::make_shared<Logger>("test_udp.log");
+    auto session_mgr = std::make_shared<SessionManager>(60, 100, "test_cdr.csv", std::vector<std::string>{}, logger);
+
+    UdpServerConfig config;
+    config.port = TEST_PORT;
+    config.batch_size = 16;
+    config.engine = UdpEngine::Epoll;
+    config.processing_workers = 2;
+    config.processing_max_workers = 3;
+    UdpServer server(config, session_mgr, logger);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    UdpClient text_client("127.0.0.1", TEST_PORT, logger);
+    UdpClient binary_client("127.0.0.1", TEST_PORT, logger, UdpProtocol::Binary);
+    for (int i = 0; i < 5; ++i) {
+        const std::string imsi = "00101000000095" + std::to_string(i);
+        EXPECT_EQ(text_client.sendRequest(imsi), "created");
+        EXPECT_EQ(binary_client.sendRequest(imsi), "exists");
+    }
+
+    const QueueStats stats = server.getQueueStats();
+    EXPECT_EQ(stats.enqueued, 10u);
+    EXPECT_EQ(stats.processed, 10u);
+    EXPECT_EQ(stats.max_workers, 3u);
+    EXPECT_GE(stats.active_workers, 2u);
+    server.stop();
+}
+
+TEST(UdpServerTest, BusyPollSocketsKeepServing) {
+    auto logger = std::make_shared<Logger>("test_udp.log");
+    auto session_mgr = std::make_shared<SessionManager>(60, 100, "test_cdr.csv", std::vector<std::string>{}, logger);
+
+    UdpServerConfig config;
+    config.port = TEST_PORT;
+    config.engine = UdpEngine::Epoll;
+    config.busy_poll_us = 50;
+    config.busy_poll_budget = 8;
+    UdpServer server(config, session_mgr, logger);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // Без CAP_NET_ADMIN ядро может не включить опцию, но сокет работает в любом случае
+    int busy_poll = -1;
+    socklen_t len = sizeof(busy_poll);
+    ASSERT_EQ(getsockopt(server.getSockfd(), SOL_SOCKET, SO_BUSY_POLL, &busy_poll, &len), 0);
+    EXPECT_TRUE(busy_poll == 0 || busy_poll == 50);
+
+    UdpClient client("127.0.0.1", TEST_PORT, logger);
+    EXPECT_EQ(client.sendRequest("001010000000961"), "created");
+    server.stop();
+}
+
+TEST(UdpServerTest, RateLimitedSourceGetsCheapReject) {
+    auto logger = std::make_shared<Logger>("test_udp.log");
+    auto session_mgr = std::make_shared<SessionManager>(60, 100, "test_cdr.csv", std::vector<std::string>{}, logger);
+
+    RateLimiterConfig limiter_config;
+    limiter_config.rate = 1;
+    limiter_config.burst = 2;
+    UdpServer server(TEST_PORT, session_mgr, logger);
+    server.setRateLimiter(std::make_shared<RateLimiter>(limiter_config));
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    UdpClient text_client("127.0.0.1", TEST_PORT, logger);
+    UdpClient binary_client("127.0.0.1", TEST_PORT, logger, UdpProtocol::Binary);
+    EXPECT_EQ(text_client.sendRequest("001010000000960"), "created");
+    EXPECT_EQ(binary_client.sendRequest("001010000000961"), "created");
+
+    // Корзина адреса 127.0.0.1 пуста: отказ без создания сессии
+    EXPECT_EQ(text_client.sendRequest("001010000000962"), "rejected (rate limited)");
+    EXPECT_EQ(binary_client.sendRequest("001010000000963"), "rejected");
+    EXPECT_FALSE(session_mgr->isSessionActive("001010000000962"));
+    EXPECT_FALSE(session_mgr->isSessionActive("001010000000963"));
+    server.stop();
+}
+
+TEST(UdpServerTest, OverloadShedsCreatesButServesRefreshes) {
+    auto logger = std::make_shared<Logger>("test_udp.log");
+    auto session_mgr = std::make_shared<SessionManager>(60, 100, "test_cdr.csv", std::vector<std::string>{}, logger);
+
+    // Время прихода извлекается по-разному в recvmsg, recvmmsg и io_uring - проверяем все
+    const std::vector<std::pair<UdpEngine, uint16_t>> engines = {
+        {UdpEngine::Blocking, 1}, {UdpEngine::Blocking, 4}, {UdpEngine::IoUring, 4}
+    };
+    for (size_t i = 0; i < engines.size(); ++i) {
+        // Цель 1 мкс без интервала: перегрузка со второй датаграммы
+        UdpServerConfig config;
+        config.port = TEST_PORT;
+        config.engine = engines[i].first;
+        config.batch_size = engines[i].second;
+        config.overload_target_us = 1;
+        config.overload_interval_ms = 0;
+        UdpServer server(config, session_mgr, logger);
+        server.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        const std::string existing = "00101000000097" + std::to_string(i);
+        const std::string fresh = "00101000000098" + std::to_string(i);
+        UdpClient client("127.0.0.1", TEST_PORT, logger);
+        EXPECT_EQ(client.sendRequest(existing), "created");
+        EXPECT_EQ(client.sendRequest(fresh), "rejected (overload)");
+        EXPECT_EQ(client.sendRequest(existing), "exists");
+        EXPECT_FALSE(session_mgr->isSessionActive(fresh));
+
+        const OverloadStats stats = server.getOverloadStats();
+        EXPECT_TRUE(stats.overloaded);
+        EXPECT_EQ(stats.episodes, 1u);
+        EXPECT_EQ(stats.shed, 1u);
+        EXPECT_EQ(stats.refreshes, 1u);
+        EXPECT_GE(stats.max_sojourn_us, 1u);
+        server.stop();
+    }
+}
+
+TEST(UdpServerTest, ReportsKernelDropsAndDelay) {
+    auto logger = std::make_shared<Logger>("test_udp.log");
+    auto session_mgr = std::make_shared<SessionManager>(60, 100, "test_cdr.csv", std::vector<std::string>{}, logger);
+
+    const std::vector<std::pair<UdpEngine, uint16_t>> engines = {
+        {UdpEngine::Blocking, 1}, {UdpEngine::Blocking, 4}, {UdpEngine::IoUring, 4}
+    };
+    for (const auto& [engine, batch_size] : engines) {
+        // Минимальный буфер приема: поток датаграмм без пауз переполняет его
+        UdpServerConfig config;
+        config.port = TEST_PORT;
+        config.engine = engine;
+        config.batch_size = batch_size;
+        config.kernel_stats = true;
+        config.rcvbuf_bytes = 1;
+        UdpServer server(config, session_mgr, logger);
+        server.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        int sock = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in server_addr{};
+        server_addr.sin_family = AF_INET;
+        server_addr.sin_port = htons(TEST_PORT);
+        inet_pton(AF_INET, "127.0.0.1", &server_addr.sin_addr);
+        const std::string imsi = "001010000000990";
+        for (int i = 0; i < 20000; ++i) {
+            sendto(sock, imsi.data(), imsi.size(), 0, (sockaddr*)&server_addr, sizeof(server_addr));
+        }
+        close(sock);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        // Счетчик потерь приходит с датаграммами, принятыми после переполнения
+        UdpClient client("127.0.0.1", TEST_PORT, logger);
+        EXPECT_EQ(client.sendRequest(imsi), "exists");
+
+        const KernelRxStats stats = server.getKernelRxStats();
+        EXPECT_EQ(stats.sockets, 1u);
+        EXPECT_GT(stats.rcvbuf_bytes, 0u);
+        EXPECT_GT(stats.drops, 0u);
+        EXPECT_GT(stats.datagrams, 1u);
+        uint64_t histogram_total = 0;
+        for (uint64_t count : stats.delay_histogram) histogram_total += count;
+        EXPECT_EQ(histogram_total, stats.datagrams);
+        server.stop();
+    }
+}
+
+TEST(UdpServerTest, AnswersRetransmissionFromCache) {
+    auto logger = std::make_shared<Logger>("test_udp.log");
+    auto session_mgr = std::make_shared<SessionManager>(60, 100, "test_cdr.csv", std::vector<std::string>{}, logger);
+
+    UdpServerConfig config;
+    config.port = TEST_PORT;
+    config.response_cache_size = 256;
+    config.response_cache_window_ms = 5000;
+    UdpServer server(config, session_mgr, logger);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    timeval timeout{1, 0};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    sockaddr_in server_addr{};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(TEST_PORT);
+    inet_pton(AF_INET, "127.0.0.1", &server_addr.sin_addr);
+    auto exchange = [&](const std::string& request) {
+        sendto(sock, request.data(), request.size(), 0, (sockaddr*)&server_addr, sizeof(server_addr));
+        char buffer[64];
+        ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+        return n > 0 ? std::string(buffer, n) : std::string();
+    };
+
+    // Повтор получает исходный ответ, а не "exists"; новый номер - новый запрос
+    EXPECT_EQ(exchange("001010000000995#7"), "created#7");
+    EXPECT_EQ(exchange("001010000000995#7"), "created#7");
+    EXPECT_EQ(exchange("001010000000995#8"), "exists#8");
+    // Без номера последовательности кэш не используется
+    EXPECT_EQ(exchange("001010000000995"), "exists");
+
+    // Бинарный повтор с тем же номером
+    uint8_t request[64];
+    const size_t length = gtp::encodeCreateSessionRequest(request, sizeof(request), "001010000000996", 11);
+    const std::string binary(reinterpret_cast<const char*>(request), length);
+    const std::string first = exchange(binary);
+    EXPECT_EQ(exchange(binary), first);
+    close(sock);
+
+    const ResponseCacheStats stats = server.getResponseCacheStats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.misses, 3u);
+    EXPECT_EQ(stats.stores, 3u);
+    server.stop();
+}
+
+TEST(UdpServerTest, ClientRetriesAgainstServer) {
+    auto logger = std::make_shared<Logger>("test_udp.log");
+    auto session_mgr = std::make_shared<SessionManager>(60, 100, "test_cdr.csv", std::vector<std::string>{}, logger);
+
+    UdpServerConfig config;
+    config.port = TEST_PORT;
+    config.response_cache_size = 256;
+    UdpServer server(config, session_mgr, logger);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    UdpClient client("127.0.0.1", TEST_PORT, logger);
+    client.setRetryPolicy(2, 500);
+    EXPECT_EQ(client.sendRequest("001010000000997"), "created");
+    EXPECT_EQ(client.sendRequest("001010000000997"), "exists");
+    server.stop();
+}